@@ -0,0 +1,38 @@
+#include "MineBoardNetState.h"
+#include "MineSweeperActor.h"
+
+void FMineBoardNetWord::PostReplicatedAdd(const FMineBoardNetState& InArraySerializer)
+{
+	if (InArraySerializer.OwnerActor)
+	{
+		InArraySerializer.OwnerActor->ApplyNetWord(*this);
+	}
+}
+
+void FMineBoardNetWord::PostReplicatedChange(const FMineBoardNetState& InArraySerializer)
+{
+	if (InArraySerializer.OwnerActor)
+	{
+		InArraySerializer.OwnerActor->ApplyNetWord(*this);
+	}
+}
+
+FMineBoardNetWord& FMineBoardNetState::FindOrAddWord(int32 WordIndex)
+{
+	if (const int32* Found = WordLookup.Find(WordIndex))
+	{
+		return Words[*Found];
+	}
+
+	const int32 NewIndex = Words.AddDefaulted();
+	Words[NewIndex].WordIndex = WordIndex;
+	WordLookup.Add(WordIndex, NewIndex);
+	return Words[NewIndex];
+}
+
+void FMineBoardNetState::Reset()
+{
+	Words.Empty();
+	WordLookup.Empty();
+	MarkArrayDirty();
+}
@@ -0,0 +1,164 @@
+#include "MineBoardSnapshot.h"
+#include "MineSweeperActor.h"
+#include "MineSweeperMemory.h"
+
+FMineBoardSnapshotPublisher::~FMineBoardSnapshotPublisher()
+{
+	//Readers own their references, only ours are dropped here
+	for (const FRetiredVersion& RetiredVersion : Retired)
+	{
+		RetiredVersion.Version->Release();
+	}
+	Retired.Empty();
+
+	if (FMineBoardVersion* Version = Published.exchange(nullptr))
+	{
+		Version->Release();
+	}
+}
+
+TRefCountPtr<const FMineBoardTile> FMineBoardSnapshotPublisher::BuildTile(const AMineSweeperActor& Board, int32 FirstRow, int32 NumRows)
+{
+	FMineBoardTile* Tile = new FMineBoardTile();
+	Tile->FirstRow = FirstRow;
+	Tile->NumRows = NumRows;
+	Board.FillBoardSnapshot(FIntRect(0, FirstRow, Board.GetNumColumns(), FirstRow + NumRows), false, Tile->States);
+	return TRefCountPtr<const FMineBoardTile>(Tile);
+}
+
+void FMineBoardSnapshotPublisher::Publish(const AMineSweeperActor& Board, const TArray<int32>& ChangedIndices)
+{
+	check(IsInGameThread());
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	const FMineBoardDims Dims = Board.GetBoardDims();
+	const FMineBoardVersion* Previous = Published.load();
+	const bool bFullRebuild = Previous == nullptr
+		|| ChangedIndices.Num() == 0
+		|| Previous->Dims.Columns != Dims.Columns
+		|| Previous->Dims.Rows != Dims.Rows;
+
+	FMineBoardVersion* NewVersion = new FMineBoardVersion();
+	NewVersion->Serial = NextSerial++;
+	NewVersion->Dims = Dims;
+	NewVersion->Topology = Board.GetTopology();
+	NewVersion->MineCount = Board.GetMineCount();
+	NewVersion->bGameOver = Board.IsGameOver();
+	NewVersion->bHasWon = Board.HasWon();
+	NewVersion->StateHash = Board.GetBoard().GetStateHash();
+	NewVersion->bStateHashComplete = Board.GetBoard().IsStateHashComplete();
+	NewVersion->RowsPerTile = FMath::Max(1, FieldsPerTile / FMath::Max(Dims.Columns, 1));
+
+	const int32 RowsPerTile = NewVersion->RowsPerTile;
+	const int32 NumTiles = FMath::DivideAndRoundUp(Dims.Rows, RowsPerTile);
+
+	if (bFullRebuild)
+	{
+		NewVersion->Tiles.Reserve(NumTiles);
+		for (int32 TileIndex = 0; TileIndex < NumTiles; TileIndex++)
+		{
+			const int32 FirstRow = TileIndex * RowsPerTile;
+			NewVersion->Tiles.Add(BuildTile(Board, FirstRow, FMath::Min(RowsPerTile, Dims.Rows - FirstRow)));
+		}
+	}
+	else
+	{
+		//Share everything, then replace only the tiles with changed fields
+		NewVersion->Tiles = Previous->Tiles;
+
+		TBitArray<> DirtyTiles(false, NumTiles);
+		for (const int32 Index : ChangedIndices)
+		{
+			const int32 TileIndex = (Index / Dims.Columns) / RowsPerTile;
+			if (TileIndex < NumTiles && !DirtyTiles[TileIndex])
+			{
+				DirtyTiles[TileIndex] = true;
+				const int32 FirstRow = TileIndex * RowsPerTile;
+				NewVersion->Tiles[TileIndex] = BuildTile(Board, FirstRow, FMath::Min(RowsPerTile, Dims.Rows - FirstRow));
+			}
+		}
+	}
+
+	NewVersion->AddRef();
+	FMineBoardVersion* OldVersion = Published.exchange(NewVersion);
+
+	//Readers that announced themselves before the exchange, in any epoch, may still be picking up the old version.
+	//Readers after it only find the new one.
+	Epoch.fetch_add(1);
+	if (OldVersion)
+	{
+		Retired.Add({ OldVersion });
+	}
+
+	ReclaimRetired();
+}
+
+void FMineBoardSnapshotPublisher::ReclaimRetired()
+{
+	//A reader stays in its counter from before it loads the version until it holds a reference. A counter seen at zero
+	//after a version was replaced therefore has no reader left that could still pick that version up.
+	const bool bDrained[2] = { ReaderCounts[0].load() == 0, ReaderCounts[1].load() == 0 };
+	for (int32 i = Retired.Num() - 1; i >= 0; i--)
+	{
+		FRetiredVersion& RetiredVersion = Retired[i];
+		RetiredVersion.bDrained[0] |= bDrained[0];
+		RetiredVersion.bDrained[1] |= bDrained[1];
+		if (RetiredVersion.bDrained[0] && RetiredVersion.bDrained[1])
+		{
+			RetiredVersion.Version->Release();
+			Retired.RemoveAtSwap(i, 1, false);
+		}
+	}
+}
+
+SIZE_T FMineBoardSnapshotPublisher::GetAllocatedSize() const
+{
+	SIZE_T Size = Retired.GetAllocatedSize();
+	TSet<const FMineBoardTile*> CountedTiles;
+
+	auto AddVersion = [&Size, &CountedTiles](const FMineBoardVersion& Version)
+	{
+		Size += sizeof(FMineBoardVersion) + Version.Tiles.GetAllocatedSize();
+		for (const TRefCountPtr<const FMineBoardTile>& Tile : Version.Tiles)
+		{
+			bool bAlreadyCounted = false;
+			CountedTiles.Add(Tile.GetReference(), &bAlreadyCounted);
+			if (!bAlreadyCounted)
+			{
+				Size += sizeof(FMineBoardTile) + Tile->States.GetAllocatedSize();
+			}
+		}
+	};
+
+	if (const FMineBoardVersion* Version = Published.load())
+	{
+		AddVersion(*Version);
+	}
+	for (const FRetiredVersion& RetiredVersion : Retired)
+	{
+		AddVersion(*RetiredVersion.Version);
+	}
+	return Size;
+}
+
+TRefCountPtr<const FMineBoardVersion> FMineBoardSnapshotPublisher::Acquire() const
+{
+	for (;;)
+	{
+		//Announce the reader in the counter of the current epoch. Retry if a publish slipped in between,
+		//so readers move over to the new counter and the old one can drain.
+		const uint64 ReadEpoch = Epoch.load();
+		std::atomic<int32>& ReaderCount = ReaderCounts[ReadEpoch & 1];
+		ReaderCount.fetch_add(1);
+		if (Epoch.load() != ReadEpoch)
+		{
+			ReaderCount.fetch_sub(1);
+			continue;
+		}
+
+		//Whatever version this loads can't be released before the count drops, so taking a reference here is safe
+		TRefCountPtr<const FMineBoardVersion> Result(Published.load());
+		ReaderCount.fetch_sub(1);
+		return Result;
+	}
+}
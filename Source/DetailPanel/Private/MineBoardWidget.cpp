@@ -0,0 +1,135 @@
+#include "MineBoardWidget.h"
+#include "MineSweeperActor.h"
+#include "SMineBoard.h"
+#include "Styling/CoreStyle.h"
+#include "Widgets/SInvalidationPanel.h"
+
+#define LOCTEXT_NAMESPACE "MineBoardWidget"
+
+UMineBoardWidget::UMineBoardWidget(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	HiddenBrush.TintColor = FSlateColor(FLinearColor(0.35f, 0.35f, 0.35f));
+	RevealedBrush.TintColor = FSlateColor(FLinearColor(0.8f, 0.8f, 0.8f));
+	MineBrush.DrawAs = ESlateBrushDrawType::NoDrawType;
+	FlagBrush.DrawAs = ESlateBrushDrawType::NoDrawType;
+
+	NumberFont = FCoreStyle::GetDefaultFontStyle("Bold", 14);
+
+	//Same colours as the details panel
+	NumberColors =
+	{
+		FLinearColor::Blue,
+		FLinearColor::Green,
+		FLinearColor::Red,
+		FLinearColor(FColor::FromHex("010123FF")),
+		FLinearColor(FColor::FromHex("170000FF")),
+		FLinearColor(FColor::FromHex("001D26FF")),
+		FLinearColor(FColor::FromHex("101010FF")),
+		FLinearColor(FColor::FromHex("101010FF")),
+	};
+}
+
+TSharedRef<SWidget> UMineBoardWidget::RebuildWidget()
+{
+	//The invalidation panel keeps the painted board cached until the board invalidates it
+	return SNew(SInvalidationPanel)
+		[
+			SAssignNew(MyBoard, SMineBoard)
+			.Board(Board)
+			.CellSize(CellSize)
+			.HiddenBrush(&HiddenBrush)
+			.RevealedBrush(&RevealedBrush)
+			.MineBrush(&MineBrush)
+			.FlagBrush(&FlagBrush)
+			.NumberFont(NumberFont)
+			.NumberColors(NumberColors)
+			.OnCellClicked(BIND_UOBJECT_DELEGATE(FOnMineBoardCellClicked, HandleCellClicked))
+		];
+}
+
+void UMineBoardWidget::SynchronizeProperties()
+{
+	Super::SynchronizeProperties();
+
+	BindBoardEvents();
+
+	if (MyBoard.IsValid())
+	{
+		MyBoard->SetBoard(Board);
+	}
+}
+
+void UMineBoardWidget::ReleaseSlateResources(bool bReleaseChildren)
+{
+	Super::ReleaseSlateResources(bReleaseChildren);
+
+	UnbindBoardEvents();
+	MyBoard.Reset();
+}
+
+void UMineBoardWidget::SetBoard(AMineSweeperActor* InBoard)
+{
+	if (Board == InBoard)
+	{
+		return;
+	}
+
+	UnbindBoardEvents();
+	Board = InBoard;
+	BindBoardEvents();
+
+	if (MyBoard.IsValid())
+	{
+		MyBoard->SetBoard(Board);
+	}
+	OnBoardChanged.Broadcast();
+}
+
+void UMineBoardWidget::BindBoardEvents()
+{
+	if (Board && !BoardChangedHandle.IsValid())
+	{
+		BoardChangedHandle = Board->OnBoardChanged().AddUObject(this, &UMineBoardWidget::HandleBoardChanged);
+	}
+}
+
+void UMineBoardWidget::UnbindBoardEvents()
+{
+	if (Board && BoardChangedHandle.IsValid())
+	{
+		Board->OnBoardChanged().Remove(BoardChangedHandle);
+	}
+	BoardChangedHandle.Reset();
+}
+
+void UMineBoardWidget::HandleBoardChanged(const TArray<int32>& ChangedIndices)
+{
+	OnBoardChanged.Broadcast();
+}
+
+void UMineBoardWidget::HandleCellClicked(int32 ColIndex, int32 RowIndex, bool bRightClick)
+{
+	if (!Board)
+	{
+		return;
+	}
+
+	if (bRightClick)
+	{
+		Board->RequestRightClickOnField(GetOwningPlayer(), ColIndex, RowIndex);
+	}
+	else
+	{
+		Board->RequestClickOnField(GetOwningPlayer(), ColIndex, RowIndex);
+	}
+}
+
+#if WITH_EDITOR
+const FText UMineBoardWidget::GetPaletteCategory()
+{
+	return LOCTEXT("MineSweeper", "MineSweeper");
+}
+#endif
+
+#undef LOCTEXT_NAMESPACE
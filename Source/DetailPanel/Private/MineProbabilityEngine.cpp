@@ -0,0 +1,969 @@
+#include "MineProbabilityEngine.h"
+#include "MineBoardSnapshot.h"
+#include "MineSweeperActor.h"
+#include "DetailPanel.h"
+#include "MineStateCache.h"
+#include "Async/Async.h"
+
+namespace MineProbability
+{
+	//Revealed numbers still open at one step of the sweep over a component, in the order of the active constraints
+	struct FNeedKey
+	{
+		TArray<uint8, TInlineAllocator<16>> Needs;
+
+		bool operator==(const FNeedKey& Other) const
+		{
+			return Needs == Other.Needs;
+		}
+
+		friend uint32 GetTypeHash(const FNeedKey& Key)
+		{
+			return FCrc::MemCrc32(Key.Needs.GetData(), Key.Needs.Num());
+		}
+	};
+
+	//A revealed number with hidden fields around it. Needs is the number minus the flags around it.
+	struct FConstraint
+	{
+		int32 Need = 0;
+		TArray<int32> Vars;
+	};
+
+	//What the counting of one component returns. Ways[k] is the number of solutions with Offset + k mines in the component,
+	//MineWays[v][k] the number of those in which field v of the component has a mine. Both share one arbitrary scale.
+	struct FComponentCounts
+	{
+		int32 Offset = 0;
+		TArray<double> Ways;
+		TArray<TArray<double>> MineWays;
+		bool bExact = true;
+	};
+
+	//Per field of the component, what has to be done when the sweep decides it
+	struct FTouchedConstraint
+	{
+		int32 InitialNeed = 0;
+		//Slot in the current state, INDEX_NONE if the constraint starts at this field
+		int32 CurrentSlot = INDEX_NONE;
+		//Slot in the next state, INDEX_NONE if this is the last field of the constraint
+		int32 NextSlot = INDEX_NONE;
+		//Fields of the constraint still to come after this one
+		int32 RemainingAfter = 0;
+	};
+
+	struct FSweepStep
+	{
+		//For every slot of the next state the slot of the current state it is copied from, or INDEX_NONE if it is new
+		TArray<int32> NextSource;
+		TArray<FTouchedConstraint> Touched;
+	};
+
+	//Adds B shifted by Shift into A, A is never made longer than MaxLength
+	static void AddShifted(TArray<double>& A, const TArray<double>& B, int32 Shift, int32 MaxLength)
+	{
+		const int32 Length = FMath::Min(B.Num() + Shift, MaxLength);
+		if (A.Num() < Length)
+		{
+			A.SetNumZeroed(Length);
+		}
+		for (int32 k = Shift; k < Length; k++)
+		{
+			A[k] += B[k - Shift];
+		}
+	}
+
+	static TArray<double> Convolve(const TArray<double>& A, const TArray<double>& B, int32 MaxLength)
+	{
+		TArray<double> Result;
+		Result.SetNumZeroed(FMath::Max(FMath::Min(A.Num() + B.Num() - 1, MaxLength), 0));
+		for (int32 i = 0; i < A.Num(); i++)
+		{
+			if (A[i] == 0.0)
+			{
+				continue;
+			}
+			for (int32 j = 0; j < B.Num() && i + j < Result.Num(); j++)
+			{
+				Result[i + j] += A[i] * B[j];
+			}
+		}
+		return Result;
+	}
+
+	//Scales the values so the largest is 1, returns the factor used
+	static double Normalize(TArray<double>& Values)
+	{
+		double MaxValue = 0.0;
+		for (const double Value : Values)
+		{
+			MaxValue = FMath::Max(MaxValue, Value);
+		}
+		if (MaxValue > 0.0)
+		{
+			const double Scale = 1.0 / MaxValue;
+			for (double& Value : Values)
+			{
+				Value *= Scale;
+			}
+			return Scale;
+		}
+		return 1.0;
+	}
+
+	//Drops the ends of a normalized polynomial that are too small to matter, moving Offset along.
+	//Sums of many components are narrow bells, this keeps combining them cheap on huge boards.
+	static void Trim(TArray<double>& Values, int32& Offset)
+	{
+		constexpr double Negligible = 1e-15;
+		int32 Last = Values.Num() - 1;
+		while (Last >= 0 && Values[Last] < Negligible)
+		{
+			Last--;
+		}
+		int32 First = 0;
+		while (First < Last && Values[First] < Negligible)
+		{
+			First++;
+		}
+		Values.SetNum(Last + 1);
+		Values.RemoveAt(0, First);
+		Offset += First;
+	}
+
+	//Guess from the numbers alone, for components too big to count. Every field gets the average density of the numbers
+	//around it and the component claims the rounded sum of those as its mine count.
+	static void EstimateComponent(const TArray<FConstraint>& Constraints, const TArray<TArray<int32>>& ConstraintsOfVar, int32 MaxMines, FComponentCounts& OutCounts)
+	{
+		const int32 NumVars = ConstraintsOfVar.Num();
+		TArray<double> VarProbabilities;
+		VarProbabilities.SetNumZeroed(NumVars);
+		double ExpectedMines = 0.0;
+		for (int32 Var = 0; Var < NumVars; Var++)
+		{
+			double Sum = 0.0;
+			for (const int32 ConstraintIndex : ConstraintsOfVar[Var])
+			{
+				const FConstraint& Constraint = Constraints[ConstraintIndex];
+				Sum += double(Constraint.Need) / Constraint.Vars.Num();
+			}
+			VarProbabilities[Var] = ConstraintsOfVar[Var].Num() ? Sum / ConstraintsOfVar[Var].Num() : 0.0;
+			ExpectedMines += VarProbabilities[Var];
+		}
+
+		OutCounts.bExact = false;
+		OutCounts.Offset = FMath::Clamp(FMath::RoundToInt(ExpectedMines), 0, MaxMines);
+		OutCounts.Ways = { 1.0 };
+		OutCounts.MineWays.SetNum(NumVars);
+		for (int32 Var = 0; Var < NumVars; Var++)
+		{
+			OutCounts.MineWays[Var] = { VarProbabilities[Var] };
+		}
+	}
+
+	//Counts the solutions of one component. The fields are decided one after the other in the given order,
+	//the state after each field is the remaining need of every number that has fields on both sides of it.
+	//Equal states are merged, so the work depends on how many numbers are open at once rather than on 2^fields.
+	//A forward pass counts the ways to reach every state, a backward pass the ways to finish from it, and the
+	//two are combined per field for the marginals.
+	//Components over the budget are estimated instead, only the work actually done is taken off the budget. Returns false if the job was cancelled.
+	static bool CountComponent(const TArray<FConstraint>& Constraints, int32 NumVars, int32 MaxMines, int64& Budget, const std::atomic<bool>* bCancelled, FComponentCounts& OutCounts)
+	{
+		const int32 NumConstraints = Constraints.Num();
+
+		TArray<int32> FirstVar;
+		TArray<int32> LastVar;
+		FirstVar.Init(MAX_int32, NumConstraints);
+		LastVar.Init(-1, NumConstraints);
+		TArray<TArray<int32>> ConstraintsOfVar;
+		ConstraintsOfVar.SetNum(NumVars);
+		for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints; ConstraintIndex++)
+		{
+			for (const int32 Var : Constraints[ConstraintIndex].Vars)
+			{
+				FirstVar[ConstraintIndex] = FMath::Min(FirstVar[ConstraintIndex], Var);
+				LastVar[ConstraintIndex] = FMath::Max(LastVar[ConstraintIndex], Var);
+				ConstraintsOfVar[Var].Add(ConstraintIndex);
+			}
+		}
+
+		//The sweep can't take less than one step per open number per field, don't even start if that is over budget.
+		//Nothing was swept then, so the budget stays for the components after this one.
+		TArray<int32> WidthChanges;
+		WidthChanges.SetNumZeroed(NumVars + 1);
+		for (int32 ConstraintIndex = 0; ConstraintIndex < NumConstraints; ConstraintIndex++)
+		{
+			WidthChanges[FirstVar[ConstraintIndex] + 1]++;
+			WidthChanges[LastVar[ConstraintIndex] + 1]--;
+		}
+		int64 SweepCost = NumVars;
+		int32 Width = 0;
+		for (int32 Step = 0; Step <= NumVars; Step++)
+		{
+			Width += WidthChanges[Step];
+			SweepCost += Width;
+		}
+		if (SweepCost > Budget)
+		{
+			EstimateComponent(Constraints, ConstraintsOfVar, MaxMines, OutCounts);
+			return true;
+		}
+
+		//Active constraints at every step, sorted so the state layout is fixed per step
+		TArray<TArray<int32>> Active;
+		Active.SetNum(NumVars + 1);
+		for (int32 Step = 1; Step <= NumVars; Step++)
+		{
+			for (const int32 ConstraintIndex : Active[Step - 1])
+			{
+				if (LastVar[ConstraintIndex] >= Step)
+				{
+					Active[Step].Add(ConstraintIndex);
+				}
+			}
+			for (const int32 ConstraintIndex : ConstraintsOfVar[Step - 1])
+			{
+				if (FirstVar[ConstraintIndex] == Step - 1 && LastVar[ConstraintIndex] >= Step)
+				{
+					Active[Step].Add(ConstraintIndex);
+				}
+			}
+			Active[Step].Sort();
+		}
+
+		TArray<FSweepStep> Steps;
+		Steps.SetNum(NumVars);
+		TArray<int32> CurrentSlots;
+		TArray<int32> NextSlots;
+		CurrentSlots.Init(INDEX_NONE, NumConstraints);
+		NextSlots.Init(INDEX_NONE, NumConstraints);
+		for (int32 Var = 0; Var < NumVars; Var++)
+		{
+			FSweepStep& SweepStep = Steps[Var];
+			const TArray<int32>& Current = Active[Var];
+			const TArray<int32>& Next = Active[Var + 1];
+			for (int32 Slot = 0; Slot < Current.Num(); Slot++)
+			{
+				CurrentSlots[Current[Slot]] = Slot;
+			}
+			for (int32 Slot = 0; Slot < Next.Num(); Slot++)
+			{
+				NextSlots[Next[Slot]] = Slot;
+			}
+
+			SweepStep.NextSource.Init(INDEX_NONE, Next.Num());
+			for (int32 Slot = 0; Slot < Next.Num(); Slot++)
+			{
+				SweepStep.NextSource[Slot] = CurrentSlots[Next[Slot]];
+			}
+			for (const int32 ConstraintIndex : ConstraintsOfVar[Var])
+			{
+				FTouchedConstraint& Touched = SweepStep.Touched.AddDefaulted_GetRef();
+				Touched.InitialNeed = Constraints[ConstraintIndex].Need;
+				Touched.CurrentSlot = CurrentSlots[ConstraintIndex];
+				Touched.NextSlot = NextSlots[ConstraintIndex];
+				for (const int32 OtherVar : Constraints[ConstraintIndex].Vars)
+				{
+					Touched.RemainingAfter += OtherVar > Var ? 1 : 0;
+				}
+			}
+
+			for (const int32 ConstraintIndex : Current)
+			{
+				CurrentSlots[ConstraintIndex] = INDEX_NONE;
+			}
+			for (const int32 ConstraintIndex : Next)
+			{
+				NextSlots[ConstraintIndex] = INDEX_NONE;
+			}
+		}
+
+		//Forward pass. Layer i holds the states before field i is decided and how many ways lead there per mine count.
+		TArray<TArray<FNeedKey>> Keys;
+		TArray<TArray<TArray<double>>> Forward;
+		TArray<TArray<int32>> Transitions;
+		Keys.SetNum(NumVars + 1);
+		Forward.SetNum(NumVars + 1);
+		Transitions.SetNum(NumVars);
+
+		Keys[0].AddDefaulted();
+		Forward[0].Add(TArray<double>{ 1.0 });
+
+		const int32 MaxLength = MaxMines + 1;
+		int64 Work = 0;
+		TMap<FNeedKey, int32> Lookup;
+		FNeedKey NextKey;
+		for (int32 Var = 0; Var < NumVars; Var++)
+		{
+			if (bCancelled && bCancelled->load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+
+			const FSweepStep& SweepStep = Steps[Var];
+			Lookup.Reset();
+			Transitions[Var].Init(INDEX_NONE, Keys[Var].Num() * 2);
+
+			for (int32 State = 0; State < Keys[Var].Num(); State++)
+			{
+				for (int32 IsMine = 0; IsMine < 2; IsMine++)
+				{
+					NextKey.Needs.SetNumUninitialized(SweepStep.NextSource.Num());
+					for (int32 Slot = 0; Slot < SweepStep.NextSource.Num(); Slot++)
+					{
+						const int32 Source = SweepStep.NextSource[Slot];
+						NextKey.Needs[Slot] = Source != INDEX_NONE ? Keys[Var][State].Needs[Source] : 0;
+					}
+
+					bool bValid = true;
+					for (const FTouchedConstraint& Touched : SweepStep.Touched)
+					{
+						const int32 Need = (Touched.CurrentSlot != INDEX_NONE ? Keys[Var][State].Needs[Touched.CurrentSlot] : Touched.InitialNeed) - IsMine;
+						if (Need < 0 || Need > Touched.RemainingAfter)
+						{
+							bValid = false;
+							break;
+						}
+						if (Touched.NextSlot != INDEX_NONE)
+						{
+							NextKey.Needs[Touched.NextSlot] = uint8(Need);
+						}
+					}
+					if (!bValid)
+					{
+						continue;
+					}
+
+					int32 NextState;
+					if (const int32* Found = Lookup.Find(NextKey))
+					{
+						NextState = *Found;
+					}
+					else
+					{
+						NextState = Keys[Var + 1].Add(NextKey);
+						Forward[Var + 1].AddDefaulted();
+						Lookup.Add(NextKey, NextState);
+					}
+					Transitions[Var][State * 2 + IsMine] = NextState;
+					AddShifted(Forward[Var + 1][NextState], Forward[Var][State], IsMine, MaxLength);
+					Work += Forward[Var][State].Num();
+				}
+			}
+
+			if (Work > Budget)
+			{
+				Budget -= Work;
+				EstimateComponent(Constraints, ConstraintsOfVar, MaxMines, OutCounts);
+				return true;
+			}
+		}
+
+		//Backward pass over the same states. Backward[i][s][k] is the number of ways to decide fields i.. with k mines from state s.
+		TArray<TArray<TArray<double>>> Backward;
+		Backward.SetNum(NumVars + 1);
+		Backward[NumVars].SetNum(Keys[NumVars].Num());
+		for (TArray<double>& Ways : Backward[NumVars])
+		{
+			Ways = { 1.0 };
+		}
+		for (int32 Var = NumVars - 1; Var >= 0; Var--)
+		{
+			Backward[Var].SetNum(Keys[Var].Num());
+			for (int32 State = 0; State < Keys[Var].Num(); State++)
+			{
+				for (int32 IsMine = 0; IsMine < 2; IsMine++)
+				{
+					const int32 NextState = Transitions[Var][State * 2 + IsMine];
+					if (NextState != INDEX_NONE)
+					{
+						AddShifted(Backward[Var][State], Backward[Var + 1][NextState], IsMine, MaxLength);
+					}
+				}
+			}
+		}
+
+		OutCounts.Ways = Backward[0][0];
+		if (OutCounts.Ways.Num() == 0)
+		{
+			//No solution at all
+			return true;
+		}
+
+		//Marginals, the ways through every state that puts a mine on the field
+		OutCounts.MineWays.SetNum(NumVars);
+		for (int32 Var = 0; Var < NumVars; Var++)
+		{
+			if (bCancelled && bCancelled->load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+
+			TArray<double>& MineWays = OutCounts.MineWays[Var];
+			MineWays.SetNumZeroed(OutCounts.Ways.Num());
+			for (int32 State = 0; State < Keys[Var].Num(); State++)
+			{
+				const int32 NextState = Transitions[Var][State * 2 + 1];
+				if (NextState == INDEX_NONE)
+				{
+					continue;
+				}
+				const TArray<double>& Before = Forward[Var][State];
+				const TArray<double>& After = Backward[Var + 1][NextState];
+				for (int32 A = 0; A < Before.Num(); A++)
+				{
+					for (int32 B = 0; B < After.Num() && A + B + 1 < MineWays.Num(); B++)
+					{
+						MineWays[A + B + 1] += Before[A] * After[B];
+					}
+				}
+				Work += Before.Num() * After.Num();
+			}
+
+			if (Work > Budget)
+			{
+				Budget -= Work;
+				EstimateComponent(Constraints, ConstraintsOfVar, MaxMines, OutCounts);
+				return true;
+			}
+		}
+
+		Budget -= Work;
+
+		const double Scale = Normalize(OutCounts.Ways);
+		for (TArray<double>& MineWays : OutCounts.MineWays)
+		{
+			for (double& Value : MineWays)
+			{
+				Value *= Scale;
+			}
+		}
+		return true;
+	}
+
+	//Node of the tree the components are combined in. Prod is the product of the Ways polynomials below it, starting at Offset mines.
+	struct FCombineNode
+	{
+		int32 Offset = 0;
+		TArray<double> Prod;
+		int32 Left = INDEX_NONE;
+		int32 Right = INDEX_NONE;
+		int32 Component = INDEX_NONE;
+	};
+
+	static int32 BuildCombineTree(TArray<FCombineNode>& Nodes, const TArray<FComponentCounts>& Counts, const TArray<int32>& Components, int32 First, int32 Last, int32 MaxLength)
+	{
+		const int32 NodeIndex = Nodes.AddDefaulted();
+		if (Last - First == 1)
+		{
+			const int32 Component = Components[First];
+			Nodes[NodeIndex].Component = Component;
+			Nodes[NodeIndex].Offset = Counts[Component].Offset;
+			Nodes[NodeIndex].Prod = Counts[Component].Ways;
+			return NodeIndex;
+		}
+
+		const int32 Middle = (First + Last) / 2;
+		const int32 Left = BuildCombineTree(Nodes, Counts, Components, First, Middle, MaxLength);
+		const int32 Right = BuildCombineTree(Nodes, Counts, Components, Middle, Last, MaxLength);
+		int32 Offset = Nodes[Left].Offset + Nodes[Right].Offset;
+		TArray<double> Prod = Convolve(Nodes[Left].Prod, Nodes[Right].Prod, MaxLength - Offset);
+		Normalize(Prod);
+		Trim(Prod, Offset);
+		Nodes[NodeIndex].Left = Left;
+		Nodes[NodeIndex].Right = Right;
+		Nodes[NodeIndex].Offset = Offset;
+		Nodes[NodeIndex].Prod = MoveTemp(Prod);
+		return NodeIndex;
+	}
+
+	//Hands every component the weight of each of its mine counts given all the other components and the open fields.
+	//Weights[k] of a node is the sum over everything outside of it that puts k mines into it. Each child gets it
+	//summed over the mine counts of its sibling, which keeps the total work close to a single convolution.
+	static void DistributeWeights(const TArray<FCombineNode>& Nodes, int32 NodeIndex, const TArray<double>& Weights, TArray<TArray<double>>& OutComponentWeights)
+	{
+		const FCombineNode& Node = Nodes[NodeIndex];
+		if (Node.Component != INDEX_NONE)
+		{
+			OutComponentWeights[Node.Component] = Weights;
+			return;
+		}
+
+		auto WeightsForChild = [&Weights, &Node](const FCombineNode& Child, const FCombineNode& Sibling)
+		{
+			//The node's own product may have been trimmed, so its offset is not simply the sum of the children's
+			const int32 Shift = Child.Offset + Sibling.Offset - Node.Offset;
+			TArray<double> ChildWeights;
+			ChildWeights.SetNumZeroed(Child.Prod.Num());
+			for (int32 k = 0; k < ChildWeights.Num(); k++)
+			{
+				double Sum = 0.0;
+				for (int32 b = 0; b < Sibling.Prod.Num(); b++)
+				{
+					const int32 WeightIndex = k + b + Shift;
+					if (WeightIndex >= 0 && WeightIndex < Weights.Num())
+					{
+						Sum += Sibling.Prod[b] * Weights[WeightIndex];
+					}
+				}
+				ChildWeights[k] = Sum;
+			}
+			Normalize(ChildWeights);
+			return ChildWeights;
+		};
+
+		const FCombineNode& Left = Nodes[Node.Left];
+		const FCombineNode& Right = Nodes[Node.Right];
+		DistributeWeights(Nodes, Node.Left, WeightsForChild(Left, Right), OutComponentWeights);
+		DistributeWeights(Nodes, Node.Right, WeightsForChild(Right, Left), OutComponentWeights);
+	}
+}
+
+bool FMineProbabilitySolver::Solve(const FMineBoardVersion& Version, FMineProbabilityMap& OutMap, const std::atomic<bool>* bCancelled) const
+{
+	using namespace MineProbability;
+
+	const FMineBoardDims Dims = Version.Dims;
+	const int32 NumFields = Dims.Num();
+
+	OutMap.Serial = Version.Serial;
+	OutMap.Dims = Dims;
+	OutMap.Probabilities.Init(-1.0f, NumFields);
+	OutMap.bExact = true;
+	OutMap.bConsistent = true;
+	OutMap.NumComponents = 0;
+	OutMap.NumFrontierFields = 0;
+
+	//Nothing left to guess
+	if (Version.bGameOver || NumFields == 0)
+	{
+		return true;
+	}
+
+	TArray<uint8> States;
+	States.SetNumUninitialized(NumFields);
+	int32 NumFlags = 0;
+	int32 NumUnknown = 0;
+	for (int32 Row = 0; Row < Dims.Rows; Row++)
+	{
+		for (int32 Col = 0; Col < Dims.Columns; Col++)
+		{
+			const uint8 State = Version.GetState(Col, Row);
+			States[Dims.ToIndex(Col, Row)] = State;
+			NumFlags += State == uint8(EMineCellState::Flagged) ? 1 : 0;
+			NumUnknown += State == uint8(EMineCellState::Hidden) ? 1 : 0;
+		}
+	}
+
+	const int32 RemainingMines = Version.MineCount - NumFlags;
+	if (RemainingMines < 0 || RemainingMines > NumUnknown)
+	{
+		OutMap.bConsistent = false;
+		return true;
+	}
+
+	//Every revealed number with hidden fields around it becomes a constraint on those fields
+	TArray<FConstraint> Constraints;
+	TArray<int32> VarOfField;
+	VarOfField.Init(INDEX_NONE, NumFields);
+	TArray<int32> FieldOfVar;
+	DispatchMineTopology(Version.Topology, [&](auto Policy)
+	{
+		using FPolicy = decltype(Policy);
+		for (int32 Row = 0; Row < Dims.Rows; Row++)
+		{
+			for (int32 Col = 0; Col < Dims.Columns; Col++)
+			{
+				const uint8 State = States[Dims.ToIndex(Col, Row)];
+				if (State >= uint8(EMineCellState::Hidden))
+				{
+					continue;
+				}
+
+				FConstraint Constraint;
+				Constraint.Need = State;
+				FPolicy::ForEachNeighbour(Dims, Col, Row, [&](int32 NeighbourCol, int32 NeighbourRow, int32 NeighbourIndex)
+				{
+					const uint8 NeighbourState = States[NeighbourIndex];
+					if (NeighbourState == uint8(EMineCellState::Flagged))
+					{
+						Constraint.Need--;
+					}
+					else if (NeighbourState == uint8(EMineCellState::Hidden))
+					{
+						if (VarOfField[NeighbourIndex] == INDEX_NONE)
+						{
+							VarOfField[NeighbourIndex] = FieldOfVar.Add(NeighbourIndex);
+						}
+						Constraint.Vars.AddUnique(VarOfField[NeighbourIndex]);
+					}
+				});
+
+				if (Constraint.Need < 0 || Constraint.Need > Constraint.Vars.Num())
+				{
+					OutMap.bConsistent = false;
+				}
+				if (Constraint.Vars.Num() > 0)
+				{
+					Constraints.Add(MoveTemp(Constraint));
+				}
+			}
+		}
+	});
+
+	if (!OutMap.bConsistent)
+	{
+		return true;
+	}
+
+	//Split the frontier into components of fields linked through shared numbers
+	const int32 NumVars = FieldOfVar.Num();
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(NumVars);
+	for (int32 Var = 0; Var < NumVars; Var++)
+	{
+		Parents[Var] = Var;
+	}
+	auto FindRoot = [&Parents](int32 Var)
+	{
+		while (Parents[Var] != Var)
+		{
+			Parents[Var] = Parents[Parents[Var]];
+			Var = Parents[Var];
+		}
+		return Var;
+	};
+	for (const FConstraint& Constraint : Constraints)
+	{
+		const int32 Root = FindRoot(Constraint.Vars[0]);
+		for (const int32 Var : Constraint.Vars)
+		{
+			Parents[FindRoot(Var)] = Root;
+		}
+	}
+
+	TArray<int32> ComponentOfRoot;
+	ComponentOfRoot.Init(INDEX_NONE, NumVars);
+	TArray<TArray<int32>> ConstraintsOfComponent;
+	for (int32 ConstraintIndex = 0; ConstraintIndex < Constraints.Num(); ConstraintIndex++)
+	{
+		const int32 Root = FindRoot(Constraints[ConstraintIndex].Vars[0]);
+		if (ComponentOfRoot[Root] == INDEX_NONE)
+		{
+			ComponentOfRoot[Root] = ConstraintsOfComponent.AddDefaulted();
+		}
+		ConstraintsOfComponent[ComponentOfRoot[Root]].Add(ConstraintIndex);
+	}
+
+	const int32 NumComponents = ConstraintsOfComponent.Num();
+	const int32 NumOpenFields = NumUnknown - NumVars;
+	OutMap.NumComponents = NumComponents;
+	OutMap.NumFrontierFields = NumVars;
+
+	//Count every component with its fields renumbered in the order a breadth first walk along its numbers reaches them,
+	//which follows the frontier and keeps few numbers open at a time
+	TArray<FComponentCounts> Counts;
+	Counts.SetNum(NumComponents);
+	TArray<TArray<int32>> FieldsOfComponent;
+	FieldsOfComponent.SetNum(NumComponents);
+	TArray<TArray<int32>> VarConstraints;
+	VarConstraints.SetNum(NumVars);
+	for (int32 ConstraintIndex = 0; ConstraintIndex < Constraints.Num(); ConstraintIndex++)
+	{
+		for (const int32 Var : Constraints[ConstraintIndex].Vars)
+		{
+			VarConstraints[Var].Add(ConstraintIndex);
+		}
+	}
+
+	//Shared by all components. A huge component can't starve the others, it only gets a share of what is left.
+	int64 BudgetLeft = NodeBudget;
+
+	TArray<int32> LocalOfVar;
+	LocalOfVar.Init(INDEX_NONE, NumVars);
+	TBitArray<> ConstraintVisited(false, Constraints.Num());
+	for (int32 ComponentIndex = 0; ComponentIndex < NumComponents; ComponentIndex++)
+	{
+		TArray<int32>& Fields = FieldsOfComponent[ComponentIndex];
+		const int32 StartVar = Constraints[ConstraintsOfComponent[ComponentIndex][0]].Vars[0];
+		TArray<int32> LocalVars;
+		LocalVars.Add(StartVar);
+		LocalOfVar[StartVar] = 0;
+		for (int32 Cursor = 0; Cursor < LocalVars.Num(); Cursor++)
+		{
+			for (const int32 ConstraintIndex : VarConstraints[LocalVars[Cursor]])
+			{
+				if (ConstraintVisited[ConstraintIndex])
+				{
+					continue;
+				}
+				ConstraintVisited[ConstraintIndex] = true;
+				for (const int32 Var : Constraints[ConstraintIndex].Vars)
+				{
+					if (LocalOfVar[Var] == INDEX_NONE)
+					{
+						LocalOfVar[Var] = LocalVars.Add(Var);
+					}
+				}
+			}
+		}
+
+		TArray<FConstraint> LocalConstraints;
+		LocalConstraints.Reserve(ConstraintsOfComponent[ComponentIndex].Num());
+		for (const int32 ConstraintIndex : ConstraintsOfComponent[ComponentIndex])
+		{
+			FConstraint& Local = LocalConstraints.AddDefaulted_GetRef();
+			Local.Need = Constraints[ConstraintIndex].Need;
+			for (const int32 Var : Constraints[ConstraintIndex].Vars)
+			{
+				Local.Vars.Add(LocalOfVar[Var]);
+			}
+		}
+
+		Fields.Reserve(LocalVars.Num());
+		for (const int32 Var : LocalVars)
+		{
+			Fields.Add(FieldOfVar[Var]);
+		}
+
+		int64 ComponentBudget = FMath::Min(BudgetLeft, NodeBudget / 4);
+		const int64 BudgetBefore = ComponentBudget;
+		if (!CountComponent(LocalConstraints, LocalVars.Num(), RemainingMines, ComponentBudget, bCancelled, Counts[ComponentIndex]))
+		{
+			return false;
+		}
+		BudgetLeft -= BudgetBefore - ComponentBudget;
+		if (Counts[ComponentIndex].Ways.Num() == 0)
+		{
+			OutMap.bConsistent = false;
+			return true;
+		}
+		OutMap.bExact &= Counts[ComponentIndex].bExact;
+	}
+
+	//Estimated components keep their own guess and take their expected mines out of the pool, everything else is weighed exactly
+	TArray<int32> ExactComponents;
+	int32 PoolMines = RemainingMines;
+	for (int32 ComponentIndex = 0; ComponentIndex < NumComponents; ComponentIndex++)
+	{
+		const FComponentCounts& ComponentCounts = Counts[ComponentIndex];
+		if (ComponentCounts.bExact)
+		{
+			ExactComponents.Add(ComponentIndex);
+			continue;
+		}
+		const TArray<int32>& Fields = FieldsOfComponent[ComponentIndex];
+		for (int32 LocalVar = 0; LocalVar < Fields.Num(); LocalVar++)
+		{
+			OutMap.Probabilities[Fields[LocalVar]] = float(FMath::Clamp(ComponentCounts.MineWays[LocalVar][0], 0.0, 1.0));
+		}
+		PoolMines -= ComponentCounts.Offset;
+	}
+	PoolMines = FMath::Max(PoolMines, 0);
+
+	//Ways to put the remaining mines on the open fields when the frontier takes K of them, relative to the best K
+	TArray<double> LogFactorials;
+	LogFactorials.SetNumUninitialized(NumOpenFields + 1);
+	LogFactorials[0] = 0.0;
+	for (int32 i = 1; i <= NumOpenFields; i++)
+	{
+		LogFactorials[i] = LogFactorials[i - 1] + FMath::Loge(double(i));
+	}
+	TArray<double> LogWeights;
+	LogWeights.Init(TNumericLimits<double>::Lowest(), PoolMines + 1);
+	double MaxLogWeight = TNumericLimits<double>::Lowest();
+	for (int32 K = 0; K <= PoolMines; K++)
+	{
+		const int32 OpenMines = PoolMines - K;
+		if (OpenMines <= NumOpenFields)
+		{
+			LogWeights[K] = LogFactorials[NumOpenFields] - LogFactorials[OpenMines] - LogFactorials[NumOpenFields - OpenMines];
+			MaxLogWeight = FMath::Max(MaxLogWeight, LogWeights[K]);
+		}
+	}
+	TArray<double> Weights;
+	Weights.SetNumZeroed(PoolMines + 1);
+	for (int32 K = 0; K <= PoolMines; K++)
+	{
+		if (LogWeights[K] > TNumericLimits<double>::Lowest())
+		{
+			Weights[K] = FMath::Exp(LogWeights[K] - MaxLogWeight);
+		}
+	}
+
+	if (bCancelled && bCancelled->load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	//FrontierWays[K] counts the frontier solutions with FrontierOffset + K mines
+	TArray<double> FrontierWays = { 1.0 };
+	int32 FrontierOffset = 0;
+	if (ExactComponents.Num() > 0)
+	{
+		TArray<FCombineNode> Nodes;
+		Nodes.Reserve(ExactComponents.Num() * 2);
+		const int32 Root = BuildCombineTree(Nodes, Counts, ExactComponents, 0, ExactComponents.Num(), PoolMines + 1);
+		FrontierWays = Nodes[Root].Prod;
+		FrontierOffset = Nodes[Root].Offset;
+
+		TArray<double> RootWeights;
+		RootWeights.SetNumZeroed(FrontierWays.Num());
+		for (int32 K = 0; K < RootWeights.Num() && FrontierOffset + K <= PoolMines; K++)
+		{
+			RootWeights[K] = Weights[FrontierOffset + K];
+		}
+
+		TArray<TArray<double>> ComponentWeights;
+		ComponentWeights.SetNum(NumComponents);
+		DistributeWeights(Nodes, Root, RootWeights, ComponentWeights);
+
+		for (const int32 ComponentIndex : ExactComponents)
+		{
+			const FComponentCounts& ComponentCounts = Counts[ComponentIndex];
+			const TArray<double>& ComponentWeight = ComponentWeights[ComponentIndex];
+
+			double Total = 0.0;
+			for (int32 k = 0; k < ComponentCounts.Ways.Num() && k < ComponentWeight.Num(); k++)
+			{
+				Total += ComponentCounts.Ways[k] * ComponentWeight[k];
+			}
+
+			//With estimates in the pool its mine count is only a guess, so fall back to the component on its own
+			const bool bIgnoreWeights = Total <= 0.0 && !OutMap.bExact;
+			if (bIgnoreWeights)
+			{
+				for (const double Ways : ComponentCounts.Ways)
+				{
+					Total += Ways;
+				}
+			}
+			if (Total <= 0.0)
+			{
+				//The components can't share out the mine count
+				OutMap.bConsistent = false;
+				OutMap.Probabilities.Init(-1.0f, NumFields);
+				return true;
+			}
+
+			const TArray<int32>& Fields = FieldsOfComponent[ComponentIndex];
+			for (int32 LocalVar = 0; LocalVar < Fields.Num(); LocalVar++)
+			{
+				const TArray<double>& MineWays = ComponentCounts.MineWays[LocalVar];
+				double Mines = 0.0;
+				for (int32 k = 0; k < MineWays.Num() && (bIgnoreWeights || k < ComponentWeight.Num()); k++)
+				{
+					Mines += MineWays[k] * (bIgnoreWeights ? 1.0 : ComponentWeight[k]);
+				}
+				OutMap.Probabilities[Fields[LocalVar]] = float(FMath::Clamp(Mines / Total, 0.0, 1.0));
+			}
+		}
+	}
+
+	//Open fields share whatever the frontier leaves over evenly
+	if (NumOpenFields > 0)
+	{
+		double Total = 0.0;
+		double ExpectedOpenMines = 0.0;
+		for (int32 K = 0; K < FrontierWays.Num() && FrontierOffset + K <= PoolMines; K++)
+		{
+			const double Weighted = FrontierWays[K] * Weights[FrontierOffset + K];
+			Total += Weighted;
+			ExpectedOpenMines += Weighted * (PoolMines - FrontierOffset - K);
+		}
+		const double OpenMines = Total > 0.0 ? ExpectedOpenMines / Total : PoolMines;
+		const float OpenProbability = float(FMath::Clamp(OpenMines / NumOpenFields, 0.0, 1.0));
+		for (int32 Index = 0; Index < NumFields; Index++)
+		{
+			if (States[Index] == uint8(EMineCellState::Hidden) && VarOfField[Index] == INDEX_NONE)
+			{
+				OutMap.Probabilities[Index] = OpenProbability;
+			}
+		}
+	}
+
+	return true;
+}
+
+namespace MineProbability
+{
+	static constexpr int32 MaxCachedMaps = 16;
+	static constexpr int64 MaxCachedBytes = 64 * 1024 * 1024;
+
+	typedef TSharedPtr<const FMineProbabilityMap, ESPMode::ThreadSafe> FCachedMap;
+
+	//Game thread only
+	static TMineStateCache<FCachedMap>& GetMapCache()
+	{
+		static TMineStateCache<FCachedMap> Cache(MaxCachedMaps, MaxCachedBytes);
+		return Cache;
+	}
+}
+
+TSharedRef<FMineProbabilityJob, ESPMode::ThreadSafe> FMineProbabilityJob::Launch(TRefCountPtr<const FMineBoardVersion> Version, FOnMineProbabilitiesReady OnReady)
+{
+	check(IsInGameThread());
+
+	TSharedRef<FMineProbabilityJob, ESPMode::ThreadSafe> Job = MakeShareable(new FMineProbabilityJob());
+	Job->OnReady = MoveTemp(OnReady);
+	if (!Version.IsValid())
+	{
+		return Job;
+	}
+
+	const uint64 StateHash = Version->StateHash;
+	const bool bCacheable = Version->bStateHashComplete;
+	if (bCacheable)
+	{
+		if (const MineProbability::FCachedMap* CachedMap = MineProbability::GetMapCache().Find(StateHash))
+		{
+			TSharedRef<FMineProbabilityMap, ESPMode::ThreadSafe> Map = MakeShared<FMineProbabilityMap, ESPMode::ThreadSafe>(**CachedMap);
+			Map->Serial = Version->Serial;
+			UE_LOG(DetailPanel, Verbose, TEXT("Mine probabilities for board version %llu taken from the cache"), Map->Serial);
+
+			//Still handed over on a later tick, callers see the same order of events either way
+			AsyncTask(ENamedThreads::GameThread, [Job, Map]()
+			{
+				if (!Job->IsCancelled())
+				{
+					Job->OnReady.ExecuteIfBound(*Map);
+				}
+			});
+			return Job;
+		}
+	}
+
+	Async(EAsyncExecution::ThreadPool, [Job, Version, StateHash, bCacheable]()
+	{
+		TSharedRef<FMineProbabilityMap, ESPMode::ThreadSafe> Map = MakeShared<FMineProbabilityMap, ESPMode::ThreadSafe>();
+		const double StartTime = FPlatformTime::Seconds();
+		if (!FMineProbabilitySolver().Solve(*Version, *Map, &Job->bCancelled))
+		{
+			return;
+		}
+		UE_LOG(DetailPanel, Verbose, TEXT("Mine probabilities for board version %llu: %d frontier fields in %d components, %s, %.2f ms"),
+			Map->Serial, Map->NumFrontierFields, Map->NumComponents, Map->bExact ? TEXT("exact") : TEXT("estimated"), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+		AsyncTask(ENamedThreads::GameThread, [Job, Map, StateHash, bCacheable]()
+		{
+			//Kept even if the job was cancelled in the meantime, the state may well come back
+			if (bCacheable)
+			{
+				MineProbability::GetMapCache().Add(StateHash, Map, Map->Probabilities.Num() * sizeof(float));
+			}
+			if (!Job->IsCancelled())
+			{
+				Job->OnReady.ExecuteIfBound(*Map);
+			}
+		});
+	});
+	return Job;
+}
+
+void FMineProbabilityJob::Cancel()
+{
+	check(IsInGameThread());
+
+	bCancelled.store(true);
+	OnReady.Unbind();
+}
@@ -0,0 +1,506 @@
+#include "MineSharedMemoryBridge.h"
+#include "DetailPanel.h"
+#include "MineSweeperActor.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CoreDelegates.h"
+#include "UObject/UObjectIterator.h"
+
+#if MINESWEEPER_SHARED_MEMORY
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static TAutoConsoleVariable<int32> CVarMineSweeperBridgeMaxCommands(
+	TEXT("MineSweeper.Bridge.MaxCommandsPerTick"),
+	1 << 20,
+	TEXT("Most commands a shared memory bridge applies per frame."));
+
+static TAutoConsoleVariable<float> CVarMineSweeperBridgeMaxMs(
+	TEXT("MineSweeper.Bridge.MaxMillisecondsPerTick"),
+	8.0f,
+	TEXT("Most time in milliseconds a shared memory bridge spends on commands per frame."));
+
+namespace MineSharedMemoryBridge
+{
+	//Room kept in the event ring while a move reports its fields, for a Resync and the MoveDone
+	static constexpr uint32 MoveReserve = 2;
+
+	//Commands between two looks at the clock
+	static constexpr int32 CommandsPerTimeCheck = 256;
+
+	static uint64 AlignOffset(uint64 Offset, uint64 Alignment)
+	{
+		return (Offset + Alignment - 1) & ~(Alignment - 1);
+	}
+}
+
+FMineSharedMemoryBridge::~FMineSharedMemoryBridge()
+{
+	Stop();
+}
+
+bool FMineSharedMemoryBridge::Start(AMineSweeperActor* InActor, const FString& Name, int32 CellCapacity, int32 RingCapacity)
+{
+	using namespace MineSharedMemoryBridge;
+
+	Stop();
+
+	if (!InActor || !InActor->HasAuthority())
+	{
+		UE_LOG(DetailPanel, Warning, TEXT("Shared memory bridges need an actor with authority"));
+		return false;
+	}
+
+#if MINESWEEPER_SHARED_MEMORY
+	const int32 NumFields = InActor->GetNumColumns() * InActor->GetNumRows();
+	const uint32 NumCells = uint32(FMath::Max3(CellCapacity, NumFields, 1));
+	const uint32 RingEntries = FMath::RoundUpToPowerOfTwo(uint32(FMath::Max(RingCapacity, 16)));
+
+	const uint64 HeaderSize = AlignOffset(sizeof(MineShm::FHeader), 64);
+	const uint64 CommandRingOffset = AlignOffset(HeaderSize + NumCells, 64);
+	const uint64 EventRingOffset = AlignOffset(CommandRingOffset + sizeof(MineShm::FRingHeader) + RingEntries * sizeof(MineShm::FCommand), 64);
+	const uint64 TotalSize = AlignOffset(EventRingOffset + sizeof(MineShm::FRingHeader) + RingEntries * sizeof(MineShm::FEvent), 4096);
+
+	const FString FullName = FString(MineShm::NamePrefix) + Name;
+	const FTCHARToUTF8 NameUtf8(*FullName);
+
+	//A segment left behind by a crashed session would hold old rings
+	shm_unlink(NameUtf8.Get());
+	const int32 Handle = shm_open(NameUtf8.Get(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (Handle < 0)
+	{
+		UE_LOG(DetailPanel, Warning, TEXT("Could not create the shared memory segment %s, errno %d"), *FullName, errno);
+		return false;
+	}
+
+	void* Memory = MAP_FAILED;
+	if (ftruncate(Handle, off_t(TotalSize)) == 0)
+	{
+		Memory = mmap(nullptr, TotalSize, PROT_READ | PROT_WRITE, MAP_SHARED, Handle, 0);
+	}
+	close(Handle);
+
+	if (Memory == MAP_FAILED)
+	{
+		UE_LOG(DetailPanel, Warning, TEXT("Could not map the shared memory segment %s, errno %d"), *FullName, errno);
+		shm_unlink(NameUtf8.Get());
+		return false;
+	}
+
+	//New segments are zero filled, which is also the starting state of all the atomics
+	Header = new (Memory) MineShm::FHeader();
+	Header->Version = MineShm::Version;
+	Header->HeaderSize = uint32(HeaderSize);
+	Header->SegmentSize = TotalSize;
+	Header->CellCapacity = NumCells;
+	Header->CommandCapacity = RingEntries;
+	Header->EventCapacity = RingEntries;
+	Header->CellsOffset = HeaderSize;
+	Header->CommandRingOffset = CommandRingOffset;
+	Header->EventRingOffset = EventRingOffset;
+
+	CommandRing = new (MineShm::GetRing(Header, CommandRingOffset)) MineShm::FRingHeader();
+	EventRing = new (MineShm::GetRing(Header, EventRingOffset)) MineShm::FRingHeader();
+	Cells = MineShm::GetCells(Header);
+	SegmentName = FullName;
+	SegmentSize = TotalSize;
+
+	Actor = InActor;
+	WriteAllCells();
+	FlushResync();
+
+	//Clients wait for the magic, everything before it has to be visible first
+	std::atomic_thread_fence(std::memory_order_release);
+	Header->Magic = MineShm::Magic;
+
+	BoardChangedHandle = InActor->OnBoardChanged().AddRaw(this, &FMineSharedMemoryBridge::OnBoardChanged);
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FMineSharedMemoryBridge::Tick));
+
+	UE_LOG(DetailPanel, Log, TEXT("Shared memory bridge %s serves %s, %u cells, %u commands"), *SegmentName, *InActor->GetName(), NumCells, RingEntries);
+	return true;
+#else
+	UE_LOG(DetailPanel, Warning, TEXT("Shared memory bridges are not supported on this platform"));
+	return false;
+#endif
+}
+
+void FMineSharedMemoryBridge::Stop()
+{
+	if (!Header)
+	{
+		return;
+	}
+
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	if (Actor.IsValid())
+	{
+		Actor->OnBoardChanged().Remove(BoardChangedHandle);
+	}
+
+	Header->GameState.fetch_or(MineShm::StateDetached, std::memory_order_release);
+
+#if MINESWEEPER_SHARED_MEMORY
+	munmap(Header, SegmentSize);
+	shm_unlink(TCHAR_TO_UTF8(*SegmentName));
+#endif
+
+	UE_LOG(DetailPanel, Log, TEXT("Shared memory bridge %s stopped"), *SegmentName);
+
+	Header = nullptr;
+	CommandRing = nullptr;
+	EventRing = nullptr;
+	Cells = nullptr;
+	SegmentSize = 0;
+	Actor.Reset();
+	bResyncPending = false;
+	bMoveDoneDeferred = false;
+	ResetStats();
+}
+
+bool FMineSharedMemoryBridge::Tick(float DeltaTime)
+{
+	QUICK_SCOPE_CYCLE_COUNTER(STAT_MineSharedMemoryBridge_Tick);
+
+	if (!Actor.IsValid())
+	{
+		Stop();
+		return false;
+	}
+
+	FlushResync();
+	FlushDeferredMoveDone();
+	ProcessCommands(CVarMineSweeperBridgeMaxCommands.GetValueOnGameThread(), CVarMineSweeperBridgeMaxMs.GetValueOnGameThread() / 1000.0);
+	return true;
+}
+
+int32 FMineSharedMemoryBridge::ProcessCommands(int32 MaxCommands, double MaxSeconds)
+{
+	using namespace MineSharedMemoryBridge;
+
+	if (!Header || !Actor.IsValid())
+	{
+		return 0;
+	}
+
+	Header->Heartbeat.fetch_add(1, std::memory_order_relaxed);
+
+	const double EndTime = FPlatformTime::Seconds() + MaxSeconds;
+	int32 NumApplied = 0;
+	MineShm::Consume<MineShm::FCommand>(CommandRing, Header->CommandCapacity, uint32(FMath::Max(MaxCommands, 0)),
+		[&](const MineShm::FCommand& Command)
+		{
+			//Leave the command for later if its answer might not fit, a client that doesn't read events stalls itself
+			FlushResync();
+			if (!FlushDeferredMoveDone() || bResyncPending || MineShm::GetFree(EventRing, Header->EventCapacity) <= MoveReserve)
+			{
+				return false;
+			}
+			if (NumApplied > 0 && NumApplied % CommandsPerTimeCheck == 0 && FPlatformTime::Seconds() > EndTime)
+			{
+				return false;
+			}
+
+			ApplyCommand(Command);
+			NumApplied++;
+			return true;
+		});
+
+	return NumApplied;
+}
+
+void FMineSharedMemoryBridge::ResetStats()
+{
+	NumAppliedMoves = 0;
+	NumRejectedMoves = 0;
+	MoveSeconds = 0.0;
+}
+
+void FMineSharedMemoryBridge::ApplyCommand(const MineShm::FCommand& Command)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumColumns = Actor->GetNumColumns();
+	const int32 ColIndex = NumColumns > 0 ? Command.Index % NumColumns : 0;
+	const int32 RowIndex = NumColumns > 0 ? Command.Index / NumColumns : 0;
+	const bool bValidField = Command.Index >= 0 && Actor->IsValidIndex(ColIndex, RowIndex);
+
+	//The changes arrive through OnBoardChanged while the move runs
+	MineShm::EMoveResult Result = MineShm::EMoveResult::Rejected;
+	switch (MineShm::ECommand(Command.Type))
+	{
+	case MineShm::ECommand::Click:
+		if (bValidField && Actor->CanClickOnField(ColIndex, RowIndex))
+		{
+			Actor->HandleClickOnField(ColIndex, RowIndex);
+			Result = MineShm::EMoveResult::Applied;
+		}
+		break;
+	case MineShm::ECommand::Flag:
+		if (bValidField && Actor->CanRightClickOnField(ColIndex, RowIndex))
+		{
+			Actor->HandleRightClickOnField(ColIndex, RowIndex);
+			Result = MineShm::EMoveResult::Applied;
+		}
+		break;
+	case MineShm::ECommand::Chord:
+		if (bValidField && Actor->CanChordOnField(ColIndex, RowIndex))
+		{
+			Actor->HandleChordOnField(ColIndex, RowIndex);
+			Result = MineShm::EMoveResult::Applied;
+		}
+		break;
+	case MineShm::ECommand::Reset:
+		Actor->ResetBoard();
+		Result = MineShm::EMoveResult::Applied;
+		break;
+	default:
+		Result = MineShm::EMoveResult::Unknown;
+		break;
+	}
+
+	FlushResync();
+
+	MoveSeconds += FPlatformTime::Seconds() - StartTime;
+	NumAppliedMoves += Result == MineShm::EMoveResult::Applied ? 1 : 0;
+	NumRejectedMoves += Result == MineShm::EMoveResult::Applied ? 0 : 1;
+
+	//With a reveal budget the cascade goes on over the next frames, its FieldChanged events have to come first
+	if (Actor->GetBoard().HasPendingReveal())
+	{
+		bMoveDoneDeferred = true;
+		DeferredMoveIndex = Command.Index;
+		DeferredMoveResult = uint8(Result);
+		return;
+	}
+	PushEvent(MineShm::EEvent::MoveDone, Command.Index, uint8(Result), 0);
+}
+
+bool FMineSharedMemoryBridge::FlushDeferredMoveDone()
+{
+	if (!bMoveDoneDeferred)
+	{
+		return true;
+	}
+	if (Actor->GetBoard().HasPendingReveal() || bResyncPending)
+	{
+		return false;
+	}
+	if (!PushEvent(MineShm::EEvent::MoveDone, DeferredMoveIndex, DeferredMoveResult, 0))
+	{
+		return false;
+	}
+	bMoveDoneDeferred = false;
+	return true;
+}
+
+void FMineSharedMemoryBridge::OnBoardChanged(const TArray<int32>& ChangedIndices)
+{
+	using namespace MineSharedMemoryBridge;
+
+	if (!Header || !Actor.IsValid())
+	{
+		return;
+	}
+
+	//Mines show everywhere once the game is over, not only on the fields the last move touched
+	const int32 NumColumns = Actor->GetNumColumns();
+	const bool bGameOver = Actor->IsGameOver();
+	if (ChangedIndices.Num() == 0 || bGameOver != bLastGameOver || NumColumns != Header->Columns.load(std::memory_order_relaxed)
+		|| Actor->GetNumRows() != Header->Rows.load(std::memory_order_relaxed))
+	{
+		WriteAllCells();
+		FlushResync();
+		return;
+	}
+
+	BeginCellWrite();
+	for (const int32 Index : ChangedIndices)
+	{
+		const int32 ColIndex = Index % NumColumns;
+		const int32 RowIndex = Index / NumColumns;
+		Actor->FillBoardSnapshot(FIntRect(ColIndex, RowIndex, ColIndex + 1, RowIndex + 1), false, Scratch);
+		if (Scratch.Num() == 1)
+		{
+			Cells[Index] = Scratch[0];
+		}
+	}
+	EndCellWrite();
+	UpdateGameState();
+
+	//Once the ring is too full for a field the client has to read all of them anyway
+	for (const int32 Index : ChangedIndices)
+	{
+		if (bResyncPending || !PushEvent(MineShm::EEvent::FieldChanged, Index, Cells[Index], MoveReserve))
+		{
+			if (!bResyncPending)
+			{
+				Header->EventsDropped.fetch_add(1, std::memory_order_relaxed);
+				bResyncPending = true;
+			}
+			break;
+		}
+	}
+	FlushResync();
+}
+
+void FMineSharedMemoryBridge::WriteAllCells()
+{
+	const int32 NumColumns = Actor->GetNumColumns();
+	const int32 NumRows = Actor->GetNumRows();
+	Actor->FillBoardSnapshot(FIntRect(0, 0, NumColumns, NumRows), false, Scratch);
+
+	BeginCellWrite();
+	if (uint32(Scratch.Num()) <= Header->CellCapacity)
+	{
+		FMemory::Memcpy(Cells, Scratch.GetData(), Scratch.Num());
+		Header->Columns.store(NumColumns, std::memory_order_relaxed);
+		Header->Rows.store(NumRows, std::memory_order_relaxed);
+	}
+	else
+	{
+		//Bots see an empty board until it fits again
+		UE_LOG(DetailPanel, Warning, TEXT("Board of %d fields does not fit into the shared memory bridge %s"), Scratch.Num(), *SegmentName);
+		Header->Columns.store(0, std::memory_order_relaxed);
+		Header->Rows.store(0, std::memory_order_relaxed);
+	}
+	EndCellWrite();
+
+	UpdateGameState();
+	bResyncPending = true;
+}
+
+void FMineSharedMemoryBridge::UpdateGameState()
+{
+	const FMineSweeperBoard& Board = Actor->GetBoard();
+	bLastGameOver = Board.IsGameOver();
+
+	uint32 GameState = 0;
+	GameState |= Board.IsGenerated() ? MineShm::StateGenerated : 0;
+	GameState |= Board.IsGameOver() ? MineShm::StateGameOver : 0;
+	GameState |= Board.HasWon() ? MineShm::StateWon : 0;
+	Header->MineCount.store(Board.GetMineCount(), std::memory_order_relaxed);
+	Header->GameState.store(GameState, std::memory_order_release);
+}
+
+bool FMineSharedMemoryBridge::PushEvent(MineShm::EEvent Type, int32 Index, uint8 State, uint32 Reserve)
+{
+	if (MineShm::GetFree(EventRing, Header->EventCapacity) <= Reserve)
+	{
+		return false;
+	}
+
+	MineShm::FEvent Event;
+	Event.Index = Index;
+	Event.Type = uint8(Type);
+	Event.State = State;
+	Event.Reserved = 0;
+	return MineShm::Push(EventRing, Header->EventCapacity, Event);
+}
+
+void FMineSharedMemoryBridge::FlushResync()
+{
+	if (bResyncPending && PushEvent(MineShm::EEvent::Resync, INDEX_NONE, 0, 1))
+	{
+		bResyncPending = false;
+	}
+}
+
+void FMineSharedMemoryBridge::BeginCellWrite()
+{
+	Header->BoardSerial.fetch_add(1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+}
+
+void FMineSharedMemoryBridge::EndCellWrite()
+{
+	Header->BoardSerial.fetch_add(1, std::memory_order_release);
+}
+
+namespace MineSharedMemoryBridge
+{
+	//Bridges started from the console, by segment name
+	static TMap<FString, TUniquePtr<FMineSharedMemoryBridge>> ConsoleBridges;
+
+	static AMineSweeperActor* FindActor(const FString& ActorName)
+	{
+		for (TObjectIterator<AMineSweeperActor> It; It; ++It)
+		{
+			AMineSweeperActor* Actor = *It;
+			if (IsValid(Actor) && !Actor->IsTemplate() && Actor->GetWorld() && (ActorName.IsEmpty() || Actor->GetName() == ActorName || Actor->GetActorNameOrLabel() == ActorName))
+			{
+				return Actor;
+			}
+		}
+		return nullptr;
+	}
+
+	static void StartBridge(const TArray<FString>& Args)
+	{
+		AMineSweeperActor* Actor = FindActor(Args.Num() > 0 ? Args[0] : FString());
+		if (!Actor)
+		{
+			UE_LOG(DetailPanel, Warning, TEXT("No minesweeper actor found to start a shared memory bridge for"));
+			return;
+		}
+
+		const FString Name = Args.Num() > 1 ? Args[1] : Actor->GetName();
+		const int32 CellCapacity = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 0;
+
+		//Stopping a bridge unlinks its segment, so the old one has to go before the new one creates it
+		ConsoleBridges.Remove(FString(MineShm::NamePrefix) + Name);
+
+		TUniquePtr<FMineSharedMemoryBridge> Bridge = MakeUnique<FMineSharedMemoryBridge>();
+		if (Bridge->Start(Actor, Name, CellCapacity))
+		{
+			//Remove the segments while the ticker is still around
+			static FDelegateHandle PreExitHandle = FCoreDelegates::OnPreExit.AddLambda([]() { ConsoleBridges.Empty(); });
+
+			ConsoleBridges.Add(Bridge->GetSegmentName(), MoveTemp(Bridge));
+		}
+	}
+
+	static void StopBridges(const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0)
+		{
+			ConsoleBridges.Empty();
+			return;
+		}
+		ConsoleBridges.Remove(FString(MineShm::NamePrefix) + Args[0]);
+	}
+
+	static void ReportBridges(const TArray<FString>& Args)
+	{
+		const double FrameMs = CVarMineSweeperBridgeMaxMs.GetValueOnGameThread();
+		for (TPair<FString, TUniquePtr<FMineSharedMemoryBridge>>& Pair : ConsoleBridges)
+		{
+			FMineSharedMemoryBridge& Bridge = *Pair.Value;
+			const double MoveUs = Bridge.GetNumAppliedMoves() > 0 ? Bridge.GetMoveSeconds() * 1000000.0 / Bridge.GetNumAppliedMoves() : 0.0;
+			UE_LOG(DetailPanel, Display, TEXT("%s: %llu moves applied, %llu rejected, %.1f us per applied move on the game thread, %.0f moves per frame within %.1f ms"),
+				*Pair.Key, Bridge.GetNumAppliedMoves(), Bridge.GetNumRejectedMoves(), MoveUs, MoveUs > 0.0 ? FrameMs * 1000.0 / MoveUs : 0.0, FrameMs);
+
+			if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+			{
+				Bridge.ResetStats();
+			}
+		}
+	}
+
+	static FAutoConsoleCommand StartCommand(
+		TEXT("MineSweeper.Bridge.Start"),
+		TEXT("Exposes a minesweeper board to bot processes through shared memory. Arguments: [ActorName] [SegmentName] [CellCapacity], defaults to the first actor found and its name."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&StartBridge));
+
+	static FAutoConsoleCommand StopCommand(
+		TEXT("MineSweeper.Bridge.Stop"),
+		TEXT("Stops the shared memory bridge with the given segment name, or all of them."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&StopBridges));
+
+	static FAutoConsoleCommand ReportCommand(
+		TEXT("MineSweeper.Bridge.Report"),
+		TEXT("Logs how many moves every shared memory bridge applied and what one took on the game thread. Pass reset to start over."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&ReportBridges));
+}
@@ -1,5 +1,41 @@
 #include "MineSweeperActor.h"
-#include "Kismet/KismetMathLibrary.h"
+#include "DetailPanel.h"
+#include "MineSweeperNetComponent.h"
+#include "MineBoardSnapshot.h"
+#include "MineBoardFile.h"
+#include "MineSweeperMemory.h"
+#include "MineSweeperSettings.h"
+#include "GameFramework/PlayerController.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/CustomVersion.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/UObjectIterator.h"
+
+//Versions of what AMineSweeperActor::Serialize writes after the properties
+struct FMineSweeperCustomVersion
+{
+	enum Type
+	{
+		BeforeCustomVersion = 0,
+		//The board moved out of the properties into FMineSweeperBoard
+		BoardCore = 1,
+		//The move log is no longer a property, it is written after the board
+		MoveLogCore = 2,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
+const FGuid FMineSweeperCustomVersion::GUID(0x6A1C3F52, 0x48E94B0D, 0x9B27C1A4, 0x3E5D7F08);
+static FCustomVersionRegistration GRegisterMineSweeperCustomVersion(FMineSweeperCustomVersion::GUID, FMineSweeperCustomVersion::LatestVersion, TEXT("MineSweeperVer"));
 
 // Sets default values
 AMineSweeperActor::AMineSweeperActor(const FObjectInitializer& ObjectInitializer)
@@ -8,62 +44,234 @@ AMineSweeperActor::AMineSweeperActor(const FObjectInitializer& ObjectInitializer
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = false;
 
-	//Since the board is random, Initialize will not be consistent in multiple calls.
-	//That has a tendency to cause issues with the copy properties functions for objects.
-	//Hence we try to initialize only for the CDO and copy for everything else.
-	if (HasAnyFlags(RF_ClassDefaultObject))
+	//The board is server authoritative and every player needs to see it
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	NetBoardState.OwnerActor = this;
+	bNetBoardGenerated = false;
+	bNetGameOver = false;
+	bNetHasWon = false;
+
+	SceneRoot = CreateDefaultSubobject<USceneComponent>(TEXT("SceneRoot"));
+	RootComponent = SceneRoot;
+
+	BoardInstances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("BoardInstances"));
+	BoardInstances->SetupAttachment(SceneRoot);
+	BoardInstances->NumCustomDataFloats = 2;
+	BoardInstances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	BoardInstances->SetCanEverAffectNavigation(false);
+
+	//No board work here. The mines are placed on the first click, so the CDO, archetypes and actors that are never played stay empty.
+	Initialize();
+}
+
+void AMineSweeperActor::PostInitProperties()
+{
+	Super::PostInitProperties();
+}
+
+void AMineSweeperActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetNetMode() != NM_Standalone)
+	{
+		//The saved mine layout is in every client's copy of the level, so a networked game starts on a fresh board
+		if (HasAuthority())
+		{
+			ResetBoard();
+		}
+		else if (NetMineWords.Num() == 0)
+		{
+			Board.SetMines(TArray<bool>());
+		}
+	}
+}
+
+void AMineSweeperActor::BeginDestroy()
+{
+	Board.CancelReveal();
+	UpdateCascadeTicker();
+
+	Super::BeginDestroy();
+}
+
+void AMineSweeperActor::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	RebuildWorldBoard();
+}
+
+void AMineSweeperActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AMineSweeperActor, ColumnNum);
+	DOREPLIFETIME(AMineSweeperActor, RowNum);
+	DOREPLIFETIME(AMineSweeperActor, LayerNum);
+	DOREPLIFETIME(AMineSweeperActor, Topology);
+	DOREPLIFETIME(AMineSweeperActor, NetMineCount);
+	DOREPLIFETIME(AMineSweeperActor, bNetBoardGenerated);
+	DOREPLIFETIME(AMineSweeperActor, bNetGameOver);
+	DOREPLIFETIME(AMineSweeperActor, bNetHasWon);
+	DOREPLIFETIME(AMineSweeperActor, NetHitMineIndex);
+	DOREPLIFETIME(AMineSweeperActor, BoardEpoch);
+	DOREPLIFETIME(AMineSweeperActor, NetBoardState);
+	DOREPLIFETIME(AMineSweeperActor, NetMineWords);
+}
+
+void AMineSweeperActor::Initialize()
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	//The mine count is known before the mines are placed so the counter is right from the start
+	Board.Reset(GetBoardDims(), GetTopology(), CalcPlannedMineCount());
+	FirstClickIndex = INDEX_NONE;
+	CachedBoardStats.Reset();
+}
+
+void AMineSweeperActor::Serialize(FArchive& Ar)
+{
+	//Transactions snapshot the actor through here, so undo history of boards is counted too
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	Super::Serialize(Ar);
+
+	Ar.UsingCustomVersion(FMineSweeperCustomVersion::GUID);
+	if (Ar.IsLoading() && Ar.CustomVer(FMineSweeperCustomVersion::GUID) < FMineSweeperCustomVersion::BoardCore)
 	{
+		//The old board properties are gone, start from an empty board of the saved size
 		Initialize();
-		CheckAndGenerateBoard();
+		return;
 	}
-	else
+
+	Ar << Board;
+
+	if (!Ar.IsLoading() || Ar.CustomVer(FMineSweeperCustomVersion::GUID) >= FMineSweeperCustomVersion::MoveLogCore)
 	{
-		if (AMineSweeperActor* Other = Cast<AMineSweeperActor>(ObjectInitializer.GetArchetype()))
+		//Wrapped in its own bytes so a log of another encoding only drops the log and not the rest of the actor
+		TArray<uint8> MoveLogBytes;
+		if (Ar.IsSaving())
 		{
-			MineCount = Other->MineCount;
-			bBoardGenerated = Other->bBoardGenerated;
-			bGameOver = Other->bGameOver;
-			bHasWon = Other->bHasWon;
-			HitMineIndex = Other->HitMineIndex;
-			FieldArray = Other->FieldArray;
-			RevealedArray = Other->RevealedArray;
-			FlagedIndices = Other->FlagedIndices;
-			Visited = Other->Visited;
+			FMemoryWriter Writer(MoveLogBytes);
+			Writer << MoveLog;
 		}
+		Ar << MoveLogBytes;
+		if (Ar.IsLoading())
+		{
+			FMemoryReader Reader(MoveLogBytes);
+			Reader << MoveLog;
+			if (Reader.IsError())
+			{
+				MoveLog.Reset();
+			}
+		}
+	}
+	else if (Ar.IsLoading())
+	{
+		MoveLog.Reset();
+	}
+
+	//Stats and the first click belong to the board that was there before
+	if (Ar.IsLoading())
+	{
+		FirstClickIndex = INDEX_NONE;
+		CachedBoardStats.Reset();
 	}
 }
 
-void AMineSweeperActor::PostInitProperties()
+int32 AMineSweeperActor::CalcPlannedMineCount() const
 {
-	Super::PostInitProperties();
+	return FMineSweeperBoard::CalcMineCount(MineChance, ColumnNum * GetNumRows());
 }
 
-void AMineSweeperActor::Initialize()
+void AMineSweeperActor::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
 {
-	bGameOver = false;
-	bHasWon = false;
-	HitMineIndex = -1;
-	FieldArray.Empty();
-	RevealedArray.Empty();
-	FlagedIndices.Empty();
-	Visited.Empty();
-	bBoardGenerated = false;
-	MineCount = 0;
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	SIZE_T Size = Board.GetAllocatedSize() + MoveLog.Data.GetAllocatedSize() + PendingChangedFields.GetAllocatedSize()
+		+ NetBoardState.Words.GetAllocatedSize() + NetBoardState.WordLookup.GetAllocatedSize()
+		+ NetMineWords.GetAllocatedSize() + ClientFieldNumbers.GetAllocatedSize();
+	if (SnapshotPublisher.IsValid())
+	{
+		Size += SnapshotPublisher->GetAllocatedSize();
+	}
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(Size);
 }
 
-bool AMineSweeperActor::CanClickOnField(int32 ColIndex, int32 RowIndex) const
+bool AMineSweeperActor::ClampToBoardBudget(FName ChangedProperty)
 {
-	if (bGameOver) return false;
+	const int64 MaxFields = GetDefault<UMineSweeperSettings>()->GetMaxBoardFields();
+	FString Reason;
+	if (UMineSweeperSettings::FitsBoardBudget(int64(ColumnNum) * GetNumRows(), &Reason))
+	{
+		return true;
+	}
 
-	const int32 Index = CalcIndex(ColIndex, RowIndex);
+	//The edited size gives way first, then the rows, the columns and the layers
+	TArray<int32*, TInlineAllocator<4>> Sizes;
+	if (ChangedProperty == GET_MEMBER_NAME_CHECKED(AMineSweeperActor, ColumnNum))
+	{
+		Sizes.Add(&ColumnNum);
+	}
+	else if (ChangedProperty == GET_MEMBER_NAME_CHECKED(AMineSweeperActor, LayerNum) && GetTopology() == EMineBoardTopology::Cube26)
+	{
+		Sizes.Add(&LayerNum);
+	}
+	Sizes.AddUnique(&RowNum);
+	Sizes.AddUnique(&ColumnNum);
+	if (GetTopology() == EMineBoardTopology::Cube26)
+	{
+		Sizes.AddUnique(&LayerNum);
+	}
 
-	//Don't handle left click on a flaged tile
-	if (FlagedIndices.Contains(Index))
+	for (int32* Size : Sizes)
 	{
-		return false;
+		const int64 NumFields = int64(ColumnNum) * RowNum * GetNumLayers();
+		if (NumFields <= MaxFields)
+		{
+			break;
+		}
+		const int64 OtherFields = NumFields / FMath::Max(*Size, 1);
+		*Size = int32(FMath::Clamp<int64>(MaxFields / FMath::Max<int64>(OtherFields, 1), 1, *Size));
 	}
 
-	return true;
+	UE_LOG(DetailPanel, Warning, TEXT("%s: a board of %s, shrunk to %d x %d x %d"), *GetName(), *Reason, ColumnNum, RowNum, GetNumLayers());
+	return false;
+}
+
+#if WITH_EDITOR
+void AMineSweeperActor::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	//The board arrays are sized for the old settings, start over. Cheap now that nothing is generated until the first click.
+	static const FName BoardProperties[] =
+	{
+		GET_MEMBER_NAME_CHECKED(AMineSweeperActor, ColumnNum),
+		GET_MEMBER_NAME_CHECKED(AMineSweeperActor, RowNum),
+		GET_MEMBER_NAME_CHECKED(AMineSweeperActor, LayerNum),
+		GET_MEMBER_NAME_CHECKED(AMineSweeperActor, Topology),
+		GET_MEMBER_NAME_CHECKED(AMineSweeperActor, MineChance),
+		GET_MEMBER_NAME_CHECKED(AMineSweeperActor, Seed),
+	};
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+	for (const FName& BoardProperty : BoardProperties)
+	{
+		if (PropertyName == BoardProperty)
+		{
+			ClampToBoardBudget(PropertyName);
+			ResetBoard();
+			break;
+		}
+	}
+}
+#endif
+
+bool AMineSweeperActor::CanClickOnField(int32 ColIndex, int32 RowIndex) const
+{
+	return IsValidIndex(ColIndex, RowIndex) && Board.CanClick(CalcIndex(ColIndex, RowIndex));
 }
 
 void AMineSweeperActor::HandleClickOnField(int32 ColIndex, int32 RowIndex)
@@ -72,23 +280,36 @@ void AMineSweeperActor::HandleClickOnField(int32 ColIndex, int32 RowIndex)
 
 	const int32 Index = CalcIndex(ColIndex, RowIndex);
 
-	if (FieldArray[Index])
+	//The first click places the mines around it, so it never hits one
+	CheckAndGenerateBoard(Index);
+	if (!Board.IsGenerated())
 	{
-		HandleGameOverNative(Index);
+		return;
 	}
-	else
+
+	if (bRecordMoveLog)
 	{
-		Visited.Empty();
-		RevealFieldNative(ColIndex, RowIndex);
+		MoveLog.Append(EMineMoveType::Click, Index);
 	}
+	BeginNetMove();
+
+	ApplyRevealBudget();
+	TArray<int32> ChangedIndices;
+	Board.Click(Index, ChangedIndices);
+	if (Board.HasPendingReveal())
+	{
+		LogCascadeSteps();
+	}
+	MarkFieldsChanged(ChangedIndices);
+	UpdateCascadeTicker();
+
+	CommitChanges();
 }
 
 
 bool AMineSweeperActor::CanRightClickOnField(int32 ColIndex, int32 RowIndex) const
 {
-	if (bGameOver) return false;
-
-	return true;
+	return IsValidIndex(ColIndex, RowIndex) && Board.CanToggleFlag(CalcIndex(ColIndex, RowIndex));
 }
 
 void AMineSweeperActor::HandleRightClickOnField(int32 ColIndex, int32 RowIndex)
@@ -97,65 +318,274 @@ void AMineSweeperActor::HandleRightClickOnField(int32 ColIndex, int32 RowIndex)
 
 	const int32 Index = CalcIndex(ColIndex, RowIndex);
 
-	if (FlagedIndices.Contains(Index))
+	if (bRecordMoveLog)
+	{
+		MoveLog.Append(EMineMoveType::Flag, Index);
+	}
+	BeginNetMove();
+
+	TArray<int32> ChangedIndices;
+	Board.ToggleFlag(Index, ChangedIndices);
+	MarkFieldsChanged(ChangedIndices);
+
+	CommitChanges();
+}
+
+bool AMineSweeperActor::CanChordOnField(int32 ColIndex, int32 RowIndex) const
+{
+	if (!IsValidIndex(ColIndex, RowIndex))
+	{
+		return false;
+	}
+
+	const int32 Index = CalcIndex(ColIndex, RowIndex);
+	if (Board.KnowsMines())
+	{
+		return Board.CanChord(Index);
+	}
+
+	//Clients only have the numbers the server sent
+	const int32 Value = CalculateFieldNumber(ColIndex, RowIndex);
+	return !Board.IsGameOver() && Board.IsRevealed(Index) && Value > 0 && Board.CountNeighbourFlags(Index) == Value;
+}
+
+void AMineSweeperActor::HandleChordOnField(int32 ColIndex, int32 RowIndex)
+{
+	if (!CanChordOnField(ColIndex, RowIndex)) return;
+
+	if (bRecordMoveLog)
+	{
+		MoveLog.Append(EMineMoveType::Chord, CalcIndex(ColIndex, RowIndex));
+	}
+	BeginNetMove();
+
+	ApplyRevealBudget();
+	TArray<int32> ChangedIndices;
+	Board.Chord(CalcIndex(ColIndex, RowIndex), ChangedIndices);
+	if (Board.HasPendingReveal())
+	{
+		LogCascadeSteps();
+	}
+	MarkFieldsChanged(ChangedIndices);
+	UpdateCascadeTicker();
+
+	CommitChanges();
+}
+
+void AMineSweeperActor::RequestClickOnField(APlayerController* PlayerController, int32 ColIndex, int32 RowIndex)
+{
+	if (HasAuthority())
+	{
+		HandleClickOnField(ColIndex, RowIndex);
+	}
+	else if (UMineSweeperNetComponent* NetComponent = PlayerController ? PlayerController->FindComponentByClass<UMineSweeperNetComponent>() : nullptr)
+	{
+		NetComponent->ServerClickOnField(this, ColIndex, RowIndex);
+	}
+	else
+	{
+		UE_LOG(DetailPanel, Warning, TEXT("%s: Can't send click, the player controller has no UMineSweeperNetComponent"), *GetName());
+	}
+}
+
+void AMineSweeperActor::RequestRightClickOnField(APlayerController* PlayerController, int32 ColIndex, int32 RowIndex)
+{
+	if (HasAuthority())
+	{
+		HandleRightClickOnField(ColIndex, RowIndex);
+	}
+	else if (UMineSweeperNetComponent* NetComponent = PlayerController ? PlayerController->FindComponentByClass<UMineSweeperNetComponent>() : nullptr)
+	{
+		NetComponent->ServerRightClickOnField(this, ColIndex, RowIndex);
+	}
+	else
+	{
+		UE_LOG(DetailPanel, Warning, TEXT("%s: Can't send right click, the player controller has no UMineSweeperNetComponent"), *GetName());
+	}
+}
+
+void AMineSweeperActor::RequestResetBoard(APlayerController* PlayerController)
+{
+	if (HasAuthority())
 	{
-		FlagedIndices.Remove(Index);
+		ResetBoard();
 	}
-	else if (FlagedIndices.Num() < MineCount)
+	else if (UMineSweeperNetComponent* NetComponent = PlayerController ? PlayerController->FindComponentByClass<UMineSweeperNetComponent>() : nullptr)
 	{
-		FlagedIndices.Add(Index);
+		NetComponent->ServerResetBoard(this);
+	}
+	else
+	{
+		UE_LOG(DetailPanel, Warning, TEXT("%s: Can't send reset, the player controller has no UMineSweeperNetComponent"), *GetName());
 	}
 }
 
 int32 AMineSweeperActor::CalculateFieldNumber(int32 ColIndex, int32 RowIndex) const
 {
 	const int32 Index = CalcIndex(ColIndex, RowIndex);
-	if (FieldArray[Index])
+
+	//Clients don't know the mines until the game is over, they only have the numbers the server sent
+	if (!Board.KnowsMines())
 	{
-		return -1;
+		return ClientFieldNumbers.IsValidIndex(Index) ? ClientFieldNumbers[Index] : 0;
 	}
 
-	return GetValue(ColIndex - 1, RowIndex - 1) +
-		GetValue(ColIndex - 1, RowIndex) +
-		GetValue(ColIndex - 1, RowIndex + 1) +
-		GetValue(ColIndex, RowIndex - 1) +
-		GetValue(ColIndex, RowIndex + 1) +
-		GetValue(ColIndex + 1, RowIndex - 1) +
-		GetValue(ColIndex + 1, RowIndex) +
-		GetValue(ColIndex + 1, RowIndex + 1);
+	return Board.CalculateFieldNumber(Index);
+}
+
+FMineBoardDims AMineSweeperActor::GetBoardDims() const
+{
+	FMineBoardDims Dims;
+	Dims.Columns = ColumnNum;
+	Dims.Rows = GetNumRows();
+	Dims.RowsPerLayer = RowNum;
+	return Dims;
 }
 
 bool AMineSweeperActor::IsRevealed(int32 ColIndex, int32 RowIndex) const
 {
-	const int32 Index = CalcIndex(ColIndex, RowIndex);
-	return RevealedArray[Index];
+	return Board.IsRevealed(CalcIndex(ColIndex, RowIndex));
 }
 
 bool AMineSweeperActor::IsFlagged(int32 ColIndex, int32 RowIndex) const
 {
-	const int32 Index = CalcIndex(ColIndex, RowIndex);
-	return FlagedIndices.Contains(Index);
+	return Board.IsFlagged(CalcIndex(ColIndex, RowIndex));
 }
 
 bool AMineSweeperActor::IsCrossed(int32 ColIndex, int32 RowIndex) const
 {
-	const int32 Index = CalcIndex(ColIndex, RowIndex);
-	return FlagedIndices.Contains(Index)
-			&& !FieldArray[Index]
-			|| Index == HitMineIndex;
+	return Board.IsCrossed(CalcIndex(ColIndex, RowIndex));
 }
 
 bool AMineSweeperActor::IsMine(int32 ColIndex, int32 RowIndex) const
 {
-	const int32 Index = CalcIndex(ColIndex, RowIndex);
-	return FieldArray[Index];
+	return Board.IsMine(CalcIndex(ColIndex, RowIndex));
+}
+
+TArray<uint8> AMineSweeperActor::GetBoardSnapshot(bool bIncludeMines) const
+{
+	TArray<uint8> States;
+	FillBoardSnapshot(FIntRect(0, 0, ColumnNum, GetNumRows()), bIncludeMines, States);
+	return States;
 }
 
-bool AMineSweeperActor::CheckAndGenerateBoard()
+TArray<uint8> AMineSweeperActor::GetBoardSnapshotRect(int32 ColIndex, int32 RowIndex, int32 Width, int32 Height, bool bIncludeMines) const
 {
-	if (!bBoardGenerated)
+	TArray<uint8> States;
+	FillBoardSnapshot(FIntRect(ColIndex, RowIndex, ColIndex + Width, RowIndex + Height), bIncludeMines, States);
+	return States;
+}
+
+FIntRect AMineSweeperActor::FillBoardSnapshot(const FIntRect& Rect, bool bIncludeMines, TArray<uint8>& OutStates) const
+{
+	FIntRect Clipped = Rect;
+	Clipped.Clip(FIntRect(0, 0, ColumnNum, GetNumRows()));
+	const int32 Width = FMath::Max(Clipped.Width(), 0);
+	const int32 Height = FMath::Max(Clipped.Height(), 0);
+
+	OutStates.SetNumUninitialized(Width * Height);
+	if (OutStates.Num() == 0)
+	{
+		return Clipped;
+	}
+
+	const TArray<bool>& FieldArray = Board.GetMines();
+	const TArray<bool>& RevealedArray = Board.GetRevealed();
+	if (!Board.IsGenerated() || (!Board.IsMapped() && RevealedArray.Num() != ColumnNum * GetNumRows()))
+	{
+		FMemory::Memset(OutStates.GetData(), uint8(EMineCellState::Hidden), OutStates.Num());
+		return Clipped;
+	}
+
+	const bool bGameOver = Board.IsGameOver();
+	const bool bKnowsMines = Board.KnowsMines();
+	const bool bShowMines = bKnowsMines && (bGameOver || bIncludeMines);
+	const int32 HitMineIndex = Board.GetHitMineIndex();
+	uint8* Out = OutStates.GetData();
+
+	//A mapped board has no arrays to walk, it is read field by field with the flags first
+	if (Board.IsMapped())
+	{
+		DispatchMineTopology(GetTopology(), [&](auto Policy)
+		{
+			for (int32 RowIndex = Clipped.Min.Y; RowIndex < Clipped.Max.Y; RowIndex++)
+			{
+				for (int32 ColIndex = Clipped.Min.X; ColIndex < Clipped.Max.X; ColIndex++)
+				{
+					const int32 Index = RowIndex * ColumnNum + ColIndex;
+					uint8 State = uint8(EMineCellState::Hidden);
+
+					if (Board.IsFlagged(Index))
+					{
+						State = uint8(bGameOver && !Board.IsMine(Index) ? EMineCellState::WrongFlag : EMineCellState::Flagged);
+					}
+					else if (bShowMines && Board.IsMine(Index))
+					{
+						State = uint8(Index == HitMineIndex ? EMineCellState::HitMine : EMineCellState::Mine);
+					}
+					else if (Board.IsRevealed(Index) && !Board.IsMine(Index))
+					{
+						State = uint8(Board.CountNeighbourMines<decltype(Policy)>(ColIndex, RowIndex));
+					}
+
+					*Out++ = State;
+				}
+			}
+		});
+		return Clipped;
+	}
+
+	//Straight array walks instead of the per field functions, flags are laid over afterwards
+	DispatchMineTopology(GetTopology(), [&](auto Policy)
+	{
+		for (int32 RowIndex = Clipped.Min.Y; RowIndex < Clipped.Max.Y; RowIndex++)
+		{
+			const int32 RowStart = RowIndex * ColumnNum;
+			for (int32 ColIndex = Clipped.Min.X; ColIndex < Clipped.Max.X; ColIndex++)
+			{
+				const int32 Index = RowStart + ColIndex;
+				uint8 State = uint8(EMineCellState::Hidden);
+
+				if (bShowMines && FieldArray[Index])
+				{
+					State = uint8(Index == HitMineIndex ? EMineCellState::HitMine : EMineCellState::Mine);
+				}
+				else if (RevealedArray[Index])
+				{
+					if (!bKnowsMines)
+					{
+						State = uint8(FMath::Clamp<int32>(ClientFieldNumbers[Index], 0, 26));
+					}
+					else if (!FieldArray[Index])
+					{
+						State = uint8(Board.CountNeighbourMines<decltype(Policy)>(ColIndex, RowIndex));
+					}
+				}
+
+				*Out++ = State;
+			}
+		}
+	});
+
+	for (const int32 Index : Board.GetFlags())
+	{
+		const int32 ColIndex = Index % ColumnNum;
+		const int32 RowIndex = Index / ColumnNum;
+		if (Clipped.Contains(FIntPoint(ColIndex, RowIndex)))
+		{
+			const bool bWrongFlag = bGameOver && bKnowsMines && !FieldArray[Index];
+			OutStates[(RowIndex - Clipped.Min.Y) * Width + ColIndex - Clipped.Min.X] = uint8(bWrongFlag ? EMineCellState::WrongFlag : EMineCellState::Flagged);
+		}
+	}
+
+	return Clipped;
+}
+
+bool AMineSweeperActor::CheckAndGenerateBoard(int32 SafeIndex)
+{
+	if (!Board.IsGenerated())
 	{
-		GenerateBoard();
+		GenerateBoard(SafeIndex);
 		return true;
 	}
 	return false;
@@ -163,96 +593,216 @@ bool AMineSweeperActor::CheckAndGenerateBoard()
 
 void AMineSweeperActor::ResetBoard()
 {
+	//Drops a pending cascade along with the old board
 	Initialize();
-	CheckAndGenerateBoard();
+	UpdateCascadeTicker();
+
+	//Clients drop whatever they had for the previous board
+	BoardEpoch++;
+	NetBoardState.Reset();
+	NetMineWords.Empty();
+	PendingMineWordBytes = 0;
+	PendingChangedFields.Empty();
+	bPendingFullBoardChange = true;
+	MoveLog.Reset();
+
+	CommitChanges();
 }
 
-void AMineSweeperActor::HandleGameOverNative(int32 ClickedIndex)
+void AMineSweeperActor::ConfigureBoard(int32 InColumnNum, int32 InRowNum, float InMineChance, int32 InSeed)
 {
-	bGameOver = true;
-	HitMineIndex = ClickedIndex;
-	
-	for (int32 i = 0; i < RevealedArray.Num(); i++)
+	ColumnNum = FMath::Max(InColumnNum, 1);
+	RowNum = FMath::Max(InRowNum, 1);
+	MineChance = FMath::Clamp(InMineChance, 0.0f, 1.0f);
+	Seed = InSeed;
+	ClampToBoardBudget();
+	ResetBoard();
+}
+
+bool AMineSweeperActor::ExportBoard(const FString& Filename, bool bCompress) const
+{
+	//A mapped board reads its fields from the file that would be written
+	if (Board.IsMapped() && FPaths::IsSamePath(Filename, Board.GetMappedFilename()))
+	{
+		UE_LOG(DetailPanel, Warning, TEXT("%s: not exporting to %s, the board is played from that file"), *GetName(), *Filename);
+		return false;
+	}
+
+	if (FMineBoardFile::IsTextFilename(Filename))
 	{
-		RevealedArray[i] = true;
+		return FMineBoardFile::SaveText(Filename, Board, BoardSeed);
 	}
+	return FMineBoardFile::Save(Filename, Board, BoardSeed, bCompress);
 }
 
-void AMineSweeperActor::RevealFieldNative(int32 ColIndex, int32 RowIndex)
+bool AMineSweeperActor::ImportBoard(const FString& Filename)
 {
-	if (!IsValidIndex(ColIndex, RowIndex))
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	//Both formats tell the size up front, so boards over the budget are turned down before any field is read
+	FString Reason;
+	FMineBoardFile::FHeader FileHeader;
+	bool bHasHeader = false;
+	if (FMineBoardFile::IsTextFilename(Filename))
 	{
-		return;
+		bHasHeader = FMineBoardFile::ReadTextHeader(Filename, FileHeader);
+	}
+	else
+	{
+		FMineBoardFileReader Reader;
+		bHasHeader = Reader.Open(Filename);
+		FileHeader = Reader.GetHeader();
 	}
 
-	const int32 Index = CalcIndex(ColIndex, RowIndex);
+	//Big binary boards are played from their mapping. Only in standalone games, a networked game sends all the mines once
+	//a mine is hit, and an editor world would save the board into the level.
+	const int64 NumFields = int64(FileHeader.Dims.Columns) * FileHeader.Dims.Rows;
+	const int64 MappedImportFields = GetDefault<UMineSweeperSettings>()->MappedImportFields;
+	const UWorld* World = GetWorld();
+	const bool bMapped = bHasHeader && FileHeader.bGenerated && !FMineBoardFile::IsTextFilename(Filename) && MappedImportFields > 0 && NumFields >= MappedImportFields
+		&& World && World->IsGameWorld() && GetNetMode() == NM_Standalone;
 
-	//Don't revisit already visited fields
-	if (Visited.Contains(Index))
+	if (bHasHeader && !(bMapped ? UMineSweeperSettings::FitsMappedBoardBudget(NumFields, &Reason) : UMineSweeperSettings::FitsBoardBudget(NumFields, &Reason)))
 	{
-		return;
+		UE_LOG(DetailPanel, Warning, TEXT("Not importing %s: a board of %s"), *Filename, *Reason);
+		return false;
 	}
 
-	Visited.Add(Index);
-
-	if (FlagedIndices.Contains(Index))
+	FMineSweeperBoard LoadedBoard;
+	int32 LoadedSeed = 0;
+	if (bMapped)
 	{
-		return;
+		if (!LoadedBoard.OpenMapped(Filename))
+		{
+			return false;
+		}
+		LoadedSeed = FileHeader.Seed;
+	}
+	else
+	{
+		if (!FMineBoardFile::Load(Filename, LoadedBoard, LoadedSeed))
+		{
+			return false;
+		}
+		if (!UMineSweeperSettings::FitsBoardBudget(LoadedBoard.GetDims().Num(), &Reason))
+		{
+			UE_LOG(DetailPanel, Warning, TEXT("Not importing %s: a board of %s"), *Filename, *Reason);
+			return false;
+		}
 	}
 
-	RevealedArray[Index] = true;
+	const FMineBoardDims& Dims = LoadedBoard.GetDims();
+	ColumnNum = Dims.Columns;
+	RowNum = Dims.RowsPerLayer;
+	LayerNum = FMath::Max(Dims.Rows / FMath::Max(Dims.RowsPerLayer, 1), 1);
+	Topology = ToMineSweeperTopology(LoadedBoard.GetTopology());
+	MineChance = float(LoadedBoard.GetMineCount()) / Dims.Num();
+	Seed = 0;
 
-	const int32 Value = CalculateFieldNumber(ColIndex, RowIndex);
+	//Starts a new board for the clients and the move log, then puts the loaded one in its place
+	ResetBoard();
+	Board = MoveTemp(LoadedBoard);
+	BoardSeed = LoadedSeed;
+	FirstClickIndex = INDEX_NONE;
+	CachedBoardStats.Reset();
 
-	//Reveal adjacent fields 
-	if (Value == 0)
+	//Clients only get the fields that differ from a hidden board. Mapped boards have no clients and their arrays are empty.
+	const TArray<bool>& Revealed = Board.GetRevealed();
+	for (int32 Index = 0; Index < Revealed.Num(); Index++)
 	{
-		RevealFieldNative(ColIndex - 1, RowIndex - 1);
-		RevealFieldNative(ColIndex - 1, RowIndex);
-		RevealFieldNative(ColIndex - 1, RowIndex + 1);
-		RevealFieldNative(ColIndex, RowIndex - 1);
-		RevealFieldNative(ColIndex, RowIndex + 1);
-		RevealFieldNative(ColIndex + 1, RowIndex - 1);
-		RevealFieldNative(ColIndex + 1, RowIndex);
-		RevealFieldNative(ColIndex + 1, RowIndex + 1);
+		if (Revealed[Index])
+		{
+			PendingChangedFields.Add(Index);
+		}
 	}
+	PendingChangedFields.Append(Board.GetFlags());
+	bPendingFullBoardChange = true;
+	CommitChanges();
+	return true;
 }
 
 bool AMineSweeperActor::IsValidIndex(int32 ColIndex, int32 RowIndex) const
 {
-	if (ColIndex < 0 || ColIndex >= ColumnNum || RowIndex < 0 || RowIndex >= RowNum)
+	if (ColIndex < 0 || ColIndex >= ColumnNum || RowIndex < 0 || RowIndex >= GetNumRows())
 	{
 		return false;
 	}
 	return true;
 }
 
-void AMineSweeperActor::GenerateBoard()
+void AMineSweeperActor::GenerateBoard(int32 SafeIndex)
 {
-	MineCount = 0;
+	LLM_SCOPE_BYTAG(MineSweeper);
 
-	FieldArray.Empty();
-	Visited.Empty();
-	FlagedIndices.Empty();
-	RevealedArray.Empty();
+	//Sizes can also come from saved levels or replication, nothing is allocated for a board over the budget
+	FString Reason;
+	if (!UMineSweeperSettings::FitsBoardBudget(int64(ColumnNum) * GetNumRows(), &Reason))
+	{
+		UE_LOG(DetailPanel, Error, TEXT("%s: not generating a board of %s"), *GetName(), *Reason);
+		return;
+	}
 
-	const int32 TotalFields = ColumnNum * RowNum;
-	FieldArray.SetNum(TotalFields);
-	RevealedArray.SetNum(TotalFields);
-	Visited.Reserve(TotalFields / 2);
+	//The whole layout comes from the seed and the first click so that a move log can generate the same board again
+	BoardSeed = Seed != 0 ? Seed : FMath::RandRange(1, MAX_int32);
+	FirstClickIndex = SafeIndex;
+	CachedBoardStats.Reset();
+	Board.Generate(SafeIndex, BoardSeed);
 
-	for (int32 i = 0; i < FieldArray.Num(); ++i)
+	//Further candidates draw their seeds from the first one, so a fixed Seed still always ends with the same board.
+	//The move log only keeps the accepted seed and replays don't filter.
+	const FMineDifficultyFilter Filter = DifficultyFilter.ToCore();
+	if (Filter.bEnabled)
 	{
-		const float RandomValue = UKismetMathLibrary::RandomFloat();
-		FieldArray[i] = RandomValue < MineChance;
-		if (FieldArray[i])
+		const int32 GuessFreeIndex = Filter.bRequireGuessFree ? SafeIndex : INDEX_NONE;
+		FRandomStream SeedStream(BoardSeed);
+		const double StartTime = FPlatformTime::Seconds();
+		CachedBoardStats = Board.ComputeStats(GuessFreeIndex);
+		int32 NumCandidates = 1;
+		for (; NumCandidates < Filter.MaxAttempts && !Filter.Matches(CachedBoardStats.GetValue()); NumCandidates++)
+		{
+			BoardSeed = SeedStream.RandRange(1, MAX_int32);
+			Board.Generate(SafeIndex, BoardSeed);
+			CachedBoardStats = Board.ComputeStats(GuessFreeIndex);
+		}
+
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		UE_LOG(DetailPanel, Log, TEXT("%s: difficulty filter scored %d boards in %.2f ms, %.0f boards per second"),
+			*GetName(), NumCandidates, Seconds * 1000.0, Seconds > 0.0 ? NumCandidates / Seconds : 0.0);
+
+		if (!Filter.Matches(CachedBoardStats.GetValue()))
+		{
+			UE_LOG(DetailPanel, Warning, TEXT("%s: no board in the difficulty range after %d attempts, keeping one with 3BV %d"),
+				*GetName(), Filter.MaxAttempts, CachedBoardStats->ThreeBV);
+		}
+
+		//Without bRequireGuessFree the guess free check was skipped, GetBoardStats does it when asked
+		if (!CachedBoardStats->bGuessFreeChecked)
 		{
-			MineCount++;
+			CachedBoardStats.Reset();
 		}
-		RevealedArray[i] = false;
 	}
 
-	bBoardGenerated = true;
+	if (bRecordMoveLog)
+	{
+		MoveLog.Begin(ColumnNum, RowNum, GetNumLayers(), GetTopology(), MineChance, BoardSeed);
+	}
+	else
+	{
+		MoveLog.Reset();
+	}
+}
+
+FMineSweeperBoardStats AMineSweeperActor::GetBoardStats()
+{
+	if (!CachedBoardStats.IsSet())
+	{
+		if (!Board.KnowsMines())
+		{
+			return FMineSweeperBoardStats();
+		}
+		CachedBoardStats = Board.ComputeStats(FirstClickIndex);
+	}
+	return CachedBoardStats.GetValue();
 }
 
 int32 AMineSweeperActor::CalcIndex(int32 ColIndex, int32 RowIndex) const
@@ -260,48 +810,430 @@ int32 AMineSweeperActor::CalcIndex(int32 ColIndex, int32 RowIndex) const
 	return RowIndex * ColumnNum + ColIndex;
 }
 
-int32 AMineSweeperActor::GetValue(int32 ColIndex, int32 RowIndex) const
+int32 AMineSweeperActor::GetMineCountForVisual() const
+{
+	return Board.GetMineCount() - Board.GetNumFlags();
+}
+
+bool AMineSweeperActor::CheckAndUpdateHasWon()
 {
-	if (!IsValidIndex(ColIndex, RowIndex))
+	return Board.CheckAndUpdateHasWon();
+}
+
+void AMineSweeperActor::MarkFieldChanged(int32 Index)
+{
+	PendingChangedFields.Add(Index);
+}
+
+void AMineSweeperActor::MarkFieldsChanged(const TArray<int32>& Indices)
+{
+	PendingChangedFields.Append(Indices);
+
+	//A lost mapped board lists no fields, all of them show as revealed now
+	if (Board.IsMapped() && Board.IsGameOver() && !Board.HasWon())
 	{
-		return 0;
+		bPendingFullBoardChange = true;
 	}
+}
 
-	return FieldArray[CalcIndex(ColIndex, RowIndex)];
+void AMineSweeperActor::ApplyRevealBudget()
+{
+	Board.SetRevealBudget(CascadeFieldsPerFrame, CascadeMillisecondsPerFrame / 1000.0);
 }
 
-int32 AMineSweeperActor::GetMineCountForVisual() const
+void AMineSweeperActor::UpdateCascadeTicker()
 {
-	return MineCount - FlagedIndices.Num();
+	if (Board.HasPendingReveal() && !CascadeTickerHandle.IsValid())
+	{
+		CascadeTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &AMineSweeperActor::TickCascade));
+	}
+	else if (!Board.HasPendingReveal() && CascadeTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(CascadeTickerHandle);
+		CascadeTickerHandle.Reset();
+	}
 }
 
-bool AMineSweeperActor::CheckAndUpdateHasWon()
+bool AMineSweeperActor::TickCascade(float DeltaTime)
+{
+	//Moves in between see the pending fields as hidden, a flag stops the cascade there and a lost game drops it
+	ApplyRevealBudget();
+	TArray<int32> ChangedIndices;
+	Board.ContinueReveal(ChangedIndices);
+	LogCascadeSteps();
+	MarkFieldsChanged(ChangedIndices);
+	CommitChanges();
+
+	if (!Board.HasPendingReveal())
+	{
+		CascadeTickerHandle.Reset();
+		return false;
+	}
+	return true;
+}
+
+void AMineSweeperActor::LogCascadeSteps()
+{
+	if (bRecordMoveLog && !MoveLog.IsEmpty() && Board.GetLastRevealSteps() > 0)
+	{
+		MoveLog.AppendCascade(Board.GetLastRevealSteps());
+	}
+}
+
+void AMineSweeperActor::CommitChanges()
+{
+	if (!bPendingFullBoardChange && PendingChangedFields.Num() == 0)
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	UpdateNetGameState();
+	FlushNetChanges();
+
+	//An empty list tells the listeners to refresh everything
+	TArray<int32> ChangedFields;
+	if (!bPendingFullBoardChange)
+	{
+		ChangedFields = PendingChangedFields.Array();
+	}
+	PendingChangedFields.Empty();
+	bPendingFullBoardChange = false;
+
+	UpdateWorldBoard(ChangedFields);
+	if (SnapshotPublisher.IsValid())
+	{
+		SnapshotPublisher->Publish(*this, ChangedFields);
+	}
+	BoardChangedEvent.Broadcast(ChangedFields);
+}
+
+TSharedRef<FMineBoardSnapshotPublisher, ESPMode::ThreadSafe> AMineSweeperActor::GetSnapshotPublisher()
+{
+	if (!SnapshotPublisher.IsValid())
+	{
+		SnapshotPublisher = MakeShared<FMineBoardSnapshotPublisher, ESPMode::ThreadSafe>();
+		SnapshotPublisher->Publish(*this, TArray<int32>());
+	}
+	return SnapshotPublisher.ToSharedRef();
+}
+
+void AMineSweeperActor::PostRepNotifies()
+{
+	Super::PostRepNotifies();
+
+	ApplyNetGameState();
+	CommitChanges();
+}
+
+#if WITH_EDITOR
+void AMineSweeperActor::PostEditUndo()
 {
-	if (!bGameOver && FlagedIndices.Num() == MineCount)
+	Super::PostEditUndo();
+
+	//Undo restores the board without its cascade, and maybe a board from before the last generate
+	UpdateCascadeTicker();
+	FirstClickIndex = INDEX_NONE;
+	CachedBoardStats.Reset();
+	bPendingFullBoardChange = true;
+	CommitChanges();
+}
+#endif
+
+void AMineSweeperActor::UpdateNetGameState()
+{
+	if (!HasAuthority())
 	{
-		int count = 0;
+		return;
+	}
+
+	NetMineCount = Board.GetMineCount();
+	bNetBoardGenerated = Board.IsGenerated();
+	bNetGameOver = Board.IsGameOver();
+	bNetHasWon = Board.HasWon();
+	NetHitMineIndex = Board.GetHitMineIndex();
 
-		for (auto& r : RevealedArray)
+	//Once a mine was hit the clients may see the mines
+	const TArray<bool>& Mines = Board.GetMines();
+	if (bNetGameOver && !bNetHasWon && NetMineWords.Num() == 0 && Mines.Num() > 0)
+	{
+		NetMineWords.SetNumZeroed(FMath::DivideAndRoundUp(Mines.Num(), FMineBoardNetWord::FieldsPerWord));
+		for (int32 i = 0; i < Mines.Num(); i++)
 		{
-			if (!r)
-				count++;
+			if (Mines[i])
+			{
+				NetMineWords[i / FMineBoardNetWord::FieldsPerWord] |= 1u << (i % FMineBoardNetWord::FieldsPerWord);
+			}
 		}
+		PendingMineWordBytes = NetMineWords.Num() * sizeof(uint32);
+	}
+}
+
+void AMineSweeperActor::ApplyNetGameState()
+{
+	if (HasAuthority())
+	{
+		return;
+	}
 
-		if (count == MineCount)
+	Board.SetGameState(NetMineCount, bNetBoardGenerated, bNetGameOver, bNetHasWon, NetHitMineIndex);
+}
+
+void AMineSweeperActor::FlushNetChanges()
+{
+	//Nobody to send to
+	if (!HasAuthority() || GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	TSet<int32> DirtyWords;
+	for (const int32 Index : PendingChangedFields)
+	{
+		DirtyWords.Add(Index / FMineBoardNetWord::FieldsPerWord);
+	}
+
+	for (const int32 WordIndex : DirtyWords)
+	{
+		FMineBoardNetWord& Word = NetBoardState.FindOrAddWord(WordIndex);
+		Word.Epoch = BoardEpoch;
+		Word.RevealedBits = 0;
+		Word.FlagBits = 0;
+		Word.NumbersLo = 0;
+		Word.NumbersHi = 0;
+		Word.NumberHighBits = 0;
+
+		const int32 FirstIndex = WordIndex * FMineBoardNetWord::FieldsPerWord;
+		const int32 LastIndex = FMath::Min(FirstIndex + FMineBoardNetWord::FieldsPerWord, Board.GetRevealed().Num());
+		for (int32 Index = FirstIndex; Index < LastIndex; Index++)
 		{
-			bool flag = true;
+			const int32 Bit = Index - FirstIndex;
+			if (Board.IsRevealed(Index))
+			{
+				Word.RevealedBits |= 1u << Bit;
+				const int32 Number = CalculateFieldNumber(Index % ColumnNum, Index / ColumnNum);
+				Word.SetNumber(Bit, Number < 0 ? FMineBoardNetWord::MineNumber : Number);
+			}
+			if (Board.IsFlagged(Index))
+			{
+				Word.FlagBits |= 1u << Bit;
+			}
+		}
+
+		NetBoardState.MarkItemDirty(Word);
+	}
+
+	//Cascade steps of later frames add to the move that started them, the mine words only go out once
+	const int32 NetBytes = DirtyWords.Num() * FMineBoardNetWord::PayloadBytes + PendingMineWordBytes;
+	PendingMineWordBytes = 0;
+	LastMoveNetBytes += NetBytes;
+	TotalMoveNetBytes += NetBytes;
+	UE_LOG(DetailPanel, Verbose, TEXT("%s: Move replicates %d words, ~%d bytes"), *GetName(), DirtyWords.Num(), NetBytes);
+}
+
+void AMineSweeperActor::BeginNetMove()
+{
+	if (HasAuthority() && GetNetMode() != NM_Standalone)
+	{
+		LastMoveNetBytes = 0;
+		NumNetMoves++;
+	}
+}
+
+void AMineSweeperActor::EnsureClientArrays()
+{
+	const int32 TotalFields = ColumnNum * GetNumRows();
+	if (Board.GetRevealed().Num() != TotalFields)
+	{
+		Board.ResetMirror(GetBoardDims(), GetTopology());
+		ClientFieldNumbers.Init(0, TotalFields);
+	}
+}
+
+void AMineSweeperActor::ApplyNetWord(const FMineBoardNetWord& Word)
+{
+	//A word of a new board can arrive before the epoch itself
+	if (Word.Epoch != AppliedBoardEpoch)
+	{
+		ResetClientBoard(Word.Epoch);
+	}
+
+	EnsureClientArrays();
+
+	const int32 FirstIndex = Word.WordIndex * FMineBoardNetWord::FieldsPerWord;
+	const int32 LastIndex = FMath::Min(FirstIndex + FMineBoardNetWord::FieldsPerWord, Board.GetRevealed().Num());
+	for (int32 Index = FirstIndex; Index < LastIndex; Index++)
+	{
+		const int32 Bit = Index - FirstIndex;
+		Board.SetFieldState(Index, (Word.RevealedBits & (1u << Bit)) != 0, (Word.FlagBits & (1u << Bit)) != 0);
+
+		const int32 Number = Word.GetNumber(Bit);
+		ClientFieldNumbers[Index] = Number == FMineBoardNetWord::MineNumber ? -1 : Number;
+		MarkFieldChanged(Index);
+	}
+}
+
+void AMineSweeperActor::OnRep_BoardEpoch()
+{
+	if (BoardEpoch != AppliedBoardEpoch)
+	{
+		ResetClientBoard(BoardEpoch);
+	}
+}
 
-			for (auto& index : FlagedIndices)
+void AMineSweeperActor::ResetClientBoard(uint8 Epoch)
+{
+	AppliedBoardEpoch = Epoch;
+	Board.ResetMirror(GetBoardDims(), GetTopology());
+	ClientFieldNumbers.Init(0, Board.GetRevealed().Num());
+	bPendingFullBoardChange = true;
+}
+
+void AMineSweeperActor::OnRep_NetMineWords()
+{
+	if (NetMineWords.Num() == 0)
+	{
+		Board.SetMines(TArray<bool>());
+		return;
+	}
+
+	const int32 TotalFields = ColumnNum * GetNumRows();
+	TArray<bool> Mines;
+	Mines.SetNum(TotalFields);
+	for (int32 i = 0; i < TotalFields; i++)
+	{
+		const int32 WordIndex = i / FMineBoardNetWord::FieldsPerWord;
+		Mines[i] = NetMineWords.IsValidIndex(WordIndex) && (NetMineWords[WordIndex] & (1u << (i % FMineBoardNetWord::FieldsPerWord))) != 0;
+	}
+	Board.SetMines(MoveTemp(Mines));
+	bPendingFullBoardChange = true;
+}
+
+void AMineSweeperActor::RebuildWorldBoard()
+{
+	if (!BoardInstances)
+	{
+		return;
+	}
+
+	BoardInstances->ClearInstances();
+
+	if (!bShowWorldBoard)
+	{
+		return;
+	}
+
+	//Instance index is the field index, so a field never has to be looked up.
+	//Hex boards shift the odd rows by half a field, layers of a cube board are stacked upwards.
+	const int32 TotalRows = GetNumRows();
+	TArray<FTransform> Transforms;
+	Transforms.Reserve(ColumnNum * TotalRows);
+	for (int32 RowIndex = 0; RowIndex < TotalRows; RowIndex++)
+	{
+		const int32 Layer = RowIndex / RowNum;
+		const int32 LayerRow = RowIndex % RowNum;
+		const float RowShift = GetTopology() == EMineBoardTopology::Hex6 && (RowIndex & 1) ? 0.5f : 0.0f;
+		for (int32 ColIndex = 0; ColIndex < ColumnNum; ColIndex++)
+		{
+			Transforms.Add(FTransform(FVector((ColIndex + RowShift) * WorldFieldSize, LayerRow * WorldFieldSize, Layer * WorldFieldSize)));
+		}
+	}
+	BoardInstances->AddInstances(Transforms, false);
+
+	UpdateWorldBoard(TArray<int32>());
+}
+
+void AMineSweeperActor::UpdateWorldBoard(const TArray<int32>& ChangedIndices)
+{
+	if (!BoardInstances || !bShowWorldBoard)
+	{
+		return;
+	}
+
+	const int32 TotalFields = ColumnNum * GetNumRows();
+	if (BoardInstances->GetInstanceCount() != TotalFields)
+	{
+		//The board was resized, RebuildWorldBoard comes back here with an empty list
+		RebuildWorldBoard();
+		return;
+	}
+
+	if (ChangedIndices.Num() == 0)
+	{
+		for (int32 Index = 0; Index < TotalFields; Index++)
+		{
+			UpdateWorldBoardInstance(Index);
+		}
+	}
+	else
+	{
+		for (const int32 Index : ChangedIndices)
+		{
+			UpdateWorldBoardInstance(Index);
+		}
+	}
+
+	//One render state update for the whole move instead of one per field
+	BoardInstances->MarkRenderStateDirty();
+}
+
+void AMineSweeperActor::UpdateWorldBoardInstance(int32 Index)
+{
+	const int32 ColIndex = Index % ColumnNum;
+	const int32 RowIndex = Index / ColumnNum;
+
+	float State = 0.0f;
+	float Number = 0.0f;
+	const bool bGameOver = Board.IsGameOver();
+	if (bGameOver && Board.IsCrossed(Index))
+	{
+		State = 4.0f;
+	}
+	else if (Board.IsFlagged(Index))
+	{
+		State = 2.0f;
+	}
+	else if (bGameOver && Board.IsMine(Index))
+	{
+		State = 3.0f;
+	}
+	else if (Board.IsRevealed(Index))
+	{
+		State = 1.0f;
+		Number = CalculateFieldNumber(ColIndex, RowIndex);
+	}
+
+	const float CustomData[] = { State, Number };
+	BoardInstances->SetCustomData(Index, MakeArrayView(CustomData), false);
+}
+
+namespace MineSweeperNetStats
+{
+	//Prints the replication cost of the moves on every board a server or listen server runs, see the Readme for a PIE setup
+	static void Report(const TArray<FString>& Args)
+	{
+		const bool bReset = Args.Contains(TEXT("reset"));
+		for (TObjectIterator<AMineSweeperActor> It; It; ++It)
+		{
+			AMineSweeperActor* Actor = *It;
+			if (!IsValid(Actor) || Actor->IsTemplate() || !Actor->GetWorld() || !Actor->HasAuthority() || Actor->GetNetMode() == NM_Standalone)
 			{
-				flag &= FieldArray[index];
+				continue;
 			}
-			if (flag)
+
+			UE_LOG(DetailPanel, Display, TEXT("%s (%s): %d moves, %lld bytes, %.1f bytes per move, %d in the last move"),
+				*Actor->GetName(), *Actor->GetWorld()->GetName(), Actor->GetNumNetMoves(), Actor->GetTotalMoveNetBytes(),
+				Actor->GetAverageMoveNetBytes(), Actor->GetLastMoveNetBytes());
+			if (bReset)
 			{
-				bGameOver = true;
-				bHasWon = true;
+				Actor->ResetNetStats();
 			}
-			return flag;
 		}
 	}
-	return bHasWon;
-}
\ No newline at end of file
+
+	static FAutoConsoleCommand ReportCommand(
+		TEXT("MineSweeper.Net.Report"),
+		TEXT("Logs the replicated bytes per move of every networked minesweeper board with authority. Add reset to start counting again."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&Report));
+}
@@ -0,0 +1,50 @@
+#include "MineSweeperNetComponent.h"
+#include "MineSweeperActor.h"
+
+UMineSweeperNetComponent::UMineSweeperNetComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+//Validation only rejects moves no honest client can send. Moves that are just not allowed
+//right now (game over, flagged field) are silently ignored by the board itself.
+bool UMineSweeperNetComponent::ServerClickOnField_Validate(AMineSweeperActor* Board, int32 ColIndex, int32 RowIndex)
+{
+	return Board == nullptr || Board->IsValidIndex(ColIndex, RowIndex);
+}
+
+void UMineSweeperNetComponent::ServerClickOnField_Implementation(AMineSweeperActor* Board, int32 ColIndex, int32 RowIndex)
+{
+	if (Board)
+	{
+		Board->HandleClickOnField(ColIndex, RowIndex);
+	}
+}
+
+bool UMineSweeperNetComponent::ServerRightClickOnField_Validate(AMineSweeperActor* Board, int32 ColIndex, int32 RowIndex)
+{
+	return Board == nullptr || Board->IsValidIndex(ColIndex, RowIndex);
+}
+
+void UMineSweeperNetComponent::ServerRightClickOnField_Implementation(AMineSweeperActor* Board, int32 ColIndex, int32 RowIndex)
+{
+	if (Board)
+	{
+		Board->HandleRightClickOnField(ColIndex, RowIndex);
+	}
+}
+
+bool UMineSweeperNetComponent::ServerResetBoard_Validate(AMineSweeperActor* Board)
+{
+	return true;
+}
+
+void UMineSweeperNetComponent::ServerResetBoard_Implementation(AMineSweeperActor* Board)
+{
+	if (Board)
+	{
+		Board->ResetBoard();
+	}
+}
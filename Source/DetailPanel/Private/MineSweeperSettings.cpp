@@ -0,0 +1,61 @@
+#include "MineSweeperSettings.h"
+#include "MineSweeperBoard.h"
+
+UMineSweeperSettings::UMineSweeperSettings()
+{
+	CategoryName = TEXT("Game");
+	SectionName = TEXT("MineSweeper");
+}
+
+int64 UMineSweeperSettings::GetMaxBoardFields() const
+{
+	//Field indices are int32
+	int64 MaxFields = MAX_int32;
+	if (MaxBoardFields > 0)
+	{
+		MaxFields = FMath::Min(MaxFields, MaxBoardFields);
+	}
+	if (MaxBoardMegabytes > 0)
+	{
+		MaxFields = FMath::Min(MaxFields, int64(MaxBoardMegabytes) * 1024 * 1024 / FMineSweeperBoard::EstimateGeneratedSize(1));
+	}
+	return MaxFields;
+}
+
+bool UMineSweeperSettings::FitsBoardBudget(int64 NumFields, FString* OutReason)
+{
+	const int64 MaxFields = GetDefault<UMineSweeperSettings>()->GetMaxBoardFields();
+	if (NumFields <= MaxFields)
+	{
+		return true;
+	}
+
+	if (OutReason)
+	{
+		*OutReason = FString::Printf(TEXT("%lld fields, about %lld MB, is over the budget of %lld fields set in the MineSweeper project settings"),
+			NumFields, FMineSweeperBoard::EstimateGeneratedSize(NumFields) / (1024 * 1024), MaxFields);
+	}
+	return false;
+}
+
+bool UMineSweeperSettings::FitsMappedBoardBudget(int64 NumFields, FString* OutReason)
+{
+	//Field indices are int32 here as well
+	const UMineSweeperSettings* Settings = GetDefault<UMineSweeperSettings>();
+	int64 MaxFields = MAX_int32;
+	if (Settings->MaxBoardMegabytes > 0)
+	{
+		MaxFields = FMath::Min(MaxFields, int64(Settings->MaxBoardMegabytes) * 1024 * 1024 / FMineSweeperBoard::EstimateMappedSize(1));
+	}
+	if (NumFields <= MaxFields)
+	{
+		return true;
+	}
+
+	if (OutReason)
+	{
+		*OutReason = FString::Printf(TEXT("%lld fields played from the file, about %lld MB, is over the budget of %lld fields set in the MineSweeper project settings"),
+			NumFields, FMineSweeperBoard::EstimateMappedSize(NumFields) / (1024 * 1024), MaxFields);
+	}
+	return false;
+}
@@ -0,0 +1,230 @@
+#include "SMineBoard.h"
+#include "MineSweeperActor.h"
+#include "Rendering/DrawElements.h"
+#include "Fonts/FontMeasure.h"
+#include "Framework/Application/SlateApplication.h"
+
+SMineBoard::~SMineBoard()
+{
+	if (Board.IsValid())
+	{
+		Board->OnBoardChanged().Remove(BoardChangedHandle);
+	}
+}
+
+void SMineBoard::Construct(const FArguments& InArgs)
+{
+	CellSize = FMath::Max(InArgs._CellSize, 1.0f);
+	HiddenBrush = InArgs._HiddenBrush;
+	RevealedBrush = InArgs._RevealedBrush;
+	MineBrush = InArgs._MineBrush;
+	FlagBrush = InArgs._FlagBrush;
+	NumberFont = InArgs._NumberFont;
+	NumberColors = InArgs._NumberColors;
+	OnCellClicked = InArgs._OnCellClicked;
+
+	//Nothing here animates, all updates come from the board change event
+	SetCanTick(false);
+
+	SetBoard(InArgs._Board);
+}
+
+void SMineBoard::SetBoard(TWeakObjectPtr<AMineSweeperActor> InBoard)
+{
+	if (Board.IsValid())
+	{
+		Board->OnBoardChanged().Remove(BoardChangedHandle);
+	}
+	BoardChangedHandle.Reset();
+
+	Board = InBoard;
+
+	if (Board.IsValid())
+	{
+		BoardChangedHandle = Board->OnBoardChanged().AddSP(this, &SMineBoard::HandleBoardChanged);
+	}
+
+	UpdateCachedLayout();
+	Invalidate(EInvalidateWidgetReason::Layout | EInvalidateWidgetReason::Paint);
+}
+
+void SMineBoard::UpdateCachedLayout()
+{
+	CachedBoardSize = Board.IsValid() ? FIntPoint(Board->GetNumColumns(), Board->GetNumRows()) : FIntPoint::ZeroValue;
+	bCachedHexLayout = Board.IsValid() && Board->GetTopology() == EMineBoardTopology::Hex6;
+}
+
+void SMineBoard::HandleBoardChanged(const TArray<int32>& ChangedIndices)
+{
+	const FIntPoint BoardSize = Board.IsValid() ? FIntPoint(Board->GetNumColumns(), Board->GetNumRows()) : FIntPoint::ZeroValue;
+	const bool bHexLayout = Board.IsValid() && Board->GetTopology() == EMineBoardTopology::Hex6;
+	if (BoardSize != CachedBoardSize || bHexLayout != bCachedHexLayout)
+	{
+		UpdateCachedLayout();
+		Invalidate(EInvalidateWidgetReason::Layout | EInvalidateWidgetReason::Paint);
+	}
+	else
+	{
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
+
+bool SMineBoard::HasResource(const FSlateBrush* Brush)
+{
+	return Brush && Brush->DrawAs != ESlateBrushDrawType::NoDrawType && (Brush->GetResourceObject() || Brush->GetResourceName() != NAME_None);
+}
+
+const FString& SMineBoard::GetNumberString(int32 Number)
+{
+	static TArray<FString> Strings;
+	if (Strings.Num() == 0)
+	{
+		for (int32 i = 0; i <= 26; i++)
+		{
+			Strings.Add(FString::FromInt(i));
+		}
+	}
+	return Strings.IsValidIndex(Number) ? Strings[Number] : Strings[0];
+}
+
+bool SMineBoard::GetCellAt(const FGeometry& MyGeometry, const FVector2D& ScreenPosition, int32& OutColIndex, int32& OutRowIndex) const
+{
+	if (!Board.IsValid())
+	{
+		return false;
+	}
+
+	const FVector2D LocalPosition = MyGeometry.AbsoluteToLocal(ScreenPosition);
+	OutRowIndex = FMath::FloorToInt(LocalPosition.Y / CellSize);
+	OutColIndex = FMath::FloorToInt((LocalPosition.X - GetRowShift(OutRowIndex)) / CellSize);
+	return Board->IsValidIndex(OutColIndex, OutRowIndex);
+}
+
+FVector2D SMineBoard::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	//Shifted rows stick out half a field on the right
+	const float ExtraWidth = bCachedHexLayout && CachedBoardSize.Y > 1 ? CellSize * 0.5f : 0.0f;
+	return FVector2D(CachedBoardSize.X * CellSize + ExtraWidth, CachedBoardSize.Y * CellSize);
+}
+
+FReply SMineBoard::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	//Take the down so that we get the matching up
+	if (MouseEvent.GetEffectingButton() == EKeys::LeftMouseButton || MouseEvent.GetEffectingButton() == EKeys::RightMouseButton)
+	{
+		return FReply::Handled();
+	}
+	return FReply::Unhandled();
+}
+
+FReply SMineBoard::OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const bool bRightClick = MouseEvent.GetEffectingButton() == EKeys::RightMouseButton;
+	if (!bRightClick && MouseEvent.GetEffectingButton() != EKeys::LeftMouseButton)
+	{
+		return FReply::Unhandled();
+	}
+
+	int32 ColIndex, RowIndex;
+	if (GetCellAt(MyGeometry, MouseEvent.GetScreenSpacePosition(), ColIndex, RowIndex))
+	{
+		OnCellClicked.ExecuteIfBound(ColIndex, RowIndex, bRightClick);
+	}
+	return FReply::Handled();
+}
+
+int32 SMineBoard::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	const AMineSweeperActor* BoardActor = Board.Get();
+	//A board that is not generated yet is painted as all hidden, the first click generates it
+	if (!BoardActor)
+	{
+		return LayerId;
+	}
+
+	const int32 ColNum = BoardActor->GetNumColumns();
+	const int32 RowNum = BoardActor->GetNumRows();
+	const bool bGameOver = BoardActor->IsGameOver();
+	const ESlateDrawEffect DrawEffect = ShouldBeEnabled(bParentEnabled) ? ESlateDrawEffect::None : ESlateDrawEffect::DisabledEffect;
+	const FLinearColor WidgetTint = InWidgetStyle.GetColorAndOpacityTint();
+
+	//Only paint the fields inside the culling rect, the board can be a lot larger than the viewport
+	const FVector2D CullTopLeft = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetTopLeft());
+	const FVector2D CullBottomRight = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetBottomRight());
+	const int32 MinCol = FMath::Clamp(FMath::FloorToInt((CullTopLeft.X - GetRowShift(1)) / CellSize), 0, ColNum);
+	const int32 MinRow = FMath::Clamp(FMath::FloorToInt(CullTopLeft.Y / CellSize), 0, RowNum);
+	const int32 MaxCol = FMath::Clamp(FMath::CeilToInt(CullBottomRight.X / CellSize), 0, ColNum);
+	const int32 MaxRow = FMath::Clamp(FMath::CeilToInt(CullBottomRight.Y / CellSize), 0, RowNum);
+
+	//Glyphs are measured once per paint, not per field. Cube26 numbers can have two digits.
+	static const FString MineGlyph = TEXT("*");
+	static const FString FlagGlyph = TEXT("F");
+	const TSharedRef<FSlateFontMeasure> FontMeasure = FSlateApplication::Get().GetRenderer()->GetFontMeasureService();
+	const FVector2D GlyphSize = FontMeasure->Measure(GetNumberString(8), NumberFont);
+	const FVector2D GlyphOffset = (FVector2D(CellSize, CellSize) - GlyphSize) * 0.5f;
+	const FVector2D WideGlyphSize = FontMeasure->Measure(GetNumberString(22), NumberFont);
+	const FVector2D WideGlyphOffset = (FVector2D(CellSize, CellSize) - WideGlyphSize) * 0.5f;
+	const FVector2D FieldSize(CellSize - 1.0f, CellSize - 1.0f);
+
+	const int32 ContentLayer = LayerId + 1;
+
+	for (int32 RowIndex = MinRow; RowIndex < MaxRow; RowIndex++)
+	{
+		for (int32 ColIndex = MinCol; ColIndex < MaxCol; ColIndex++)
+		{
+			const FVector2D FieldOffset(ColIndex * CellSize + GetRowShift(RowIndex), RowIndex * CellSize);
+			const FPaintGeometry FieldGeometry = AllottedGeometry.ToPaintGeometry(FieldSize, FSlateLayoutTransform(FieldOffset));
+			const FPaintGeometry GlyphGeometry = AllottedGeometry.ToPaintGeometry(GlyphSize, FSlateLayoutTransform(FieldOffset + GlyphOffset));
+
+			const bool bRevealed = BoardActor->IsRevealed(ColIndex, RowIndex);
+			const bool bFlagged = BoardActor->IsFlagged(ColIndex, RowIndex);
+
+			const FSlateBrush* FieldBrush = bRevealed && !bFlagged ? RevealedBrush : HiddenBrush;
+			if (FieldBrush)
+			{
+				FLinearColor Tint = FieldBrush->GetTint(InWidgetStyle) * WidgetTint;
+				if (bGameOver && BoardActor->IsCrossed(ColIndex, RowIndex))
+				{
+					Tint *= FLinearColor::Red;
+				}
+				FSlateDrawElement::MakeBox(OutDrawElements, LayerId, FieldGeometry, FieldBrush, DrawEffect, Tint);
+			}
+
+			if (bFlagged)
+			{
+				if (HasResource(FlagBrush))
+				{
+					FSlateDrawElement::MakeBox(OutDrawElements, ContentLayer, FieldGeometry, FlagBrush, DrawEffect, FlagBrush->GetTint(InWidgetStyle) * WidgetTint);
+				}
+				else
+				{
+					FSlateDrawElement::MakeText(OutDrawElements, ContentLayer, GlyphGeometry, FlagGlyph, NumberFont, DrawEffect, FLinearColor::Red * WidgetTint);
+				}
+			}
+			else if (bGameOver && BoardActor->IsMine(ColIndex, RowIndex))
+			{
+				if (HasResource(MineBrush))
+				{
+					FSlateDrawElement::MakeBox(OutDrawElements, ContentLayer, FieldGeometry, MineBrush, DrawEffect, MineBrush->GetTint(InWidgetStyle) * WidgetTint);
+				}
+				else
+				{
+					FSlateDrawElement::MakeText(OutDrawElements, ContentLayer, GlyphGeometry, MineGlyph, NumberFont, DrawEffect, FLinearColor::Black * WidgetTint);
+				}
+			}
+			else if (bRevealed)
+			{
+				const int32 Value = BoardActor->CalculateFieldNumber(ColIndex, RowIndex);
+				if (Value > 0)
+				{
+					const FLinearColor NumberColor = NumberColors.IsValidIndex(Value - 1) ? NumberColors[Value - 1] : FLinearColor::White;
+					const FPaintGeometry NumberGeometry = Value < 10 ? GlyphGeometry
+						: AllottedGeometry.ToPaintGeometry(WideGlyphSize, FSlateLayoutTransform(FieldOffset + WideGlyphOffset));
+					FSlateDrawElement::MakeText(OutDrawElements, ContentLayer, NumberGeometry, GetNumberString(Value), NumberFont, DrawEffect, NumberColor * WidgetTint);
+				}
+			}
+		}
+	}
+
+	return ContentLayer;
+}
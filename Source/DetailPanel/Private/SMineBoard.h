@@ -0,0 +1,97 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "Styling/SlateBrush.h"
+#include "Fonts/SlateFontInfo.h"
+
+class AMineSweeperActor;
+
+DECLARE_DELEGATE_ThreeParams(FOnMineBoardCellClicked, int32 /*ColIndex*/, int32 /*RowIndex*/, bool /*bRightClick*/);
+
+//Draws the whole board of a AMineSweeperActor in a single paint call.
+//The widget never ticks and only invalidates its paint when the board reports a change.
+class SMineBoard : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMineBoard)
+		: _CellSize(24.0f)
+		, _HiddenBrush(nullptr)
+		, _RevealedBrush(nullptr)
+		, _MineBrush(nullptr)
+		, _FlagBrush(nullptr)
+	{ }
+
+	SLATE_ARGUMENT(TWeakObjectPtr<AMineSweeperActor>, Board)
+
+	/** Size of a single field in slate units */
+	SLATE_ARGUMENT(float, CellSize)
+
+	SLATE_ARGUMENT(const FSlateBrush*, HiddenBrush)
+
+	SLATE_ARGUMENT(const FSlateBrush*, RevealedBrush)
+
+	/** Drawn on mines once the game is over. A '*' is drawn if the brush has no resource. */
+	SLATE_ARGUMENT(const FSlateBrush*, MineBrush)
+
+	/** Drawn on flagged fields. A 'F' is drawn if the brush has no resource. */
+	SLATE_ARGUMENT(const FSlateBrush*, FlagBrush)
+
+	SLATE_ARGUMENT(FSlateFontInfo, NumberFont)
+
+	/** Colours for the numbers from 1 up, higher numbers are drawn white */
+	SLATE_ARGUMENT(TArray<FLinearColor>, NumberColors)
+
+	SLATE_EVENT(FOnMineBoardCellClicked, OnCellClicked)
+
+	SLATE_END_ARGS()
+
+	virtual ~SMineBoard();
+
+	void Construct(const FArguments& InArgs);
+
+	//Switches to another board and repaints
+	void SetBoard(TWeakObjectPtr<AMineSweeperActor> InBoard);
+
+	//Returns false if the position is outside of the board
+	bool GetCellAt(const FGeometry& MyGeometry, const FVector2D& ScreenPosition, int32& OutColIndex, int32& OutRowIndex) const;
+
+public:
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+
+protected:
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	void HandleBoardChanged(const TArray<int32>& ChangedIndices);
+
+	static bool HasResource(const FSlateBrush* Brush);
+
+	//Number texts from 0 to 26, the most neighbours a field can have
+	static const FString& GetNumberString(int32 Number);
+
+	//Horizontal shift of a row, odd rows of a Hex6 board sit half a field to the right
+	float GetRowShift(int32 RowIndex) const { return bCachedHexLayout && (RowIndex & 1) ? CellSize * 0.5f : 0.0f; }
+
+	void UpdateCachedLayout();
+
+	TWeakObjectPtr<AMineSweeperActor> Board;
+	FDelegateHandle BoardChangedHandle;
+
+	float CellSize = 24.0f;
+	const FSlateBrush* HiddenBrush = nullptr;
+	const FSlateBrush* RevealedBrush = nullptr;
+	const FSlateBrush* MineBrush = nullptr;
+	const FSlateBrush* FlagBrush = nullptr;
+	FSlateFontInfo NumberFont;
+	TArray<FLinearColor> NumberColors;
+	FOnMineBoardCellClicked OnCellClicked;
+
+	//Board size the last layout was computed for
+	FIntPoint CachedBoardSize = FIntPoint::ZeroValue;
+
+	//Set if the last layout was computed for a Hex6 board
+	bool bCachedHexLayout = false;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "MineBoardNetState.generated.h"
+
+class AMineSweeperActor;
+struct FMineBoardNetState;
+
+//One replicated word of the board. Covers 32 consecutive fields with their revealed and flag bits
+//and the 5 bit field numbers of the revealed ones (31 marks a mine). Mines are never part of this otherwise.
+USTRUCT()
+struct FMineBoardNetWord : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	static constexpr int32 FieldsPerWord = 32;
+
+	//Approximate payload of one word on the wire, used to report the bytes sent per move
+	static constexpr int32 PayloadBytes = sizeof(int32) + sizeof(uint8) + 3 * sizeof(uint32) + 2 * sizeof(uint64);
+
+	//Number value sent for a revealed mine
+	static constexpr int32 MineNumber = 0x1F;
+
+	UPROPERTY()
+	int32 WordIndex = INDEX_NONE;
+
+	//Board epoch the word belongs to, wraps around. Lets clients drop words of a board that was reset.
+	UPROPERTY()
+	uint8 Epoch = 0;
+
+	UPROPERTY()
+	uint32 RevealedBits = 0;
+
+	UPROPERTY()
+	uint32 FlagBits = 0;
+
+	//Field numbers of fields 0-15 of the word, 4 bits each
+	UPROPERTY()
+	uint64 NumbersLo = 0;
+
+	//Field numbers of fields 16-31 of the word, 4 bits each
+	UPROPERTY()
+	uint64 NumbersHi = 0;
+
+	//Fifth bit of every field number, only ever set on boards with more than 15 neighbours
+	UPROPERTY()
+	uint32 NumberHighBits = 0;
+
+	int32 GetNumber(int32 Bit) const
+	{
+		const uint64 Numbers = Bit < 16 ? NumbersLo : NumbersHi;
+		return int32((Numbers >> ((Bit & 15) * 4)) & 0xF) | int32(((NumberHighBits >> Bit) & 1) << 4);
+	}
+
+	void SetNumber(int32 Bit, int32 Number)
+	{
+		uint64& Numbers = Bit < 16 ? NumbersLo : NumbersHi;
+		const int32 Shift = (Bit & 15) * 4;
+		Numbers = (Numbers & ~(uint64(0xF) << Shift)) | (uint64(Number & 0xF) << Shift);
+		NumberHighBits = (NumberHighBits & ~(1u << Bit)) | (uint32((Number >> 4) & 1) << Bit);
+	}
+
+	void PostReplicatedAdd(const FMineBoardNetState& InArraySerializer);
+	void PostReplicatedChange(const FMineBoardNetState& InArraySerializer);
+};
+
+//Delta replicated board state. Only words that changed since the board was generated are in the array
+//and only the words touched by a move are sent for that move.
+USTRUCT()
+struct FMineBoardNetState : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FMineBoardNetWord> Words;
+
+	//The actor owning this state, set on both server and clients
+	UPROPERTY(NotReplicated)
+	TObjectPtr<AMineSweeperActor> OwnerActor = nullptr;
+
+	//Server only lookup from word index to the position in Words
+	TMap<int32, int32> WordLookup;
+
+	//Returns the word for the index, adding it if it was never sent before
+	FMineBoardNetWord& FindOrAddWord(int32 WordIndex);
+
+	void Reset();
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FMineBoardNetWord, FMineBoardNetState>(Words, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FMineBoardNetState> : public TStructOpsTypeTraitsBase2<FMineBoardNetState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
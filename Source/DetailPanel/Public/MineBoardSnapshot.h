@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/RefCounting.h"
+#include "MineBoardTopology.h"
+#include <atomic>
+
+class AMineSweeperActor;
+
+//A band of whole rows of a published board as EMineCellState bytes. Never modified once published,
+//so versions that did not touch the band share it.
+class DETAILPANEL_API FMineBoardTile : public FRefCountBase
+{
+public:
+	int32 FirstRow = 0;
+	int32 NumRows = 0;
+	TArray<uint8> States;
+};
+
+//Immutable view of a board after one move. Safe to read from any thread for as long as it is referenced.
+//Mines are only in it once the game is over, just like GetBoardSnapshot.
+class DETAILPANEL_API FMineBoardVersion : public FRefCountBase
+{
+public:
+	//Increases by one for every published version of a board
+	uint64 Serial = 0;
+
+	FMineBoardDims Dims;
+	EMineBoardTopology Topology = EMineBoardTopology::Square8;
+	int32 MineCount = 0;
+	bool bGameOver = false;
+	bool bHasWon = false;
+
+	//FMineSweeperBoard::GetStateHash of the board this was taken from, only usable as a cache key if bStateHashComplete
+	uint64 StateHash = 0;
+	bool bStateHashComplete = false;
+
+	int32 RowsPerTile = 1;
+	TArray<TRefCountPtr<const FMineBoardTile>> Tiles;
+
+	//Returns the EMineCellState of a field
+	FORCEINLINE uint8 GetState(int32 ColIndex, int32 RowIndex) const
+	{
+		const FMineBoardTile& Tile = *Tiles[RowIndex / RowsPerTile];
+		return Tile.States[(RowIndex - Tile.FirstRow) * Dims.Columns + ColIndex];
+	}
+};
+
+//Publishes a new FMineBoardVersion after every move and hands the latest one to readers on any thread.
+//Readers never lock and the game thread never waits for readers. Readers announce themselves in one of two counters,
+//picked by the parity of the epoch every publish advances. A replaced version is kept until both counters were seen
+//at zero after it was replaced, by then every reader that could have loaded it took its own reference or left.
+//New readers move to the other counter with every publish, so a counter always drains and replaced versions are
+//released one or two publishes later even under a steady stream of readers.
+//Only the tiles containing changed fields are rebuilt for a new version, the rest are shared with the previous one.
+class DETAILPANEL_API FMineBoardSnapshotPublisher
+{
+public:
+	//Rough number of fields per tile, tiles always hold whole rows
+	static constexpr int32 FieldsPerTile = 4096;
+
+	FMineBoardSnapshotPublisher() = default;
+	~FMineBoardSnapshotPublisher();
+
+	FMineBoardSnapshotPublisher(const FMineBoardSnapshotPublisher&) = delete;
+	FMineBoardSnapshotPublisher& operator=(const FMineBoardSnapshotPublisher&) = delete;
+
+	//Game thread only. Publishes the current state of the board. An empty ChangedIndices rebuilds every tile.
+	void Publish(const AMineSweeperActor& Board, const TArray<int32>& ChangedIndices);
+
+	//Any thread. Returns the latest published version, null if nothing was published yet.
+	TRefCountPtr<const FMineBoardVersion> Acquire() const;
+
+	//Game thread only. Heap bytes of the latest version and of the retired ones still waiting for readers.
+	//Tiles shared between versions are counted once.
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	//Releases retired versions that no reader can be picking up anymore
+	void ReclaimRetired();
+
+	static TRefCountPtr<const FMineBoardTile> BuildTile(const AMineSweeperActor& Board, int32 FirstRow, int32 NumRows);
+
+	struct FRetiredVersion
+	{
+		FMineBoardVersion* Version = nullptr;
+		//Set once the reader counter of that parity was seen at zero after the version was replaced
+		bool bDrained[2] = { false, false };
+	};
+
+	//Holds one reference on behalf of the readers
+	std::atomic<FMineBoardVersion*> Published { nullptr };
+	std::atomic<uint64> Epoch { 0 };
+	mutable std::atomic<int32> ReaderCounts[2] = { {0}, {0} };
+
+	//Game thread only
+	TArray<FRetiredVersion> Retired;
+	uint64 NextSerial = 1;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/Widget.h"
+#include "Styling/SlateBrush.h"
+#include "Fonts/SlateFontInfo.h"
+#include "MineBoardWidget.generated.h"
+
+class AMineSweeperActor;
+class SMineBoard;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnMineBoardWidgetChanged);
+
+//Runtime UMG widget that shows and plays a AMineSweeperActor.
+//The board is painted in one call inside an invalidation panel and only repainted when the board changes,
+//so an idle board costs next to nothing no matter how large it is.
+UCLASS()
+class DETAILPANEL_API UMineBoardWidget : public UWidget
+{
+	GENERATED_BODY()
+
+public:
+	UMineBoardWidget(const FObjectInitializer& ObjectInitializer);
+
+	//Binds the widget to a board, clicks on the widget are sent to it through the owning player
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	void SetBoard(AMineSweeperActor* InBoard);
+
+	UFUNCTION(BlueprintPure, Category = "MineSweeper")
+	AMineSweeperActor* GetBoard() const { return Board; }
+
+	//Called whenever the bound board changed, use it to update counters and the like without polling
+	UPROPERTY(BlueprintAssignable, Category = "MineSweeper")
+	FOnMineBoardWidgetChanged OnBoardChanged;
+
+	virtual void SynchronizeProperties() override;
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+
+#if WITH_EDITOR
+	virtual const FText GetPaletteCategory() override;
+#endif
+
+protected:
+	virtual TSharedRef<SWidget> RebuildWidget() override;
+
+	void HandleCellClicked(int32 ColIndex, int32 RowIndex, bool bRightClick);
+
+	void HandleBoardChanged(const TArray<int32>& ChangedIndices);
+
+	void BindBoardEvents();
+
+	void UnbindBoardEvents();
+
+protected:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "MineSweeper")
+	TObjectPtr<AMineSweeperActor> Board;
+
+	//Size of a single field in slate units
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance", meta = (ClampMin = "4"))
+	float CellSize = 24.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FSlateBrush HiddenBrush;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FSlateBrush RevealedBrush;
+
+	//A '*' is drawn if no image is set
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FSlateBrush MineBrush;
+
+	//A 'F' is drawn if no image is set
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FSlateBrush FlagBrush;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	FSlateFontInfo NumberFont;
+
+	//Colours for the numbers 1 to 8
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Appearance")
+	TArray<FLinearColor> NumberColors;
+
+	TSharedPtr<SMineBoard> MyBoard;
+
+	FDelegateHandle BoardChangedHandle;
+};
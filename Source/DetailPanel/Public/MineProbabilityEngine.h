@@ -0,0 +1,82 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/RefCounting.h"
+#include "MineBoardTopology.h"
+#include <atomic>
+
+class FMineBoardVersion;
+
+//Mine probability of every field of one board version
+struct DETAILPANEL_API FMineProbabilityMap
+{
+	//Serial of the FMineBoardVersion this was calculated from
+	uint64 Serial = 0;
+
+	FMineBoardDims Dims;
+
+	//One entry per field, row by row. Fields that are revealed or flagged are negative.
+	TArray<float> Probabilities;
+
+	//False if at least one frontier component ran out of budget and was estimated instead of counted
+	bool bExact = true;
+
+	//False if the numbers and flags on the board can't all be satisfied, for example because of a wrong flag
+	bool bConsistent = true;
+
+	int32 NumComponents = 0;
+	int32 NumFrontierFields = 0;
+
+	float GetProbability(int32 ColIndex, int32 RowIndex) const
+	{
+		return Probabilities.Num() ? Probabilities[Dims.ToIndex(ColIndex, RowIndex)] : -1.0f;
+	}
+};
+
+//Calculates the exact probability of a mine for every hidden field of a board, given the revealed numbers, the flags and the mine count.
+//Flags are trusted to be right. Hidden fields next to a number (the frontier) are split into independent components that share no number.
+//Every component is counted on its own by a memoized sweep over its fields that keeps only the numbers still open as state,
+//giving the number of solutions for every mine count. The components are then weighted against each other and against the
+//fields nobody knows anything about through the number of ways to place the remaining mines there.
+//The work for one board is capped by NodeBudget, no single component may take more than a quarter of it.
+//Components past their share fall back to an estimate from their numbers alone, so huge boards still get an answer quickly.
+class DETAILPANEL_API FMineProbabilitySolver
+{
+public:
+	//Work allowed for one board, roughly the number of polynomial terms touched
+	static constexpr int64 DefaultNodeBudget = 40 * 1000 * 1000;
+
+	explicit FMineProbabilitySolver(int64 InNodeBudget = DefaultNodeBudget)
+		: NodeBudget(InNodeBudget)
+	{
+	}
+
+	//Any thread. Returns false if cancelled through bCancelled, OutMap is left incomplete then.
+	bool Solve(const FMineBoardVersion& Version, FMineProbabilityMap& OutMap, const std::atomic<bool>* bCancelled = nullptr) const;
+
+private:
+	int64 NodeBudget;
+};
+
+DECLARE_DELEGATE_OneParam(FOnMineProbabilitiesReady, const FMineProbabilityMap& /*Map*/);
+
+//One probability calculation on the thread pool. The result is handed to the delegate on the game thread,
+//unless the job was cancelled before, which is what the owner does as soon as the board changes again.
+//Results are kept in a small cache keyed by the board state hash, a state that was solved before is not solved again.
+class DETAILPANEL_API FMineProbabilityJob : public TSharedFromThis<FMineProbabilityJob, ESPMode::ThreadSafe>
+{
+public:
+	//Game thread only
+	static TSharedRef<FMineProbabilityJob, ESPMode::ThreadSafe> Launch(TRefCountPtr<const FMineBoardVersion> Version, FOnMineProbabilitiesReady OnReady);
+
+	//Game thread only. The delegate is not called after this, the worker stops at its next check.
+	void Cancel();
+
+	bool IsCancelled() const { return bCancelled.load(); }
+
+private:
+	FMineProbabilityJob() = default;
+
+	std::atomic<bool> bCancelled { false };
+	FOnMineProbabilitiesReady OnReady;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "MineSharedMemoryProtocol.h"
+
+class AMineSweeperActor;
+
+//POSIX shared memory is there on Linux and Mac
+#define MINESWEEPER_SHARED_MEMORY (PLATFORM_UNIX || PLATFORM_MAC)
+
+//Exposes the board of one actor to other processes on the same machine through a shared memory segment,
+//see MineSharedMemoryProtocol.h for the layout. Bots read the cells straight from the segment and write moves into
+//the command ring. The bridge applies them on the game thread from the core ticker, so it runs in the editor as well,
+//and answers with change events. Moves go straight to the board, the actor needs authority.
+//Start one from the console with MineSweeper.Bridge.Start, Tools/MineBotClient is a client to test it with.
+class DETAILPANEL_API FMineSharedMemoryBridge
+{
+public:
+	FMineSharedMemoryBridge() = default;
+	~FMineSharedMemoryBridge();
+
+	FMineSharedMemoryBridge(const FMineSharedMemoryBridge&) = delete;
+	FMineSharedMemoryBridge& operator=(const FMineSharedMemoryBridge&) = delete;
+
+	//Creates the segment "/minesweeper-<Name>", replacing a stale one, and starts serving the actor.
+	//The cells have room for the current board or CellCapacity fields, whichever is more. Ring capacities are rounded up to powers of two.
+	bool Start(AMineSweeperActor* InActor, const FString& Name, int32 CellCapacity = 0, int32 RingCapacity = 64 * 1024);
+
+	//Marks the segment as detached for clients still attached and removes it
+	void Stop();
+
+	bool IsRunning() const { return Header != nullptr; }
+
+	const FString& GetSegmentName() const { return SegmentName; }
+
+	AMineSweeperActor* GetActor() const { return Actor.Get(); }
+
+	//Applies waiting commands until MaxCommands are done, MaxSeconds passed or the event ring has no room for the answers.
+	//Returns the number of commands applied.
+	int32 ProcessCommands(int32 MaxCommands, double MaxSeconds);
+
+	//Moves that went through the actor and the game thread time they took there, board updates and events included
+	uint64 GetNumAppliedMoves() const { return NumAppliedMoves; }
+	uint64 GetNumRejectedMoves() const { return NumRejectedMoves; }
+	double GetMoveSeconds() const { return MoveSeconds; }
+	void ResetStats();
+
+private:
+	bool Tick(float DeltaTime);
+
+	void OnBoardChanged(const TArray<int32>& ChangedIndices);
+
+	//Copies the whole board into the cells and queues a Resync
+	void WriteAllCells();
+
+	void UpdateGameState();
+
+	void ApplyCommand(const MineShm::FCommand& Command);
+
+	//Pushes an event if at least Reserve entries stay free afterwards
+	bool PushEvent(MineShm::EEvent Type, int32 Index, uint8 State, uint32 Reserve);
+
+	//Sends the pending Resync once there is room for it and a MoveDone behind it
+	void FlushResync();
+
+	//Sends the MoveDone of a move whose cascade ran over several frames once the cascade is done.
+	//Returns false while it still waits, no other command is applied until then.
+	bool FlushDeferredMoveDone();
+
+	void BeginCellWrite();
+	void EndCellWrite();
+
+	TWeakObjectPtr<AMineSweeperActor> Actor;
+	FDelegateHandle BoardChangedHandle;
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	FString SegmentName;
+	MineShm::FHeader* Header = nullptr;
+	uint64 SegmentSize = 0;
+	MineShm::FRingHeader* CommandRing = nullptr;
+	MineShm::FRingHeader* EventRing = nullptr;
+	uint8* Cells = nullptr;
+
+	//Reused for reading field states from the actor
+	TArray<uint8> Scratch;
+
+	bool bResyncPending = false;
+	bool bLastGameOver = false;
+
+	uint64 NumAppliedMoves = 0;
+	uint64 NumRejectedMoves = 0;
+	double MoveSeconds = 0.0;
+
+	//MoveDone of a move whose cascade is still pending
+	bool bMoveDoneDeferred = false;
+	int32 DeferredMoveIndex = INDEX_NONE;
+	uint8 DeferredMoveResult = 0;
+};
@@ -0,0 +1,182 @@
+#pragma once
+
+//Layout of the shared memory segment FMineSharedMemoryBridge exposes a board through.
+//Only uses the standard library so bot processes can include it as it is, see Tools/MineBotClient.
+//
+//  MineShm::FHeader                     at 0
+//  Cells, one EMineCellState per field  at CellsOffset, row by row, CellCapacity bytes
+//  Command ring                         at CommandRingOffset, client to game
+//  Event ring                           at EventRingOffset, game to client
+//
+//Both rings have one producer and one consumer. Head and Tail only grow, an entry lives at (Position & (Capacity - 1)).
+//The producer writes the entry and then publishes it with a release store to Head, the consumer reads entries up to
+//an acquire load of Head and hands them back with a release store to Tail.
+//
+//Every command gets exactly one MoveDone event, in the order the commands were sent, so a client can keep many moves in flight.
+//The FieldChanged events of a move come before its MoveDone, also when its cascade runs over several frames. The cells are written before the events that announce them,
+//so after reading an event the cells are at least that new. Readers that look at the cells without waiting for events
+//can use BoardSerial, which is odd while the game writes cells.
+
+#include <atomic>
+#include <cstdint>
+
+namespace MineShm
+{
+	constexpr uint32_t Magic = 0x4D48534D; //'MSHM'
+	constexpr uint32_t Version = 1;
+
+	//Segment names are "/minesweeper-<name>", see shm_open
+	constexpr const char* NamePrefix = "/minesweeper-";
+
+	enum class ECommand : uint8_t
+	{
+		Click = 1,
+		//Toggles the flag, the same as a right click
+		Flag = 2,
+		Chord = 3,
+		//Starts a new board of the same size, Index is ignored
+		Reset = 4,
+	};
+
+	enum class EEvent : uint8_t
+	{
+		//Index is the field, State its new EMineCellState
+		FieldChanged = 1,
+		//Answers one command. Index is the field of the command, State one of EMoveResult.
+		MoveDone = 2,
+		//More changed than fit into the ring or the whole board was replaced, read all cells again
+		Resync = 3,
+	};
+
+	enum class EMoveResult : uint8_t
+	{
+		Applied = 0,
+		//The move is not possible on that field right now, nothing changed
+		Rejected = 1,
+		Unknown = 2,
+	};
+
+	//Bits of FHeader::GameState
+	enum EGameState : uint32_t
+	{
+		StateGenerated = 1,
+		StateGameOver = 2,
+		StateWon = 4,
+		//The game closed the segment, nothing will answer anymore
+		StateDetached = 8,
+	};
+
+	struct FCommand
+	{
+		int32_t Index;
+		uint8_t Type;
+		uint8_t Reserved[3];
+	};
+
+	struct FEvent
+	{
+		int32_t Index;
+		uint8_t Type;
+		uint8_t State;
+		uint16_t Reserved;
+	};
+
+	static_assert(sizeof(FCommand) == 8, "Commands are 8 bytes");
+	static_assert(sizeof(FEvent) == 8, "Events are 8 bytes");
+
+	//Head and Tail on their own cache lines so producer and consumer don't share one
+	struct FRingHeader
+	{
+		alignas(64) std::atomic<uint64_t> Head;
+		alignas(64) std::atomic<uint64_t> Tail;
+	};
+
+	static_assert(sizeof(FRingHeader) == 128, "Ring headers are two cache lines");
+
+	struct FHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t HeaderSize;
+		uint32_t Reserved0;
+		uint64_t SegmentSize;
+
+		//Fields the cells have room for. The ring capacities are powers of two.
+		uint32_t CellCapacity;
+		uint32_t CommandCapacity;
+		uint32_t EventCapacity;
+		uint32_t Reserved1;
+
+		uint64_t CellsOffset;
+		uint64_t CommandRingOffset;
+		uint64_t EventRingOffset;
+
+		//Board size, only changes together with a Resync
+		alignas(64) std::atomic<int32_t> Columns;
+		std::atomic<int32_t> Rows;
+		std::atomic<int32_t> MineCount;
+		std::atomic<uint32_t> GameState;
+		std::atomic<uint64_t> BoardSerial;
+
+		//Bumped every time the game looks at the command ring, a client can tell a stalled game from a slow one
+		std::atomic<uint64_t> Heartbeat;
+		std::atomic<uint64_t> EventsDropped;
+	};
+
+	static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free,
+		"The segment is shared between processes, its atomics must not hide a lock");
+
+	inline FRingHeader* GetRing(FHeader* Header, uint64_t Offset)
+	{
+		return reinterpret_cast<FRingHeader*>(reinterpret_cast<uint8_t*>(Header) + Offset);
+	}
+
+	template<typename EntryType>
+	inline EntryType* GetEntries(FRingHeader* Ring)
+	{
+		return reinterpret_cast<EntryType*>(Ring + 1);
+	}
+
+	inline uint8_t* GetCells(FHeader* Header)
+	{
+		return reinterpret_cast<uint8_t*>(Header) + Header->CellsOffset;
+	}
+
+	//Single producer. Returns false if the ring is full.
+	template<typename EntryType>
+	inline bool Push(FRingHeader* Ring, uint32_t Capacity, const EntryType& Entry)
+	{
+		const uint64_t Head = Ring->Head.load(std::memory_order_relaxed);
+		if (Head - Ring->Tail.load(std::memory_order_acquire) >= Capacity)
+		{
+			return false;
+		}
+		GetEntries<EntryType>(Ring)[Head & (Capacity - 1)] = Entry;
+		Ring->Head.store(Head + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Free entries as the producer sees them
+	inline uint64_t GetFree(const FRingHeader* Ring, uint32_t Capacity)
+	{
+		return Capacity - (Ring->Head.load(std::memory_order_relaxed) - Ring->Tail.load(std::memory_order_acquire));
+	}
+
+	//Single consumer. Hands up to MaxEntries entries in order to Visitor, which returns false to leave an entry for later.
+	//The entries handed over are freed together at the end, returns how many.
+	template<typename EntryType, typename VisitorType>
+	inline uint32_t Consume(FRingHeader* Ring, uint32_t Capacity, uint32_t MaxEntries, VisitorType&& Visitor)
+	{
+		const uint64_t Tail = Ring->Tail.load(std::memory_order_relaxed);
+		const uint64_t Available = Ring->Head.load(std::memory_order_acquire) - Tail;
+		const uint32_t Limit = uint32_t(Available < MaxEntries ? Available : MaxEntries);
+		const EntryType* Entries = GetEntries<EntryType>(Ring);
+		uint32_t Count = 0;
+		while (Count < Limit && Visitor(Entries[(Tail + Count) & (Capacity - 1)]))
+		{
+			Count++;
+		}
+		Ring->Tail.store(Tail + Count, std::memory_order_release);
+		return Count;
+	}
+}
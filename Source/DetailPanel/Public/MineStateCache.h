@@ -0,0 +1,101 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Bounded cache of results derived from a board state, keyed by FMineSweeperBoard::GetStateHash.
+//Keeps at most MaxEntries results costing MaxCost in total, the least recently used ones are dropped first.
+//Meant for a handful of expensive results, lookups walk all entries. Not thread safe.
+template<typename ValueType>
+class TMineStateCache
+{
+public:
+	TMineStateCache(int32 InMaxEntries, int64 InMaxCost)
+		: MaxEntries(FMath::Max(InMaxEntries, 1))
+		, MaxCost(InMaxCost)
+	{
+	}
+
+	//Returns the result for the state and marks it as used, null if there is none. Valid until the next Add.
+	const ValueType* Find(uint64 Key)
+	{
+		for (FEntry& Entry : Entries)
+		{
+			if (Entry.Key == Key)
+			{
+				Entry.LastUse = ++UseCounter;
+				NumHits++;
+				return &Entry.Value;
+			}
+		}
+		NumMisses++;
+		return nullptr;
+	}
+
+	//Adds or replaces the result for a state. A result costing more than the whole cache is not kept.
+	void Add(uint64 Key, ValueType Value, int64 Cost)
+	{
+		Remove(Key);
+		if (Cost > MaxCost)
+		{
+			return;
+		}
+
+		while (Entries.Num() >= MaxEntries || TotalCost + Cost > MaxCost)
+		{
+			int32 OldestIndex = 0;
+			for (int32 EntryIndex = 1; EntryIndex < Entries.Num(); EntryIndex++)
+			{
+				if (Entries[EntryIndex].LastUse < Entries[OldestIndex].LastUse)
+				{
+					OldestIndex = EntryIndex;
+				}
+			}
+			TotalCost -= Entries[OldestIndex].Cost;
+			Entries.RemoveAtSwap(OldestIndex, 1, false);
+		}
+
+		Entries.Add({ Key, MoveTemp(Value), Cost, ++UseCounter });
+		TotalCost += Cost;
+	}
+
+	void Remove(uint64 Key)
+	{
+		for (int32 EntryIndex = 0; EntryIndex < Entries.Num(); EntryIndex++)
+		{
+			if (Entries[EntryIndex].Key == Key)
+			{
+				TotalCost -= Entries[EntryIndex].Cost;
+				Entries.RemoveAtSwap(EntryIndex, 1, false);
+				return;
+			}
+		}
+	}
+
+	void Empty()
+	{
+		Entries.Empty();
+		TotalCost = 0;
+	}
+
+	int32 Num() const { return Entries.Num(); }
+	int64 GetTotalCost() const { return TotalCost; }
+	int64 GetNumHits() const { return NumHits; }
+	int64 GetNumMisses() const { return NumMisses; }
+
+private:
+	struct FEntry
+	{
+		uint64 Key;
+		ValueType Value;
+		int64 Cost;
+		uint64 LastUse;
+	};
+
+	TArray<FEntry> Entries;
+	int32 MaxEntries;
+	int64 MaxCost;
+	int64 TotalCost = 0;
+	uint64 UseCounter = 0;
+	int64 NumHits = 0;
+	int64 NumMisses = 0;
+};
@@ -2,8 +2,45 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Containers/Ticker.h"
+#include "MineBoardNetState.h"
+#include "MineMoveLog.h"
+#include "MineBoardTopology.h"
+#include "MineSweeperBoard.h"
+#include "MineSweeperTypes.h"
 #include "MineSweeperActor.generated.h"
 
+class APlayerController;
+class UInstancedStaticMeshComponent;
+class FMineBoardSnapshotPublisher;
+
+//State of one field as returned by the bulk snapshot functions, one byte per field.
+//Values below Hidden are the number of a revealed field, boards with more neighbours go past Revealed8.
+UENUM(BlueprintType)
+enum class EMineCellState : uint8
+{
+	Revealed0 = 0,
+	Revealed1 = 1,
+	Revealed2 = 2,
+	Revealed3 = 3,
+	Revealed4 = 4,
+	Revealed5 = 5,
+	Revealed6 = 6,
+	Revealed7 = 7,
+	Revealed8 = 8,
+	Hidden = 32,
+	Flagged = 33,
+	//Only reported once the game is over or when mines were asked for on the server
+	Mine = 34,
+	//The mine that ended the game
+	HitMine = 35,
+	//A flag on a field without a mine, only reported once the game is over
+	WrongFlag = 36,
+};
+
+//Broadcast after every move with the indices of the fields that changed. An empty array means the whole board changed.
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnMineBoardChanged, const TArray<int32>& /*ChangedIndices*/);
+
 UCLASS()
 class DETAILPANEL_API AMineSweeperActor : public AActor
 {
@@ -15,6 +52,30 @@ public:
 
 	virtual void PostInitProperties() override;
 
+	virtual void BeginPlay() override;
+
+	virtual void BeginDestroy() override;
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	virtual void PostRepNotifies() override;
+
+	//The board itself is not a property, it is written here after the properties
+	virtual void Serialize(FArchive& Ar) override;
+
+	//Adds the board, its replication state, the move log and the snapshots, which are not properties and memreport would miss
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+
+#if WITH_EDITOR
+	virtual void PostEditUndo() override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	//Listen to this to redraw only when the board actually changes
+	FOnMineBoardChanged& OnBoardChanged() { return BoardChangedEvent; }
+
 public:
 
 	UFUNCTION()
@@ -31,21 +92,66 @@ public:
 	UFUNCTION()
 	void HandleRightClickOnField(int32 ColIndex, int32 RowIndex);
 
-	//Reset the whole board to new values
+	UFUNCTION()
+	bool CanChordOnField(int32 ColIndex, int32 RowIndex) const;
+
+	// Reveals all unflagged neighbours of a revealed number once it has as many flags around it as its number
+	UFUNCTION()
+	void HandleChordOnField(int32 ColIndex, int32 RowIndex);
+
+	//Reset the whole board to new values. The mines are placed with the first click.
 	UFUNCTION()
 	void ResetBoard();
+
+	//Sets the size, mine chance and seed from code and resets the board, the same as editing them in the details panel
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	void ConfigureBoard(int32 InColumnNum, int32 InRowNum, float InMineChance, int32 InSeed = 0);
+
+	//Writes the board to a board file, see FMineBoardFile. Files ending in .txt get the text format.
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	bool ExportBoard(const FString& Filename, bool bCompress = true) const;
+
+	//Replaces the board and its settings with a board file. The move log starts empty, the moves that led there are unknown.
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	bool ImportBoard(const FString& Filename);
+
+	//Left click from a game UI. Runs directly on the server and goes through the player's UMineSweeperNetComponent on clients.
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	void RequestClickOnField(APlayerController* PlayerController, int32 ColIndex, int32 RowIndex);
+
+	//Right click from a game UI. Runs directly on the server and goes through the player's UMineSweeperNetComponent on clients.
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	void RequestRightClickOnField(APlayerController* PlayerController, int32 ColIndex, int32 RowIndex);
+
+	//Board reset from a game UI. Runs directly on the server and goes through the player's UMineSweeperNetComponent on clients.
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	void RequestResetBoard(APlayerController* PlayerController);
 	
-	//Generates board if it is not already generated
+	//Returns true while a reveal cascade is still spreading over the next frames
+	UFUNCTION(BlueprintPure, Category = "MineSweeper")
+	bool IsRevealPending() const { return Board.HasPendingReveal(); }
+
+	//Returns true once the first click placed the mines. Until then every field is hidden.
 	UFUNCTION()
-	bool IsBoardGenerated() const { return bBoardGenerated; }
+	bool IsBoardGenerated() const { return Board.IsGenerated(); }
 
 	//Returns the number of columns in the game
 	UFUNCTION()
 	int32 GetNumColumns() const { return ColumnNum; }
 
-	//Returns the number of rows in the game
+	//Returns the number of rows in the game. Layers of a cube board are laid out below each other, so this counts all of them.
+	UFUNCTION()
+	int32 GetNumRows() const { return RowNum * GetNumLayers(); }
+
+	//Returns the number of layers, always 1 unless the topology is Cube26
 	UFUNCTION()
-	int32 GetNumRows() const { return RowNum; }
+	int32 GetNumLayers() const { return Topology == EMineSweeperTopology::Cube26 ? FMath::Max(LayerNum, 1) : 1; }
+
+	//Returns how the fields are connected
+	EMineBoardTopology GetTopology() const { return ToMineBoardTopology(Topology); }
+
+	//Returns the board extents for the topology policies
+	FMineBoardDims GetBoardDims() const;
 
 	// for a row and col return the number of mines around it
 	UFUNCTION()
@@ -68,21 +174,83 @@ public:
 	bool IsMine(int32 ColIndex, int32 RowIndex) const;
 
 	//returns true if the current game is overs
+	UFUNCTION(BlueprintPure, Category = "MineSweeper")
+	bool IsGameOver() const { return Board.IsGameOver(); }
+
+	//returns true once the game was won, without checking again
 	UFUNCTION()
-	bool IsGameOver() const { return bGameOver; }	
+	bool HasWon() const { return Board.HasWon(); }
 
-	//returns the value of mines assumed to be remaining based on set flags
+	//returns the number of mines on the board
 	UFUNCTION()
+	int32 GetMineCount() const { return Board.GetMineCount(); }
+
+	//returns the value of mines assumed to be remaining based on set flags
+	UFUNCTION(BlueprintPure, Category = "MineSweeper")
 	int32 GetMineCountForVisual() const;
 
 	//returns the updated haswon variable
-	UFUNCTION()
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
 	bool CheckAndUpdateHasWon();
 
+	//returns true if the col and row are inside the board
+	UFUNCTION()
+	bool IsValidIndex(int32 ColIndex, int32 RowIndex) const;
+
+	//returns the state of every field as one EMineCellState byte per field, row by row.
+	//Mines are only included once the game is over, or if bIncludeMines is set and this instance knows them (server).
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	TArray<uint8> GetBoardSnapshot(bool bIncludeMines = false) const;
+
+	//Same as GetBoardSnapshot for a rectangle of the board. The rectangle is clipped to the board.
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	TArray<uint8> GetBoardSnapshotRect(int32 ColIndex, int32 RowIndex, int32 Width, int32 Height, bool bIncludeMines = false) const;
+
+	//Native version of GetBoardSnapshotRect writing into an existing array, returns the clipped rectangle
+	FIntRect FillBoardSnapshot(const FIntRect& Rect, bool bIncludeMines, TArray<uint8>& OutStates) const;
+
+	//Returns the publisher of immutable board versions for readers on other threads.
+	//Created on first use, boards nobody reads from never pay for it. Keep the shared reference while acquiring versions.
+	TSharedRef<FMineBoardSnapshotPublisher, ESPMode::ThreadSafe> GetSnapshotPublisher();
+
+	//returns the rules and state of the board without the actor around it
+	const FMineSweeperBoard& GetBoard() const { return Board; }
+
+	//returns the moves of the current board, empty unless bRecordMoveLog is set
+	const FMineMoveLog& GetMoveLog() const { return MoveLog; }
+
+	//returns the seed the current board was generated with
+	UFUNCTION()
+	int32 GetBoardSeed() const { return BoardSeed; }
+
+	//returns the difficulty metrics of the current board, worked out on first use after generation. Empty before the first click.
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	FMineSweeperBoardStats GetBoardStats();
+
+	//returns the 64 bit hash of the board state, equal states have equal hashes. See FMineSweeperBoard::GetStateHash.
+	UFUNCTION(BlueprintPure, Category = "MineSweeper")
+	int64 GetBoardHash() const { return int64(Board.GetStateHash()); }
+
+	//returns the approximate number of bytes the last move put into the replicated board state
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	int32 GetLastMoveNetBytes() const { return LastMoveNetBytes; }
+
+	//returns the average of GetLastMoveNetBytes over all replicated moves since the stats were reset
+	UFUNCTION(BlueprintCallable, Category = "MineSweeper")
+	float GetAverageMoveNetBytes() const { return NumNetMoves > 0 ? float(double(TotalMoveNetBytes) / NumNetMoves) : 0.0f; }
+
+	//Starts the average of GetAverageMoveNetBytes over
+	void ResetNetStats() { TotalMoveNetBytes = 0; NumNetMoves = 0; }
+
+	//Moves and bytes since ResetNetStats, for the MineSweeper.Net.Report command
+	int32 GetNumNetMoves() const { return NumNetMoves; }
+	int64 GetTotalMoveNetBytes() const { return TotalMoveNetBytes; }
+
 protected:
 
+	//Generates the board if it is not already generated, keeping SafeIndex and its neighbours free of mines
 	UFUNCTION()
-	bool CheckAndGenerateBoard();
+	bool CheckAndGenerateBoard(int32 SafeIndex);
 
 	UFUNCTION()
 	int32 CalcIndex(int32 ColIndex, int32 RowIndex) const;
@@ -91,57 +259,200 @@ protected:
 	void Initialize();
 
 	UFUNCTION()
-	void HandleGameOverNative(int32 ClickedIndex);
+	void GenerateBoard(int32 SafeIndex);
 
-	UFUNCTION()
-	void RevealFieldNative(int32 ColIndex, int32 RowIndex);
+	//Number of mines the current settings ask for
+	int32 CalcPlannedMineCount() const;
 
-	UFUNCTION()
-	bool IsValidIndex(int32 ColIndex, int32 RowIndex) const;
+	//Shrinks the size settings until the board fits the budget of UMineSweeperSettings, ChangedProperty gives way first.
+	//Returns false if they had to shrink.
+	bool ClampToBoardBudget(FName ChangedProperty = NAME_None);
+
+	//Remembers that the field changed with the current move
+	void MarkFieldChanged(int32 Index);
+
+	//Takes the changes of the last move on the board
+	void MarkFieldsChanged(const TArray<int32>& Indices);
+
+	//Sends the changes of the current move to clients and listeners
+	void CommitChanges();
+
+	//Recreates one instance per field for the in world board, or removes them if it is turned off
+	void RebuildWorldBoard();
+
+	//Writes the custom data of the changed fields only. An empty array updates every instance.
+	void UpdateWorldBoard(const TArray<int32>& ChangedIndices);
+
+	//Fills the per instance custom data of one field
+	void UpdateWorldBoardInstance(int32 Index);
+
+	//Hands the cascade budget to the board before it reveals anything
+	void ApplyRevealBudget();
+
+	//Ticks the board while a cascade is pending and stops once it is done or dropped
+	void UpdateCascadeTicker();
+
+	//Reveals the next part of the pending cascade, returns false once there is nothing left
+	bool TickCascade(float DeltaTime);
+
+	//Logs how far the last reveal got through the cascade, replays cut it at the same field
+	void LogCascadeSteps();
+
+	//Server only. Packs all fields changed by the current move into the replicated board state.
+	void FlushNetChanges();
+
+	//Server only. Starts counting the replicated bytes of a new move for MineSweeper.Net.Report.
+	void BeginNetMove();
+
+	//Server only. Copies the game state of the board into the replicated properties.
+	void UpdateNetGameState();
+
+	//Client only. Hands the replicated game state to the board.
+	void ApplyNetGameState();
+
+	//Client only. Applies one replicated word to the local board arrays.
+	void ApplyNetWord(const FMineBoardNetWord& Word);
+
+	//Client only. Sizes the local board arrays for the replicated dimensions.
+	void EnsureClientArrays();
+
+	//Client only. Throws away the local board and starts over for the given epoch.
+	void ResetClientBoard(uint8 Epoch);
 
 	UFUNCTION()
-	void GenerateBoard();
+	void OnRep_BoardEpoch();
 
 	UFUNCTION()
-	int32 GetValue(int32 ColIndex, int32 RowIndex) const;
+	void OnRep_NetMineWords();
+
+	friend struct FMineBoardNetWord;
 
 protected:
 
 	
-	UPROPERTY(EditAnywhere)
+	UPROPERTY(EditAnywhere, Replicated)
 	int32 ColumnNum = 12;
 
-	UPROPERTY(EditAnywhere)
+	UPROPERTY(EditAnywhere, Replicated)
 	int32 RowNum = 12;
 
+	//Share of the fields that get a mine, rounded to a fixed mine count
 	UPROPERTY(EditAnywhere)
 	float MineChance = 0.1;
 
-	UPROPERTY()
-	int32 MineCount;
+	UPROPERTY(EditAnywhere, Replicated)
+	EMineSweeperTopology Topology = EMineSweeperTopology::Square8;
 
-	UPROPERTY()
-	uint32 bBoardGenerated : 1;
+	//Number of stacked layers of a Cube26 board, each with RowNum rows
+	UPROPERTY(EditAnywhere, Replicated, meta = (ClampMin = "1", EditCondition = "Topology == EMineSweeperTopology::Cube26"))
+	int32 LayerNum = 3;
 
-	UPROPERTY()
-	uint32 bGameOver : 1;
+	//New boards are generated again with other seeds until their difficulty is in range
+	UPROPERTY(EditAnywhere)
+	FMineSweeperDifficultyFilter DifficultyFilter;
 
-	UPROPERTY()
-	uint32 bHasWon : 1;
+	//Fixed seed for the mine layout, 0 picks a new random seed for every board
+	UPROPERTY(EditAnywhere, Category = "MoveLog")
+	int32 Seed = 0;
 
-	UPROPERTY()
-	int32 HitMineIndex;
+	//Keeps a compact log of all moves on the board that can be replayed with FMineReplay
+	UPROPERTY(EditAnywhere, Category = "MoveLog")
+	bool bRecordMoveLog = false;
 
-	UPROPERTY()
-	TArray<bool> FieldArray;
+	//Most fields a reveal cascade uncovers per frame, the rest spreads over the next frames. 0 reveals all of it with the click.
+	UPROPERTY(EditAnywhere, Category = "Cascade", meta = (ClampMin = "0"))
+	int32 CascadeFieldsPerFrame = 0;
 
-	UPROPERTY()
-	TArray<bool> RevealedArray;
+	//Most time in milliseconds a reveal cascade may take per frame, 0 for no limit
+	UPROPERTY(EditAnywhere, Category = "Cascade", meta = (ClampMin = "0"))
+	float CascadeMillisecondsPerFrame = 0.0f;
 
+	//The seed the current board was generated with
 	UPROPERTY()
-	TSet<int32> FlagedIndices;
+	int32 BoardSeed = 0;
 
-	UPROPERTY()
-	TSet<int32> Visited;
+	//Field the current board was generated around, guess free is checked from there
+	int32 FirstClickIndex = INDEX_NONE;
+
+	//Stats of the current board once asked for
+	TOptional<FMineBoardStats> CachedBoardStats;
+
+	//Saved through Serialize, FMineMoveLog is a plain struct of DetailPanelCore
+	FMineMoveLog MoveLog;
+
+	//Mines, revealed fields, flags and the game state. Saved and undone through Serialize.
+	FMineSweeperBoard Board;
+
+	//Game state of the board as the server sends it to clients
+	UPROPERTY(Replicated, Transient)
+	int32 NetMineCount = 0;
+
+	UPROPERTY(Replicated, Transient)
+	uint32 bNetBoardGenerated : 1;
+
+	UPROPERTY(Replicated, Transient)
+	uint32 bNetGameOver : 1;
+
+	UPROPERTY(Replicated, Transient)
+	uint32 bNetHasWon : 1;
+
+	UPROPERTY(Replicated, Transient)
+	int32 NetHitMineIndex = INDEX_NONE;
+
+	//Bumped on every new board so clients know to throw away their local state
+	UPROPERTY(ReplicatedUsing = OnRep_BoardEpoch)
+	uint8 BoardEpoch = 0;
+
+	//Revealed and flag state sent to clients as deltas
+	UPROPERTY(Replicated, Transient)
+	FMineBoardNetState NetBoardState;
+
+	//Mine layout bit packed, 32 fields per word. Stays empty until the game is over so clients can't peek.
+	UPROPERTY(ReplicatedUsing = OnRep_NetMineWords, Transient)
+	TArray<uint32> NetMineWords;
+
+	//Client only. Field numbers of the revealed fields as received from the server.
+	UPROPERTY(Transient)
+	TArray<int8> ClientFieldNumbers;
+
+	//Client only. The epoch the local board arrays belong to.
+	uint8 AppliedBoardEpoch = 0;
+
+	//Fields touched by the current move that still have to be replicated and broadcast
+	TSet<int32> PendingChangedFields;
+
+	//Set when the current move replaced the whole board
+	bool bPendingFullBoardChange = false;
+
+	FOnMineBoardChanged BoardChangedEvent;
+
+	TSharedPtr<FMineBoardSnapshotPublisher, ESPMode::ThreadSafe> SnapshotPublisher;
+
+	//Set while a cascade is pending. The core ticker runs in the editor as well, so details panel clicks spread too.
+	FTSTicker::FDelegateHandle CascadeTickerHandle;
+
+	UPROPERTY(VisibleAnywhere, Category = "WorldBoard")
+	TObjectPtr<USceneComponent> SceneRoot;
+
+	//One instance per field, laid out on the XY plane of the actor. Field state goes into the per instance custom data:
+	//[0] = 0 hidden, 1 revealed, 2 flagged, 3 mine, 4 crossed and [1] = the field number. Use a material that reads PerInstanceCustomData.
+	UPROPERTY(VisibleAnywhere, Category = "WorldBoard")
+	TObjectPtr<UInstancedStaticMeshComponent> BoardInstances;
+
+	//Shows the board in the level, off by default so boards only used from the details panel cost nothing
+	UPROPERTY(EditAnywhere, Category = "WorldBoard")
+	bool bShowWorldBoard = false;
+
+	//Distance between two fields of the in world board
+	UPROPERTY(EditAnywhere, Category = "WorldBoard", meta = (ClampMin = "1"))
+	float WorldFieldSize = 100.0f;
+
+	UPROPERTY(Transient)
+	int32 LastMoveNetBytes = 0;
+
+	int64 TotalMoveNetBytes = 0;
+	int32 NumNetMoves = 0;
 
+	//Size of the mine words filled since the last flush, they replicate once per board
+	int32 PendingMineWordBytes = 0;
 };
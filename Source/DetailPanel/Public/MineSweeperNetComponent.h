@@ -0,0 +1,27 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "MineSweeperNetComponent.generated.h"
+
+class AMineSweeperActor;
+
+//Add this to the player controller so clients can send their moves to the server.
+//A client does not own the board actor, so the server RPCs have to go through an actor it does own.
+UCLASS(ClassGroup = (MineSweeper), meta = (BlueprintSpawnableComponent))
+class DETAILPANEL_API UMineSweeperNetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UMineSweeperNetComponent(const FObjectInitializer& ObjectInitializer);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerClickOnField(AMineSweeperActor* Board, int32 ColIndex, int32 RowIndex);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerRightClickOnField(AMineSweeperActor* Board, int32 ColIndex, int32 RowIndex);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerResetBoard(AMineSweeperActor* Board);
+};
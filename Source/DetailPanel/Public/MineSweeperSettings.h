@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DeveloperSettings.h"
+#include "MineSweeperSettings.generated.h"
+
+//Project wide limits for minesweeper boards, under Project Settings > Game > MineSweeper.
+//Boards over the budget are shrunk when their size is edited and never generated, so a typo in a size can't take all the memory.
+UCLASS(Config = Game, DefaultConfig, meta = (DisplayName = "MineSweeper"))
+class DETAILPANEL_API UMineSweeperSettings : public UDeveloperSettings
+{
+	GENERATED_BODY()
+
+public:
+	UMineSweeperSettings();
+
+	//Most fields a board may have, all layers together. 0 for no limit. Boards played from a mapped file only count against MaxBoardMegabytes.
+	UPROPERTY(Config, EditAnywhere, Category = "Budget", meta = (ClampMin = "0"))
+	int64 MaxBoardFields = 16 * 1024 * 1024;
+
+	//Most memory in megabytes a board may need once it is generated, see FMineSweeperBoard::EstimateGeneratedSize. 0 for no limit.
+	UPROPERTY(Config, EditAnywhere, Category = "Budget", meta = (ClampMin = "0"))
+	int32 MaxBoardMegabytes = 1024;
+
+	//Binary board files of at least this many fields are played from their mapping when they are imported in a standalone game,
+	//instead of being loaded. Only a few bits per field are kept in memory then, see FMineSweeperBoard::OpenMapped. 0 never maps.
+	UPROPERTY(Config, EditAnywhere, Category = "Budget", meta = (ClampMin = "0"))
+	int64 MappedImportFields = 4 * 1024 * 1024;
+
+	//Largest number of fields both limits allow, MAX_int32 if there are none
+	int64 GetMaxBoardFields() const;
+
+	//Returns true if a board of NumFields fits the budget, OutReason says why it does not
+	static bool FitsBoardBudget(int64 NumFields, FString* OutReason = nullptr);
+
+	//Same for a board played from a mapped file, see FMineSweeperBoard::EstimateMappedSize
+	static bool FitsMappedBoardBudget(int64 NumFields, FString* OutReason = nullptr);
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MineBoardStats.h"
+#include "MineBoardTopology.h"
+#include "MineSweeperTypes.generated.h"
+
+//Reflected copies of the plain DetailPanelCore types, for properties, Blueprints and the details panel.
+//Values and fields match the core ones, convert at the actor.
+
+//See EMineBoardTopology
+UENUM(BlueprintType)
+enum class EMineSweeperTopology : uint8
+{
+	//The classic board, 8 neighbours
+	Square8 = uint8(EMineBoardTopology::Square8),
+	//Hexagonal fields with odd rows shifted half a field to the right, 6 neighbours
+	Hex6 = uint8(EMineBoardTopology::Hex6),
+	//Square fields where the edges wrap around to the opposite side, 8 neighbours
+	Torus8 = uint8(EMineBoardTopology::Torus8),
+	//Stacked layers of square fields, 26 neighbours. The layers are laid out below each other in rows.
+	Cube26 = uint8(EMineBoardTopology::Cube26),
+};
+
+inline EMineBoardTopology ToMineBoardTopology(EMineSweeperTopology Topology)
+{
+	return EMineBoardTopology(Topology);
+}
+
+inline EMineSweeperTopology ToMineSweeperTopology(EMineBoardTopology Topology)
+{
+	return EMineSweeperTopology(Topology);
+}
+
+//See FMineBoardStats
+USTRUCT(BlueprintType)
+struct DETAILPANEL_API FMineSweeperBoardStats
+{
+	GENERATED_BODY()
+
+	FMineSweeperBoardStats() = default;
+
+	FMineSweeperBoardStats(const FMineBoardStats& Stats)
+		: ThreeBV(Stats.ThreeBV)
+		, NumOpenings(Stats.NumOpenings)
+		, NumIslands(Stats.NumIslands)
+		, MineClustering(Stats.MineClustering)
+		, bGuessFreeChecked(Stats.bGuessFreeChecked)
+		, bGuessFree(Stats.bGuessFree)
+	{
+	}
+
+	//Fewest clicks that clear the board: one per opening plus one per numbered field no opening reveals
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MineSweeper")
+	int32 ThreeBV = 0;
+
+	//Connected areas of fields without mines around, a click on one opens all of it and its border
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MineSweeper")
+	int32 NumOpenings = 0;
+
+	//Connected groups of numbered fields no opening reveals, each has to be worked out on its own
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MineSweeper")
+	int32 NumIslands = 0;
+
+	//Share of mine neighbours that are mines themselves, relative to the mine density. 1 for an even spread, more for clumps.
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MineSweeper")
+	float MineClustering = 0.0f;
+
+	//Set if bGuessFree was worked out, it needs the first click
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MineSweeper")
+	bool bGuessFreeChecked = false;
+
+	//The board can be cleared from the first click without guessing
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "MineSweeper")
+	bool bGuessFree = false;
+};
+
+//See FMineDifficultyFilter
+USTRUCT(BlueprintType)
+struct DETAILPANEL_API FMineSweeperDifficultyFilter
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MineSweeper")
+	bool bEnabled = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MineSweeper", meta = (ClampMin = "0", EditCondition = "bEnabled"))
+	int32 MinThreeBV = 0;
+
+	//0 for no upper limit
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MineSweeper", meta = (ClampMin = "0", EditCondition = "bEnabled"))
+	int32 MaxThreeBV = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MineSweeper", meta = (EditCondition = "bEnabled"))
+	bool bRequireGuessFree = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "MineSweeper", meta = (ClampMin = "1", EditCondition = "bEnabled"))
+	int32 MaxAttempts = 64;
+
+	FMineDifficultyFilter ToCore() const
+	{
+		FMineDifficultyFilter Filter;
+		Filter.bEnabled = bEnabled;
+		Filter.MinThreeBV = MinThreeBV;
+		Filter.MaxThreeBV = MaxThreeBV;
+		Filter.bRequireGuessFree = bRequireGuessFree;
+		Filter.MaxAttempts = MaxAttempts;
+		return Filter;
+	}
+};
@@ -0,0 +1,14 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+//The board rules, move logs and board files. Only depends on Core so the DetailPanelCoreTests program can build it without the engine.
+public class DetailPanelCore : ModuleRules
+{
+	public DetailPanelCore(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] { "Core" });
+	}
+}
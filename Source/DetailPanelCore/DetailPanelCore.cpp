@@ -0,0 +1,11 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "DetailPanelCore.h"
+#include "Modules/ModuleManager.h"
+#include "MineSweeperMemory.h"
+
+IMPLEMENT_MODULE( FDefaultModuleImpl, DetailPanelCore );
+
+DEFINE_LOG_CATEGORY(DetailPanelCore)
+
+LLM_DEFINE_TAG(MineSweeper);
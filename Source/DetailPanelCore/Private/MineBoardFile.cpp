@@ -0,0 +1,753 @@
+#include "MineBoardFile.h"
+#include "DetailPanelCore.h"
+#include "MineSweeperBoard.h"
+#include "MineSweeperMemory.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+
+namespace MineBoardFile
+{
+	enum EStateFlags : uint8
+	{
+		StateGenerated = 1,
+		StateGameOver = 2,
+		StateHasWon = 4,
+	};
+
+	static constexpr int32 TileEntrySize = 16;
+
+	static bool GetPlaneBit(const FMineSweeperBoard& Board, FMineBoardFile::EPlane Plane, int32 Index)
+	{
+		switch (Plane)
+		{
+		case FMineBoardFile::EPlane::Mines:
+			return Board.IsMine(Index);
+		case FMineBoardFile::EPlane::Revealed:
+			return Board.IsRevealed(Index);
+		default:
+			return Board.IsFlagged(Index);
+		}
+	}
+
+	static void SerializeHeader(FArchive& Ar, FMineBoardFile::FHeader& Header, uint32& Magic, uint16& Version, uint16& HeaderSize, uint8& NumPlanes)
+	{
+		uint8 Topology = uint8(Header.Topology);
+		uint8 State = (Header.bGenerated ? StateGenerated : 0) | (Header.bGameOver ? StateGameOver : 0) | (Header.bHasWon ? StateHasWon : 0);
+		uint8 Compression = Header.bCompressed ? 1 : 0;
+
+		Ar << Magic;
+		Ar << Version;
+		Ar << HeaderSize;
+		Ar << Header.Dims.Columns;
+		Ar << Header.Dims.Rows;
+		Ar << Header.Dims.RowsPerLayer;
+		Ar << Topology;
+		Ar << State;
+		Ar << Compression;
+		Ar << NumPlanes;
+		Ar << Header.MineCount;
+		Ar << Header.Seed;
+		Ar << Header.HitMineIndex;
+		Ar << Header.RowsPerTile;
+		Ar << Header.NumTiles;
+		Ar << Header.NumFlags;
+		Ar << Header.TileTableOffset;
+		Ar << Header.NumHidden;
+		Ar << Header.NumWrongFlags;
+
+		if (Ar.IsLoading())
+		{
+			Header.Topology = EMineBoardTopology(Topology);
+			Header.bGenerated = (State & StateGenerated) != 0;
+			Header.bGameOver = (State & StateGameOver) != 0;
+			Header.bHasWon = (State & StateHasWon) != 0;
+			Header.bCompressed = Compression != 0;
+			Header.bHasCounts = Version >= 2;
+		}
+	}
+
+	static void SerializeTileEntry(FArchive& Ar, FMineBoardFile::FTileEntry& Entry)
+	{
+		Ar << Entry.Offset;
+		Ar << Entry.StoredSize;
+		Ar << Entry.RawSize;
+	}
+
+	//Reads one "key value" line of a text file into the header, returns false at the line that starts the board
+	static bool ParseTextHeaderLine(const FString& Line, FMineBoardFile::FHeader& Header, int64& OutTopology)
+	{
+		FString Key;
+		FString Value;
+		if (!Line.TrimStartAndEnd().Split(TEXT(" "), &Key, &Value))
+		{
+			Key = Line.TrimStartAndEnd();
+		}
+		Value.TrimStartInline();
+
+		if (Key == TEXT("board"))
+		{
+			return false;
+		}
+		else if (Key == TEXT("columns"))
+		{
+			Header.Dims.Columns = FCString::Atoi(*Value);
+		}
+		else if (Key == TEXT("rows"))
+		{
+			Header.Dims.Rows = FCString::Atoi(*Value);
+		}
+		else if (Key == TEXT("rowsperlayer"))
+		{
+			Header.Dims.RowsPerLayer = FCString::Atoi(*Value);
+		}
+		else if (Key == TEXT("topology"))
+		{
+			EMineBoardTopology Parsed;
+			OutTopology = LexTryParseString(Parsed, *Value) ? int64(Parsed) : int64(INDEX_NONE);
+		}
+		else if (Key == TEXT("mines"))
+		{
+			Header.MineCount = FCString::Atoi(*Value);
+		}
+		else if (Key == TEXT("seed"))
+		{
+			Header.Seed = FCString::Atoi(*Value);
+		}
+		else if (Key == TEXT("generated"))
+		{
+			Header.bGenerated = FCString::Atoi(*Value) != 0;
+		}
+		else if (Key == TEXT("gameover"))
+		{
+			Header.bGameOver = FCString::Atoi(*Value) != 0;
+		}
+		else if (Key == TEXT("won"))
+		{
+			Header.bHasWon = FCString::Atoi(*Value) != 0;
+		}
+		return true;
+	}
+
+	static TCHAR GetFieldChar(const FMineSweeperBoard& Board, int32 Index)
+	{
+		const bool bMine = Board.IsMine(Index);
+		if (Board.IsFlagged(Index))
+		{
+			return bMine ? TEXT('F') : TEXT('f');
+		}
+		if (!Board.IsRevealed(Index))
+		{
+			return bMine ? TEXT('*') : TEXT('.');
+		}
+		if (bMine)
+		{
+			return Index == Board.GetHitMineIndex() ? TEXT('X') : TEXT('x');
+		}
+
+		const int32 Number = Board.KnowsMines() ? Board.CalculateFieldNumber(Index) : 0;
+		return Number > 9 ? TEXT('+') : TCHAR(TEXT('0') + Number);
+	}
+}
+
+bool FMineBoardFile::IsTextFilename(const FString& Filename)
+{
+	return Filename.EndsWith(TEXT(".txt"), ESearchCase::IgnoreCase);
+}
+
+bool FMineBoardFile::Save(const FString& Filename, const FMineSweeperBoard& Board, int32 Seed, bool bCompress)
+{
+	using namespace MineBoardFile;
+
+	const FMineBoardDims& Dims = Board.GetDims();
+	if (Dims.Num() <= 0)
+	{
+		return false;
+	}
+
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("Could not open %s to write the board"), *Filename);
+		return false;
+	}
+
+	FHeader Header;
+	Header.Dims = Dims;
+	Header.Topology = Board.GetTopology();
+	Header.bGenerated = Board.IsGenerated() && Board.KnowsMines();
+	Header.bGameOver = Board.IsGameOver();
+	Header.bHasWon = Board.HasWon();
+	Header.bCompressed = bCompress;
+	Header.MineCount = Board.GetMineCount();
+	Header.Seed = Seed;
+	Header.HitMineIndex = Board.GetHitMineIndex();
+	Header.RowsPerTile = FMath::Clamp(FieldsPerTile / Dims.Columns, 1, Dims.Rows);
+	Header.NumTiles = FMath::DivideAndRoundUp(Dims.Rows, Header.RowsPerTile);
+	Header.bHasCounts = true;
+	Header.NumHidden = Dims.Num();
+
+	uint32 FileMagic = Magic;
+	uint16 FileVersion = Version;
+	uint16 FileHeaderSize = HeaderSize;
+	uint8 FileNumPlanes = NumPlanes;
+
+	//Written again at the end, once the tile table offset is known
+	SerializeHeader(*Writer, Header, FileMagic, FileVersion, FileHeaderSize, FileNumPlanes);
+
+	TArray<FTileEntry> TileTable;
+	TileTable.SetNum(Header.NumTiles * NumPlanes);
+
+	TArray<uint8> RawData;
+	TArray<uint8> CompressedData;
+	for (int32 TileIndex = 0; TileIndex < Header.NumTiles; TileIndex++)
+	{
+		const int32 FirstField = TileIndex * Header.RowsPerTile * Dims.Columns;
+		const int32 NumFields = FMath::Min(Header.RowsPerTile * Dims.Columns, Dims.Num() - FirstField);
+
+		for (int32 PlaneIndex = 0; PlaneIndex < NumPlanes; PlaneIndex++)
+		{
+			const EPlane Plane = EPlane(PlaneIndex);
+			RawData.Reset();
+			RawData.SetNumZeroed(FMath::DivideAndRoundUp(NumFields, 8));
+			for (int32 Bit = 0; Bit < NumFields; Bit++)
+			{
+				if (GetPlaneBit(Board, Plane, FirstField + Bit))
+				{
+					RawData[Bit >> 3] |= uint8(1 << (Bit & 7));
+
+					//The counters go into the header, so the file can be played without counting
+					if (Plane == EPlane::Revealed)
+					{
+						Header.NumHidden--;
+					}
+					else if (Plane == EPlane::Flags)
+					{
+						Header.NumFlags++;
+						Header.NumWrongFlags += Board.IsMine(FirstField + Bit) ? 0 : 1;
+					}
+				}
+			}
+
+			const uint8* StoredData = RawData.GetData();
+			int32 StoredSize = RawData.Num();
+
+			//Tiles that don't get smaller are kept raw, so they can be read from the mapping directly
+			if (bCompress)
+			{
+				int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, RawData.Num());
+				CompressedData.SetNumUninitialized(CompressedSize, false);
+				if (FCompression::CompressMemory(NAME_Zlib, CompressedData.GetData(), CompressedSize, RawData.GetData(), RawData.Num()) && CompressedSize < RawData.Num())
+				{
+					StoredData = CompressedData.GetData();
+					StoredSize = CompressedSize;
+				}
+			}
+
+			FTileEntry& Entry = TileTable[TileIndex * NumPlanes + PlaneIndex];
+			Entry.Offset = Writer->Tell();
+			Entry.StoredSize = StoredSize;
+			Entry.RawSize = RawData.Num();
+			Writer->Serialize(const_cast<uint8*>(StoredData), StoredSize);
+		}
+	}
+
+	Header.TileTableOffset = Writer->Tell();
+	for (FTileEntry& Entry : TileTable)
+	{
+		SerializeTileEntry(*Writer, Entry);
+	}
+
+	Writer->Seek(0);
+	SerializeHeader(*Writer, Header, FileMagic, FileVersion, FileHeaderSize, FileNumPlanes);
+
+	const bool bSuccess = Writer->Close() && !Writer->IsError();
+	if (!bSuccess)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("Could not write the board to %s"), *Filename);
+	}
+	return bSuccess;
+}
+
+bool FMineBoardFile::SaveText(const FString& Filename, const FMineSweeperBoard& Board, int32 Seed)
+{
+	const FMineBoardDims& Dims = Board.GetDims();
+
+	FString Text;
+	Text.Reserve(256 + (Dims.Columns + 1) * Dims.Rows);
+	Text += FString::Printf(TEXT("minesweeper %d\n"), Version);
+	Text += FString::Printf(TEXT("columns %d\n"), Dims.Columns);
+	Text += FString::Printf(TEXT("rows %d\n"), Dims.Rows);
+	Text += FString::Printf(TEXT("rowsperlayer %d\n"), Dims.RowsPerLayer);
+	Text += FString::Printf(TEXT("topology %s\n"), LexToString(Board.GetTopology()));
+	Text += FString::Printf(TEXT("mines %d\n"), Board.GetMineCount());
+	Text += FString::Printf(TEXT("seed %d\n"), Seed);
+	Text += FString::Printf(TEXT("generated %d\n"), (Board.IsGenerated() && Board.KnowsMines()) ? 1 : 0);
+	Text += FString::Printf(TEXT("gameover %d\n"), Board.IsGameOver() ? 1 : 0);
+	Text += FString::Printf(TEXT("won %d\n"), Board.HasWon() ? 1 : 0);
+	Text += TEXT("board\n");
+
+	for (int32 RowIndex = 0; RowIndex < Dims.Rows; RowIndex++)
+	{
+		for (int32 ColIndex = 0; ColIndex < Dims.Columns; ColIndex++)
+		{
+			Text.AppendChar(MineBoardFile::GetFieldChar(Board, Dims.ToIndex(ColIndex, RowIndex)));
+		}
+		Text.AppendChar(TEXT('\n'));
+	}
+
+	return FFileHelper::SaveStringToFile(Text, *Filename);
+}
+
+bool FMineBoardFile::Load(const FString& Filename, FMineSweeperBoard& OutBoard, int32& OutSeed)
+{
+	if (IsTextFilename(Filename))
+	{
+		return LoadText(Filename, OutBoard, OutSeed);
+	}
+
+	FMineBoardFileReader Reader;
+	if (!Reader.Open(Filename) || !Reader.ReadBoard(OutBoard))
+	{
+		return false;
+	}
+	OutSeed = Reader.GetHeader().Seed;
+	return true;
+}
+
+bool FMineBoardFile::ReadTextHeader(const FString& Filename, FHeader& OutHeader)
+{
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Reader)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("Could not read the board file %s"), *Filename);
+		return false;
+	}
+
+	//The keys come first and are short, there is no need to read the rows behind them
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(int32(FMath::Min<int64>(Reader->TotalSize(), MaxTextHeaderSize)));
+	Reader->Serialize(Bytes.GetData(), Bytes.Num());
+	if (Reader->IsError())
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("Could not read the board file %s"), *Filename);
+		return false;
+	}
+
+	FString Text;
+	FFileHelper::BufferToString(Text, Bytes.GetData(), Bytes.Num());
+	TArray<FString> Lines;
+	Text.ParseIntoArrayLines(Lines, false);
+
+	OutHeader = FHeader();
+	int64 Topology = int64(EMineBoardTopology::Square8);
+	bool bFoundBoard = false;
+	for (const FString& Line : Lines)
+	{
+		if (!MineBoardFile::ParseTextHeaderLine(Line, OutHeader, Topology))
+		{
+			bFoundBoard = true;
+			break;
+		}
+	}
+
+	if (!bFoundBoard || OutHeader.Dims.Columns <= 0 || OutHeader.Dims.Rows <= 0 || Topology == INDEX_NONE)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s is not a valid board file"), *Filename);
+		return false;
+	}
+	OutHeader.Topology = EMineBoardTopology(Topology);
+	if (OutHeader.Dims.RowsPerLayer <= 0)
+	{
+		OutHeader.Dims.RowsPerLayer = OutHeader.Dims.Rows;
+	}
+	return true;
+}
+
+bool FMineBoardFile::LoadText(const FString& Filename, FMineSweeperBoard& OutBoard, int32& OutSeed)
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Filename))
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("Could not read the board file %s"), *Filename);
+		return false;
+	}
+
+	FHeader Header;
+	int64 Topology = int64(EMineBoardTopology::Square8);
+	int32 LineIndex = 0;
+	while (LineIndex < Lines.Num() && MineBoardFile::ParseTextHeaderLine(Lines[LineIndex++], Header, Topology))
+	{
+	}
+
+	FMineBoardDims& Dims = Header.Dims;
+	const int32 MineCount = Header.MineCount;
+	const int32 Seed = Header.Seed;
+	const bool bGenerated = Header.bGenerated;
+	const bool bGameOver = Header.bGameOver;
+	const bool bHasWon = Header.bHasWon;
+
+	if (Dims.RowsPerLayer <= 0)
+	{
+		Dims.RowsPerLayer = Dims.Rows;
+	}
+	if (Dims.Columns <= 0 || Dims.Rows <= 0 || Topology == INDEX_NONE || Lines.Num() - LineIndex < Dims.Rows)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s is not a valid board file"), *Filename);
+		return false;
+	}
+
+	//Same limits as the binary header, before any field is allocated
+	if (int64(Dims.Columns) * Dims.Rows > MAX_int32 || MineCount < 0 || MineCount > Dims.Columns * Dims.Rows)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s has a broken header"), *Filename);
+		return false;
+	}
+
+	const int32 TotalFields = Dims.Num();
+	TArray<bool> Mines;
+	TArray<bool> Revealed;
+	TSet<int32> Flags;
+	Mines.Init(false, TotalFields);
+	Revealed.Init(false, TotalFields);
+	int32 HitMineIndex = INDEX_NONE;
+	int32 NumMines = 0;
+
+	for (int32 RowIndex = 0; RowIndex < Dims.Rows; RowIndex++)
+	{
+		const FString& Line = Lines[LineIndex + RowIndex];
+		for (int32 ColIndex = 0; ColIndex < Dims.Columns; ColIndex++)
+		{
+			const int32 Index = Dims.ToIndex(ColIndex, RowIndex);
+			const TCHAR Char = ColIndex < Line.Len() ? Line[ColIndex] : TEXT('.');
+
+			Mines[Index] = Char == TEXT('*') || Char == TEXT('F') || Char == TEXT('x') || Char == TEXT('X');
+			Revealed[Index] = FChar::IsDigit(Char) || Char == TEXT('+') || Char == TEXT('x') || Char == TEXT('X');
+			if (Char == TEXT('f') || Char == TEXT('F'))
+			{
+				Flags.Add(Index);
+			}
+			if (Char == TEXT('X'))
+			{
+				HitMineIndex = Index;
+			}
+			NumMines += Mines[Index];
+		}
+	}
+
+	if (!bGenerated)
+	{
+		Mines.Empty();
+		Revealed.Empty();
+		Flags.Empty();
+		NumMines = MineCount;
+	}
+	else if (bGameOver && !bHasWon)
+	{
+		//A lost game shows the whole board, flags included
+		Revealed.Init(true, TotalFields);
+	}
+
+	OutBoard.RestoreBoard(Dims, EMineBoardTopology(Topology), NumMines, MoveTemp(Mines), MoveTemp(Revealed), MoveTemp(Flags), HitMineIndex, bGameOver, bHasWon);
+	OutSeed = Seed;
+	return true;
+}
+
+FMineBoardFileReader::~FMineBoardFileReader()
+{
+	Close();
+}
+
+bool FMineBoardFileReader::Open(const FString& Filename)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (MappedFile.IsValid())
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+
+	if (MappedRegion.IsValid())
+	{
+		Data = MappedRegion->GetMappedPtr();
+		DataSize = MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		//Not every platform file can map, those read the whole file
+		MappedFile.Reset();
+		if (!FFileHelper::LoadFileToArray(FileBytes, *Filename))
+		{
+			UE_LOG(DetailPanelCore, Warning, TEXT("Could not read the board file %s"), *Filename);
+			return false;
+		}
+		Data = FileBytes.GetData();
+		DataSize = FileBytes.Num();
+	}
+
+	if (!ReadHeader(Filename))
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FMineBoardFileReader::Close()
+{
+	//The region has to go before the file it maps
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	FileBytes.Empty();
+	Data = nullptr;
+	DataSize = 0;
+	Header = FMineBoardFile::FHeader();
+	TileTable.Empty();
+
+	for (int32 PlaneIndex = 0; PlaneIndex < FMineBoardFile::NumPlanes; PlaneIndex++)
+	{
+		InflatedTiles[PlaneIndex] = INDEX_NONE;
+		InflatedData[PlaneIndex].Empty();
+	}
+}
+
+bool FMineBoardFileReader::ReadHeader(const FString& Filename)
+{
+	if (DataSize < FMineBoardFile::HeaderSize)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s is not a valid board file"), *Filename);
+		return false;
+	}
+
+	uint32 FileMagic = 0;
+	uint16 FileVersion = 0;
+	uint16 FileHeaderSize = 0;
+	uint8 FileNumPlanes = 0;
+	{
+		TArray<uint8> HeaderBytes(Data, FMineBoardFile::HeaderSize);
+		FMemoryReader HeaderReader(HeaderBytes);
+		MineBoardFile::SerializeHeader(HeaderReader, Header, FileMagic, FileVersion, FileHeaderSize, FileNumPlanes);
+	}
+
+	if (FileMagic != FMineBoardFile::Magic || FileNumPlanes != FMineBoardFile::NumPlanes || FileHeaderSize < FMineBoardFile::HeaderSize)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s is not a valid board file"), *Filename);
+		return false;
+	}
+	if (FileVersion > FMineBoardFile::Version)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s was written by a newer version (%d)"), *Filename, FileVersion);
+		return false;
+	}
+
+	const FMineBoardDims& Dims = Header.Dims;
+	const int64 TotalFields = int64(Dims.Columns) * Dims.Rows;
+	const int64 TileTableSize = int64(Header.NumTiles) * FMineBoardFile::NumPlanes * MineBoardFile::TileEntrySize;
+	if (Dims.Columns <= 0 || Dims.Rows <= 0 || Dims.RowsPerLayer <= 0 || TotalFields > MAX_int32
+		|| uint8(Header.Topology) > uint8(EMineBoardTopology::Cube26)
+		|| Header.RowsPerTile <= 0 || Header.NumTiles != FMath::DivideAndRoundUp(Dims.Rows, Header.RowsPerTile)
+		|| Header.TileTableOffset < FileHeaderSize || Header.TileTableOffset + TileTableSize > DataSize
+		|| Header.NumHidden < 0 || Header.NumHidden > TotalFields || Header.NumFlags < 0 || Header.NumFlags > TotalFields
+		|| Header.NumWrongFlags < 0 || Header.NumWrongFlags > Header.NumFlags)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s has a broken header"), *Filename);
+		return false;
+	}
+
+	TArray<uint8> TableBytes(Data + Header.TileTableOffset, int32(TileTableSize));
+	FMemoryReader TableReader(TableBytes);
+	TileTable.SetNum(Header.NumTiles * FMineBoardFile::NumPlanes);
+	for (int32 TileIndex = 0; TileIndex < Header.NumTiles; TileIndex++)
+	{
+		const int32 NumFields = FMath::Min(Header.RowsPerTile * Dims.Columns, Dims.Num() - TileIndex * Header.RowsPerTile * Dims.Columns);
+		for (int32 PlaneIndex = 0; PlaneIndex < FMineBoardFile::NumPlanes; PlaneIndex++)
+		{
+			FMineBoardFile::FTileEntry& Entry = TileTable[TileIndex * FMineBoardFile::NumPlanes + PlaneIndex];
+			MineBoardFile::SerializeTileEntry(TableReader, Entry);
+
+			if (Entry.RawSize != FMath::DivideAndRoundUp(NumFields, 8) || Entry.StoredSize <= 0 || Entry.Offset < FileHeaderSize || Entry.Offset + Entry.StoredSize > DataSize)
+			{
+				UE_LOG(DetailPanelCore, Warning, TEXT("%s has a broken tile table"), *Filename);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+const uint8* FMineBoardFileReader::GetTileData(FMineBoardFile::EPlane Plane, int32 TileIndex) const
+{
+	const int32 PlaneIndex = int32(Plane);
+	if (!IsOpen() || !TileTable.IsValidIndex(TileIndex * FMineBoardFile::NumPlanes + PlaneIndex))
+	{
+		return nullptr;
+	}
+
+	const FMineBoardFile::FTileEntry& Entry = TileTable[TileIndex * FMineBoardFile::NumPlanes + PlaneIndex];
+	if (Entry.StoredSize == Entry.RawSize)
+	{
+		return Data + Entry.Offset;
+	}
+
+	if (InflatedTiles[PlaneIndex] != TileIndex)
+	{
+		InflatedTiles[PlaneIndex] = INDEX_NONE;
+		InflatedData[PlaneIndex].SetNumUninitialized(Entry.RawSize, false);
+		if (!FCompression::UncompressMemory(NAME_Zlib, InflatedData[PlaneIndex].GetData(), Entry.RawSize, Data + Entry.Offset, Entry.StoredSize))
+		{
+			UE_LOG(DetailPanelCore, Warning, TEXT("Could not inflate tile %d of a board file"), TileIndex);
+			return nullptr;
+		}
+		InflatedTiles[PlaneIndex] = TileIndex;
+	}
+	return InflatedData[PlaneIndex].GetData();
+}
+
+bool FMineBoardFileReader::GetField(FMineBoardFile::EPlane Plane, int32 Index) const
+{
+	if (!IsOpen() || uint32(Index) >= uint32(Header.Dims.Num()))
+	{
+		return false;
+	}
+
+	const int32 TileFields = Header.RowsPerTile * Header.Dims.Columns;
+	const uint8* TileData = GetTileData(Plane, Index / TileFields);
+	const int32 Bit = Index % TileFields;
+	return TileData && (TileData[Bit >> 3] & (1 << (Bit & 7))) != 0;
+}
+
+bool FMineBoardFileReader::ReadBoard(FMineSweeperBoard& OutBoard)
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	const FMineBoardDims& Dims = Header.Dims;
+	const int32 TotalFields = Dims.Num();
+	const int32 TileFields = Header.RowsPerTile * Dims.Columns;
+
+	TArray<bool> Mines;
+	TArray<bool> Revealed;
+	TSet<int32> Flags;
+	if (Header.bGenerated)
+	{
+		Mines.SetNumUninitialized(TotalFields);
+		Revealed.SetNumUninitialized(TotalFields);
+
+		for (int32 TileIndex = 0; TileIndex < Header.NumTiles; TileIndex++)
+		{
+			const int32 FirstField = TileIndex * TileFields;
+			const int32 NumFields = FMath::Min(TileFields, TotalFields - FirstField);
+
+			const uint8* MineData = GetTileData(FMineBoardFile::EPlane::Mines, TileIndex);
+			const uint8* RevealedData = GetTileData(FMineBoardFile::EPlane::Revealed, TileIndex);
+			const uint8* FlagData = GetTileData(FMineBoardFile::EPlane::Flags, TileIndex);
+			if (!MineData || !RevealedData || !FlagData)
+			{
+				return false;
+			}
+
+			for (int32 Bit = 0; Bit < NumFields; Bit++)
+			{
+				const uint8 Mask = uint8(1 << (Bit & 7));
+				Mines[FirstField + Bit] = (MineData[Bit >> 3] & Mask) != 0;
+				Revealed[FirstField + Bit] = (RevealedData[Bit >> 3] & Mask) != 0;
+				if (FlagData[Bit >> 3] & Mask)
+				{
+					Flags.Add(FirstField + Bit);
+				}
+			}
+		}
+	}
+
+	OutBoard.RestoreBoard(Dims, Header.Topology, Header.MineCount, MoveTemp(Mines), MoveTemp(Revealed), MoveTemp(Flags), Header.HitMineIndex, Header.bGameOver, Header.bHasWon);
+	return true;
+}
+
+bool FMineMappedFields::Open(const FString& InFilename)
+{
+	if (!Reader.Open(InFilename))
+	{
+		return false;
+	}
+
+	const FMineBoardFile::FHeader& Header = Reader.GetHeader();
+	if (!Header.bGenerated)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s holds a board without mines, there is nothing to play"), *InFilename);
+		Reader.Close();
+		return false;
+	}
+
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	Filename = InFilename;
+	RevealedChanges.Init(false, Header.Dims.Num());
+	FlagChanges.Init(false, Header.Dims.Num());
+
+	if (!Header.bHasCounts)
+	{
+		return CountFields();
+	}
+	NumHidden = Header.NumHidden;
+	NumFlags = Header.NumFlags;
+	NumWrongFlags = Header.NumWrongFlags;
+	return true;
+}
+
+bool FMineMappedFields::CountFields()
+{
+	//The padding bits at the end of a tile are zero
+	const FMineBoardFile::FHeader& Header = Reader.GetHeader();
+	const int32 TotalFields = Header.Dims.Num();
+	const int32 TileFields = Header.RowsPerTile * Header.Dims.Columns;
+	NumHidden = TotalFields;
+	NumFlags = 0;
+	NumWrongFlags = 0;
+	for (int32 TileIndex = 0; TileIndex < Header.NumTiles; TileIndex++)
+	{
+		const int32 NumBytes = FMath::DivideAndRoundUp(FMath::Min(TileFields, TotalFields - TileIndex * TileFields), 8);
+		const uint8* MineData = Reader.GetTileData(FMineBoardFile::EPlane::Mines, TileIndex);
+		const uint8* RevealedData = Reader.GetTileData(FMineBoardFile::EPlane::Revealed, TileIndex);
+		const uint8* FlagData = Reader.GetTileData(FMineBoardFile::EPlane::Flags, TileIndex);
+		if (!MineData || !RevealedData || !FlagData)
+		{
+			Reader.Close();
+			return false;
+		}
+
+		for (int32 Byte = 0; Byte < NumBytes; Byte++)
+		{
+			NumHidden -= FMath::CountBits(RevealedData[Byte]);
+			NumFlags += FMath::CountBits(FlagData[Byte]);
+			NumWrongFlags += FMath::CountBits(uint8(FlagData[Byte] & ~MineData[Byte]));
+		}
+	}
+	return true;
+}
+
+void FMineMappedFields::Reveal(int32 Index)
+{
+	if (!IsRevealed(Index))
+	{
+		RevealedChanges[Index] = true;
+		NumHidden--;
+	}
+}
+
+void FMineMappedFields::SetFlag(int32 Index, bool bFlagged)
+{
+	if (IsFlagged(Index) != bFlagged)
+	{
+		FlagChanges[Index] = !FlagChanges[Index];
+		const int32 Delta = bFlagged ? 1 : -1;
+		NumFlags += Delta;
+		NumWrongFlags += IsMine(Index) ? 0 : Delta;
+	}
+}
@@ -0,0 +1,329 @@
+#include "MineMoveLog.h"
+#include "DetailPanelCore.h"
+#include "Misc/FileHelper.h"
+#include "Algo/BinarySearch.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void FMineMoveLog::Begin(int32 InColumnNum, int32 InRowNum, int32 InLayerNum, EMineBoardTopology InTopology, float InMineChance, int32 InSeed)
+{
+	Reset();
+	ColumnNum = InColumnNum;
+	RowNum = InRowNum;
+	LayerNum = InLayerNum;
+	Topology = InTopology;
+	MineChance = InMineChance;
+	Seed = InSeed;
+}
+
+void FMineMoveLog::Reset()
+{
+	ColumnNum = 0;
+	RowNum = 0;
+	LayerNum = 1;
+	Topology = EMineBoardTopology::Square8;
+	MineChance = 0.0f;
+	Seed = 0;
+	NumMoves = 0;
+	Data.Reset();
+}
+
+void FMineMoveLog::Append(EMineMoveType Type, int32 FieldIndex)
+{
+	check(Type != EMineMoveType::Cascade);
+	WriteEntry(Type, FieldIndex);
+	NumMoves++;
+}
+
+void FMineMoveLog::AppendCascade(int32 NumSteps)
+{
+	WriteEntry(EMineMoveType::Cascade, NumSteps);
+}
+
+void FMineMoveLog::WriteEntry(EMineMoveType Type, int32 Value)
+{
+	check(Value >= 0);
+
+	uint32 Entry = (uint32(Value) << 2) | uint32(Type);
+	while (Entry >= 0x80)
+	{
+		Data.Add(uint8(Entry | 0x80));
+		Entry >>= 7;
+	}
+	Data.Add(uint8(Entry));
+}
+
+bool FMineMoveLog::IsValid() const
+{
+	if (ColumnNum <= 0 || RowNum <= 0 || LayerNum <= 0 || NumMoves < 0 || !(MineChance >= 0.0f && MineChance <= 1.0f))
+	{
+		return false;
+	}
+	if (Topology != EMineBoardTopology::Square8 && Topology != EMineBoardTopology::Hex6 && Topology != EMineBoardTopology::Torus8 && Topology != EMineBoardTopology::Cube26)
+	{
+		return false;
+	}
+	if (Topology != EMineBoardTopology::Cube26 && LayerNum != 1)
+	{
+		return false;
+	}
+	return int64(ColumnNum) * RowNum * LayerNum <= MAX_int32;
+}
+
+FMineBoardDims FMineMoveLog::GetDims() const
+{
+	FMineBoardDims Dims;
+	Dims.Columns = ColumnNum;
+	Dims.Rows = RowNum * LayerNum;
+	Dims.RowsPerLayer = RowNum;
+	return Dims;
+}
+
+bool FMineMoveLog::ReadMove(int32& ByteOffset, EMineMoveType& OutType, int32& OutFieldIndex) const
+{
+	uint32 Value = 0;
+	int32 Shift = 0;
+	while (ByteOffset < Data.Num() && Shift < 35)
+	{
+		const uint8 Byte = Data[ByteOffset++];
+		Value |= uint32(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			OutType = EMineMoveType(Value & 0x3);
+			OutFieldIndex = int32(Value >> 2);
+			return true;
+		}
+		Shift += 7;
+	}
+	return false;
+}
+
+FArchive& operator<<(FArchive& Ar, FMineMoveLog& Log)
+{
+	int32 Version = FMineMoveLog::Version;
+	Ar << Version;
+	if (Ar.IsLoading() && Version != FMineMoveLog::Version)
+	{
+		Ar.SetError();
+		return Ar;
+	}
+
+	Ar << Log.ColumnNum;
+	Ar << Log.RowNum;
+	Ar << Log.LayerNum;
+	Ar << Log.Topology;
+	Ar << Log.MineChance;
+	Ar << Log.Seed;
+	Ar << Log.NumMoves;
+	Ar << Log.Data;
+	return Ar;
+}
+
+bool FMineMoveLog::SaveToFile(const FString& Filename) const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	Writer << const_cast<FMineMoveLog&>(*this);
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool FMineMoveLog::LoadFromFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Bytes);
+	Reader << *this;
+	if (Reader.IsError())
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s is not a move log of version %d"), *Filename, FMineMoveLog::Version);
+		Reset();
+		return false;
+	}
+	if (!IsValid())
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("%s has a broken header, %d x %d x %d fields"), *Filename, ColumnNum, RowNum, LayerNum);
+		Reset();
+		return false;
+	}
+	return true;
+}
+
+FMineReplay::FMineReplay(const FMineMoveLog& InLog, int32 InKeyframeInterval)
+	: Log(InLog)
+	, KeyframeInterval(FMath::Max(1, InKeyframeInterval))
+	, bValid(InLog.IsValid())
+{
+	if (!bValid)
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("Not replaying a move log of %d x %d x %d fields"), Log.ColumnNum, Log.RowNum, Log.LayerNum);
+		return;
+	}
+	Restart();
+}
+
+void FMineReplay::Restart()
+{
+	//Same seed, size and chance give the same mines as the recorded board once the first click is replayed
+	const FMineBoardDims Dims = Log.GetDims();
+	Board.Reset(Dims, Log.Topology, FMineSweeperBoard::CalcMineCount(Log.MineChance, Dims.Num()));
+
+	MoveIndex = 0;
+	ByteOffset = 0;
+
+	if (Keyframes.Num() == 0)
+	{
+		AddKeyframe();
+	}
+}
+
+bool FMineReplay::Step()
+{
+	EMineMoveType Type;
+	int32 FieldIndex;
+	if (!bValid)
+	{
+		return false;
+	}
+
+	//Cascade parts before the first move come from a log that was cut in the middle, they belong to nothing here
+	do
+	{
+		if (!Log.ReadMove(ByteOffset, Type, FieldIndex))
+		{
+			return false;
+		}
+	}
+	while (Type == EMineMoveType::Cascade);
+
+	if (!Board.IsValidIndex(FieldIndex))
+	{
+		UE_LOG(DetailPanelCore, Warning, TEXT("Move %d of the log is on field %d, outside the board. Stopping the replay there."), MoveIndex, FieldIndex);
+		ByteOffset = Log.Data.Num();
+		return false;
+	}
+
+	//A click or chord that left fields pending is followed by the part of the cascade it revealed itself
+	int32 NextOffset = ByteOffset;
+	EMineMoveType NextType;
+	int32 NumSteps;
+	if (Type != EMineMoveType::Flag && Log.ReadMove(NextOffset, NextType, NumSteps) && NextType == EMineMoveType::Cascade)
+	{
+		ByteOffset = NextOffset;
+		Board.SetRevealStepLimit(FMath::Max(NumSteps, 1));
+	}
+
+	//The same calls AMineSweeperActor makes for the moves, minus everything around the board
+	ChangedIndices.Reset();
+	switch (Type)
+	{
+	case EMineMoveType::Click:
+		if (!Board.IsGenerated())
+		{
+			FirstClickIndex = FieldIndex;
+			Board.Generate(FieldIndex, Log.Seed);
+		}
+		Board.Click(FieldIndex, ChangedIndices);
+		break;
+	case EMineMoveType::Flag:
+		Board.ToggleFlag(FieldIndex, ChangedIndices);
+		break;
+	case EMineMoveType::Chord:
+		Board.Chord(FieldIndex, ChangedIndices);
+		break;
+	default:
+		break;
+	}
+	Board.SetRevealStepLimit(0);
+
+	ContinueCascades();
+
+	//A keyframe can't hold a pending cascade, the next one waits until it finished
+	MoveIndex++;
+	if (MoveIndex - Keyframes.Last().MoveIndex >= KeyframeInterval && !Board.HasPendingReveal())
+	{
+		AddKeyframe();
+	}
+	return true;
+}
+
+void FMineReplay::ContinueCascades()
+{
+	EMineMoveType Type;
+	int32 NumSteps;
+	int32 NextOffset = ByteOffset;
+	while (Log.ReadMove(NextOffset, Type, NumSteps) && Type == EMineMoveType::Cascade)
+	{
+		ByteOffset = NextOffset;
+		if (NumSteps > 0)
+		{
+			Board.SetRevealStepLimit(NumSteps);
+			Board.ContinueReveal(ChangedIndices);
+			Board.SetRevealStepLimit(0);
+		}
+	}
+}
+
+void FMineReplay::StepToEnd()
+{
+	while (Step())
+	{
+	}
+}
+
+void FMineReplay::SeekTo(int32 TargetMoveIndex)
+{
+	if (!bValid)
+	{
+		return;
+	}
+
+	TargetMoveIndex = FMath::Clamp(TargetMoveIndex, 0, Log.NumMoves);
+
+	//Going forward from where we are is never worse than going back to a keyframe before it
+	if (TargetMoveIndex < MoveIndex || TargetMoveIndex - MoveIndex > KeyframeInterval)
+	{
+		const int32 KeyframeIndex = Algo::UpperBoundBy(Keyframes, TargetMoveIndex, &FKeyframe::MoveIndex) - 1;
+		const FKeyframe& Keyframe = Keyframes[FMath::Max(KeyframeIndex, 0)];
+		if (Keyframe.MoveIndex > MoveIndex || TargetMoveIndex < MoveIndex)
+		{
+			RestoreKeyframe(Keyframe);
+		}
+	}
+
+	while (MoveIndex < TargetMoveIndex && Step())
+	{
+	}
+}
+
+void FMineReplay::AddKeyframe()
+{
+	FKeyframe& Keyframe = Keyframes.AddDefaulted_GetRef();
+	Keyframe.MoveIndex = MoveIndex;
+	Keyframe.ByteOffset = ByteOffset;
+	Keyframe.bBoardGenerated = Board.IsGenerated();
+	Keyframe.RevealedArray = Board.GetRevealed();
+	Keyframe.FlagedIndices = Board.GetFlags();
+	Keyframe.HitMineIndex = Board.GetHitMineIndex();
+	Keyframe.bGameOver = Board.IsGameOver();
+	Keyframe.bHasWon = Board.HasWon();
+}
+
+void FMineReplay::RestoreKeyframe(const FKeyframe& Keyframe)
+{
+	if (!Keyframe.bBoardGenerated)
+	{
+		Restart();
+		return;
+	}
+	if (!Board.IsGenerated())
+	{
+		Board.Generate(FirstClickIndex, Log.Seed);
+	}
+	Board.RestoreProgress(Keyframe.RevealedArray, Keyframe.FlagedIndices, Keyframe.HitMineIndex, Keyframe.bGameOver, Keyframe.bHasWon);
+	MoveIndex = Keyframe.MoveIndex;
+	ByteOffset = Keyframe.ByteOffset;
+}
@@ -0,0 +1,1201 @@
+#include "MineSweeperBoard.h"
+#include "MineSweeperMemory.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+
+namespace MineSweeperBoard
+{
+	//Fields taken from the cascade between two looks at the clock
+	static constexpr int32 FieldsPerTimeCheck = 1024;
+
+	//Fields in one band of rows the zero regions are labeled in at the same time
+	static constexpr int32 FieldsPerLabelBand = 64 * 1024;
+
+	//Mines and revealed 2, mine candidates 4, zero region labels 4, region lists about 8, cascade stack 4, bit arrays 1
+	static constexpr int64 PeakBytesPerField = 23;
+
+	//Cascade stack 4, the visited bit and the two change bits round up to 1
+	static constexpr int64 PeakMappedBytesPerField = 5;
+
+	enum EHashPlane : uint8
+	{
+		HashMine,
+		HashRevealed,
+		HashFlag,
+		HashMineCount,
+		HashSize,
+		HashLayers,
+	};
+
+	//Zobrist keys come from SplitMix64 over the value and its plane, so huge boards need no key table
+	static FORCEINLINE uint64 HashKey(uint64 Value, EHashPlane Plane)
+	{
+		uint64 Key = Value * 8 + Plane + 0x9E3779B97F4A7C15ull;
+		Key = (Key ^ (Key >> 30)) * 0xBF58476D1CE4E5B9ull;
+		Key = (Key ^ (Key >> 27)) * 0x94D049BB133111EBull;
+		return Key ^ (Key >> 31);
+	}
+}
+
+struct FMineSweeperBoard::FArrayFieldAccess
+{
+	static constexpr bool bHasZeroRegions = true;
+
+	FMineSweeperBoard& Board;
+
+	FORCEINLINE bool IsRevealed(int32 Index) const { return Board.Revealed[Index]; }
+	FORCEINLINE bool IsFlagged(int32 Index) const { return Board.Flags.Contains(Index); }
+	FORCEINLINE void Reveal(int32 Index) const { Board.Revealed[Index] = true; }
+};
+
+//No zero regions, they would take more memory than the mapping saves
+struct FMineSweeperBoard::FMappedFieldAccess
+{
+	static constexpr bool bHasZeroRegions = false;
+
+	FMineMappedFields& Fields;
+
+	FORCEINLINE bool IsRevealed(int32 Index) const { return Fields.IsRevealed(Index); }
+	FORCEINLINE bool IsFlagged(int32 Index) const { return Fields.IsFlagged(Index); }
+	FORCEINLINE void Reveal(int32 Index) const { Fields.Reveal(Index); }
+};
+
+void FMineSweeperBoard::Reset(const FMineBoardDims& InDims, EMineBoardTopology InTopology, int32 InMineCount)
+{
+	Dims = InDims;
+	Topology = InTopology;
+	MineCount = FMath::Clamp(InMineCount, 0, Dims.Num());
+	HitMineIndex = INDEX_NONE;
+	bGenerated = false;
+	bGameOver = false;
+	bHasWon = false;
+	Mines.Empty();
+	Revealed.Empty();
+	Flags.Empty();
+	MappedFields.Reset();
+	CancelReveal();
+	ResetZeroRegions();
+	RecalculateStateHash();
+}
+
+bool FMineSweeperBoard::OpenMapped(const FString& Filename)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	TUniquePtr<FMineMappedFields> NewFields = MakeUnique<FMineMappedFields>();
+	if (!NewFields->Open(Filename))
+	{
+		return false;
+	}
+
+	//Only the state of the header is taken, the fields stay in the file
+	const FMineBoardFile::FHeader& Header = NewFields->GetHeader();
+	Reset(Header.Dims, Header.Topology, Header.MineCount);
+	MappedFields = MoveTemp(NewFields);
+	HitMineIndex = IsValidIndex(Header.HitMineIndex) ? Header.HitMineIndex : INDEX_NONE;
+	bGenerated = true;
+	bGameOver = Header.bGameOver;
+	bHasWon = Header.bHasWon;
+	return true;
+}
+
+void FMineSweeperBoard::Generate(int32 SafeIndex, int32 InSeed)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	const int32 TotalFields = Dims.Num();
+	MappedFields.Reset();
+	Mines.Init(false, TotalFields);
+	Revealed.Init(false, TotalFields);
+	Flags.Empty();
+	CancelReveal();
+
+	FRandomStream RandomStream(InSeed);
+
+	//The clicked field and its neighbours stay free, the mines go on a random pick of the rest
+	TBitArray<> SafeFields(false, TotalFields);
+	if (IsValidIndex(SafeIndex))
+	{
+		SafeFields[SafeIndex] = true;
+		DispatchMineTopology(Topology, [&](auto Policy)
+		{
+			decltype(Policy)::ForEachNeighbour(Dims, SafeIndex % Dims.Columns, SafeIndex / Dims.Columns, [&SafeFields](int32, int32, int32 NeighbourIndex)
+			{
+				SafeFields[NeighbourIndex] = true;
+			});
+		});
+	}
+
+	TArray<int32> Candidates;
+	Candidates.Reserve(TotalFields);
+	for (int32 i = 0; i < TotalFields; ++i)
+	{
+		if (!SafeFields[i])
+		{
+			Candidates.Add(i);
+		}
+	}
+
+	//Partial shuffle, only as many draws as there are mines
+	MineCount = FMath::Min(MineCount, Candidates.Num());
+	for (int32 i = 0; i < MineCount; ++i)
+	{
+		Candidates.Swap(i, RandomStream.RandRange(i, Candidates.Num() - 1));
+		Mines[Candidates[i]] = true;
+	}
+
+	bGenerated = true;
+	RecalculateStateHash();
+	BuildZeroRegions();
+}
+
+bool FMineSweeperBoard::CanClick(int32 Index) const
+{
+	//Don't handle left click on a flaged tile
+	return !bGameOver && IsValidIndex(Index) && !IsFlagged(Index);
+}
+
+void FMineSweeperBoard::Click(int32 Index, TArray<int32>& OutChangedIndices)
+{
+	if (!CanClick(Index))
+	{
+		return;
+	}
+
+	//The first click places the mines around it, so it never hits one
+	if (!bGenerated)
+	{
+		Generate(Index, FMath::RandRange(1, MAX_int32));
+	}
+
+	if (IsMine(Index))
+	{
+		EndGame(Index, OutChangedIndices);
+	}
+	else
+	{
+		RevealFields(MakeArrayView(&Index, 1), OutChangedIndices);
+	}
+}
+
+bool FMineSweeperBoard::CanToggleFlag(int32 Index) const
+{
+	//Nothing to flag before the first click placed the mines
+	return !bGameOver && bGenerated && IsValidIndex(Index);
+}
+
+void FMineSweeperBoard::ToggleFlag(int32 Index, TArray<int32>& OutChangedIndices)
+{
+	if (!CanToggleFlag(Index))
+	{
+		return;
+	}
+
+	if (IsFlagged(Index))
+	{
+		SetFlag(Index, false);
+	}
+	else if (GetNumFlags() < MineCount)
+	{
+		SetFlag(Index, true);
+	}
+	else
+	{
+		//All flags are placed, nothing changes
+		return;
+	}
+
+	OutChangedIndices.Add(Index);
+	CheckAndUpdateHasWon();
+}
+
+void FMineSweeperBoard::SetFlag(int32 Index, bool bFlagged)
+{
+	if (MappedFields)
+	{
+		MappedFields->SetFlag(Index, bFlagged);
+	}
+	else if (bFlagged)
+	{
+		Flags.Add(Index);
+	}
+	else
+	{
+		Flags.Remove(Index);
+	}
+	UpdateRegionFlags(Index, bFlagged ? 1 : -1);
+	StateHash ^= MineSweeperBoard::HashKey(Index, MineSweeperBoard::HashFlag);
+}
+
+bool FMineSweeperBoard::CanChord(int32 Index) const
+{
+	if (bGameOver || !KnowsMines() || !IsRevealed(Index))
+	{
+		return false;
+	}
+
+	const int32 Value = CalculateFieldNumber(Index);
+	return Value > 0 && CountNeighbourFlags(Index) == Value;
+}
+
+int32 FMineSweeperBoard::CountNeighbourFlags(int32 Index) const
+{
+	int32 FlagCount = 0;
+	DispatchMineTopology(Topology, [&](auto Policy)
+	{
+		decltype(Policy)::ForEachNeighbour(Dims, Index % Dims.Columns, Index / Dims.Columns, [&](int32, int32, int32 NeighbourIndex)
+		{
+			FlagCount += IsFlagged(NeighbourIndex) ? 1 : 0;
+		});
+	});
+	return FlagCount;
+}
+
+void FMineSweeperBoard::Chord(int32 Index, TArray<int32>& OutChangedIndices)
+{
+	if (!CanChord(Index))
+	{
+		return;
+	}
+
+	DispatchMineTopology(Topology, [&](auto Policy)
+	{
+		using TTopology = decltype(Policy);
+
+		TArray<int32, TInlineAllocator<TTopology::NumNeighbours>> StartIndices;
+		int32 HitIndex = INDEX_NONE;
+		TTopology::ForEachNeighbour(Dims, Index % Dims.Columns, Index / Dims.Columns, [&](int32, int32, int32 NeighbourIndex)
+		{
+			if (!IsFlagged(NeighbourIndex))
+			{
+				//A wrong flag means one of the neighbours is a mine
+				if (IsMine(NeighbourIndex))
+				{
+					HitIndex = NeighbourIndex;
+				}
+				StartIndices.Add(NeighbourIndex);
+			}
+		});
+
+		if (HitIndex != INDEX_NONE)
+		{
+			EndGame(HitIndex, OutChangedIndices);
+		}
+		else
+		{
+			RevealFields(StartIndices, OutChangedIndices);
+		}
+	});
+}
+
+bool FMineSweeperBoard::CheckAndUpdateHasWon()
+{
+	//Clients can't check without the mines, they get the result from the server
+	if (!KnowsMines())
+	{
+		return bHasWon;
+	}
+
+	//A mapped board keeps the counts up to date, so it doesn't have to read the file
+	if (!bGameOver && MappedFields)
+	{
+		if (MappedFields->GetNumFlags() == MineCount && MappedFields->GetNumHidden() == MineCount && MappedFields->GetNumWrongFlags() == 0)
+		{
+			bGameOver = true;
+			bHasWon = true;
+		}
+		return bHasWon;
+	}
+
+	if (!bGameOver && Flags.Num() == MineCount)
+	{
+		int32 HiddenCount = 0;
+		for (const bool bRevealed : Revealed)
+		{
+			HiddenCount += bRevealed ? 0 : 1;
+		}
+
+		if (HiddenCount == MineCount)
+		{
+			bool bAllFlagsRight = true;
+			for (const int32 FlagIndex : Flags)
+			{
+				bAllFlagsRight &= Mines[FlagIndex];
+			}
+			if (bAllFlagsRight)
+			{
+				bGameOver = true;
+				bHasWon = true;
+			}
+			return bAllFlagsRight;
+		}
+	}
+	return bHasWon;
+}
+
+int32 FMineSweeperBoard::CalculateFieldNumber(int32 Index) const
+{
+	if (IsMine(Index))
+	{
+		return -1;
+	}
+
+	return DispatchMineTopology(Topology, [&](auto Policy)
+	{
+		return CountNeighbourMines<decltype(Policy)>(Index % Dims.Columns, Index / Dims.Columns);
+	});
+}
+
+bool FMineSweeperBoard::IsCrossed(int32 Index) const
+{
+	return IsFlagged(Index) && (MappedFields || Mines.IsValidIndex(Index)) && !IsMine(Index)
+		|| (Index == HitMineIndex && Index != INDEX_NONE);
+}
+
+void FMineSweeperBoard::EndGame(int32 HitIndex, TArray<int32>& OutChangedIndices)
+{
+	CancelReveal();
+	bGameOver = true;
+	HitMineIndex = HitIndex;
+
+	//Writing every field would change a bit for every field of the file, IsRevealed shows the lost board revealed instead
+	if (MappedFields)
+	{
+		return;
+	}
+
+	OutChangedIndices.Reserve(OutChangedIndices.Num() + Revealed.Num());
+	for (int32 i = 0; i < Revealed.Num(); i++)
+	{
+		if (!Revealed[i])
+		{
+			Revealed[i] = true;
+			StateHash ^= MineSweeperBoard::HashKey(i, MineSweeperBoard::HashRevealed);
+		}
+		OutChangedIndices.Add(i);
+	}
+}
+
+void FMineSweeperBoard::RecalculateStateHash()
+{
+	using namespace MineSweeperBoard;
+
+	StateHash = HashKey(uint64(uint32(Dims.Columns)) | (uint64(uint32(Dims.Rows)) << 32), HashSize)
+		^ HashKey(uint64(uint32(Dims.RowsPerLayer)) | (uint64(Topology) << 32), HashLayers)
+		^ HashKey(uint32(MineCount), HashMineCount);
+
+	for (int32 Index = 0; Index < Mines.Num(); Index++)
+	{
+		StateHash ^= Mines[Index] ? HashKey(Index, HashMine) : 0;
+	}
+	for (int32 Index = 0; Index < Revealed.Num(); Index++)
+	{
+		StateHash ^= Revealed[Index] ? HashKey(Index, HashRevealed) : 0;
+	}
+	for (const int32 FlagIndex : Flags)
+	{
+		StateHash ^= HashKey(FlagIndex, HashFlag);
+	}
+}
+
+void FMineSweeperBoard::SetRevealBudget(int32 InMaxRevealFields, double InMaxRevealSeconds)
+{
+	MaxRevealFields = FMath::Max(InMaxRevealFields, 0);
+	MaxRevealSeconds = FMath::Max(InMaxRevealSeconds, 0.0);
+}
+
+void FMineSweeperBoard::SetRevealStepLimit(int32 InMaxRevealSteps)
+{
+	MaxRevealSteps = FMath::Max(InMaxRevealSteps, 0);
+}
+
+void FMineSweeperBoard::RevealFields(TArrayView<const int32> StartIndices, TArray<int32>& OutChangedIndices)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	//Boards that were loaded or restored get their regions with the first cascade, mapped boards go without
+	if (!MappedFields && ZeroRegions.Num() != Dims.Num())
+	{
+		BuildZeroRegions();
+	}
+
+	if (PendingReveal.Num() == 0)
+	{
+		PendingVisited.Init(false, Dims.Num());
+		PendingRegions.Init(false, RegionFlagCounts.Num());
+	}
+
+	//Start fields are queued even if a running cascade already has them, so they are revealed by this move
+	for (const int32 StartIndex : StartIndices)
+	{
+		PendingVisited[StartIndex] = true;
+		PendingReveal.Add(StartIndex);
+	}
+
+	ContinueReveal(OutChangedIndices);
+}
+
+void FMineSweeperBoard::ContinueReveal(TArray<int32>& OutChangedIndices)
+{
+	LastRevealSteps = 0;
+	if (PendingReveal.Num() == 0)
+	{
+		return;
+	}
+
+	DispatchMineTopology(Topology, [&](auto Policy)
+	{
+		if (MappedFields)
+		{
+			RevealPendingKernel<decltype(Policy)>(FMappedFieldAccess{ *MappedFields }, OutChangedIndices);
+		}
+		else
+		{
+			RevealPendingKernel<decltype(Policy)>(FArrayFieldAccess{ *this }, OutChangedIndices);
+		}
+	});
+
+	if (PendingReveal.Num() == 0)
+	{
+		PendingVisited.Empty();
+		PendingRegions.Empty();
+	}
+
+	//The last reveal can win the game as well as the last flag, and servers have nobody else to check it
+	CheckAndUpdateHasWon();
+}
+
+void FMineSweeperBoard::CancelReveal()
+{
+	PendingReveal.Empty();
+	PendingVisited.Empty();
+	PendingRegions.Empty();
+}
+
+template<typename TTopology, typename TFieldAccess>
+void FMineSweeperBoard::RevealPendingKernel(TFieldAccess Fields, TArray<int32>& OutChangedIndices)
+{
+	//Explicit stack instead of recursion, big empty areas would overflow the call stack
+	const double Deadline = MaxRevealSeconds > 0.0 ? FPlatformTime::Seconds() + MaxRevealSeconds : 0.0;
+	int32 NumRevealed = 0;
+	int32 NumVisited = 0;
+	int32 NumSteps = 0;
+
+	while (PendingReveal.Num() > 0)
+	{
+		if (MaxRevealFields > 0 && NumRevealed >= MaxRevealFields)
+		{
+			break;
+		}
+		if (MaxRevealSteps > 0 && NumSteps >= MaxRevealSteps)
+		{
+			break;
+		}
+		if (Deadline > 0.0 && ++NumVisited % MineSweeperBoard::FieldsPerTimeCheck == 0 && FPlatformTime::Seconds() > Deadline)
+		{
+			break;
+		}
+
+		const int32 Index = PendingReveal.Pop(false);
+		LastRevealSteps = ++NumSteps;
+
+		//Flags set while the cascade was pending stop it just like flags set before
+		if (Fields.IsRevealed(Index) || Fields.IsFlagged(Index))
+		{
+			continue;
+		}
+
+		Fields.Reveal(Index);
+		StateHash ^= MineSweeperBoard::HashKey(Index, MineSweeperBoard::HashRevealed);
+		OutChangedIndices.Add(Index);
+		NumRevealed++;
+
+		if (TFieldAccess::bHasZeroRegions)
+		{
+			const int32 Region = ZeroRegions[Index];
+			if (Region == INDEX_NONE)
+			{
+				continue;
+			}
+
+			//Nothing in the way, the whole region and its border open. Queued once, by the first of its fields.
+			if (RegionFlagCounts[Region] == 0)
+			{
+				if (!PendingRegions[Region])
+				{
+					PendingRegions[Region] = true;
+					for (int32 SpanIndex = RegionOffsets[Region]; SpanIndex < RegionOffsets[Region + 1]; SpanIndex++)
+					{
+						const int32 RegionField = RegionFields[SpanIndex];
+						if (!PendingVisited[RegionField] && !Fields.IsRevealed(RegionField))
+						{
+							PendingVisited[RegionField] = true;
+							PendingReveal.Add(RegionField);
+						}
+					}
+				}
+				continue;
+			}
+		}
+		else if (CountNeighbourMines<TTopology>(Index % Dims.Columns, Index / Dims.Columns) > 0)
+		{
+			//Without regions the numbers are counted as the cascade gets to them
+			continue;
+		}
+
+		//Flags on or around the region stop the cascade where they are, so it has to search around them.
+		//Without regions every field with no mines around searches.
+		TTopology::ForEachNeighbour(Dims, Index % Dims.Columns, Index / Dims.Columns, [this](int32, int32, int32 NeighbourIndex)
+		{
+			if (!PendingVisited[NeighbourIndex])
+			{
+				PendingVisited[NeighbourIndex] = true;
+				PendingReveal.Add(NeighbourIndex);
+			}
+		});
+	}
+}
+
+void FMineSweeperBoard::BuildZeroRegions()
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	ResetZeroRegions();
+	if (!KnowsMines() || MappedFields)
+	{
+		return;
+	}
+
+	DispatchMineTopology(Topology, [&](auto Policy)
+	{
+		BuildZeroRegionsKernel<decltype(Policy)>();
+	});
+	CountRegionFlags();
+}
+
+template<typename TTopology>
+void FMineSweeperBoard::BuildZeroRegionsKernel()
+{
+	const int32 TotalFields = Dims.Num();
+	const int32 RowsPerBand = FMath::Max(MineSweeperBoard::FieldsPerLabelBand / FMath::Max(Dims.Columns, 1), 1);
+	const int32 NumBands = FMath::DivideAndRoundUp(Dims.Rows, RowsPerBand);
+
+	//Union find over the zero fields, the parents live in ZeroRegions until the regions are numbered.
+	//A parent always has a lower index than its children, so a root is the first field of its region.
+	ZeroRegions.SetNumUninitialized(TotalFields);
+	int32* Parents = ZeroRegions.GetData();
+
+	auto FindRoot = [Parents](int32 Index)
+	{
+		while (Parents[Index] != Index)
+		{
+			Parents[Index] = Parents[Parents[Index]];
+			Index = Parents[Index];
+		}
+		return Index;
+	};
+
+	auto Union = [Parents, &FindRoot](int32 IndexA, int32 IndexB)
+	{
+		const int32 RootA = FindRoot(IndexA);
+		const int32 RootB = FindRoot(IndexB);
+		if (RootA < RootB)
+		{
+			Parents[RootB] = RootA;
+		}
+		else if (RootB < RootA)
+		{
+			Parents[RootA] = RootB;
+		}
+	};
+
+	//Every band joins its own fields. Neighbours are joined from the later field of the two, the earlier one is labeled by then.
+	//Pairs reaching into another band are kept for later, that band may still be running.
+	TArray<TArray<TPair<int32, int32>>> CrossBandPairs;
+	CrossBandPairs.SetNum(NumBands);
+
+	ParallelFor(NumBands, [&](int32 BandIndex)
+	{
+		const int32 FirstRow = BandIndex * RowsPerBand;
+		const int32 EndRow = FMath::Min(FirstRow + RowsPerBand, Dims.Rows);
+		const int32 FirstIndex = Dims.ToIndex(0, FirstRow);
+
+		for (int32 RowIndex = FirstRow; RowIndex < EndRow; RowIndex++)
+		{
+			for (int32 ColIndex = 0; ColIndex < Dims.Columns; ColIndex++)
+			{
+				const int32 Index = Dims.ToIndex(ColIndex, RowIndex);
+				if (Mines[Index] || CountNeighbourMines<TTopology>(ColIndex, RowIndex) != 0)
+				{
+					Parents[Index] = INDEX_NONE;
+					continue;
+				}
+
+				Parents[Index] = Index;
+				TTopology::ForEachNeighbour(Dims, ColIndex, RowIndex, [&](int32, int32, int32 NeighbourIndex)
+				{
+					if (NeighbourIndex >= Index)
+					{
+						return;
+					}
+					if (NeighbourIndex < FirstIndex)
+					{
+						CrossBandPairs[BandIndex].Emplace(Index, NeighbourIndex);
+					}
+					else if (Parents[NeighbourIndex] != INDEX_NONE)
+					{
+						Union(Index, NeighbourIndex);
+					}
+				});
+			}
+		}
+	});
+
+	//Stitch the bands together
+	for (const TArray<TPair<int32, int32>>& Pairs : CrossBandPairs)
+	{
+		for (const TPair<int32, int32>& Pair : Pairs)
+		{
+			if (Parents[Pair.Value] != INDEX_NONE)
+			{
+				Union(Pair.Key, Pair.Value);
+			}
+		}
+	}
+
+	//Number the regions in field order. A parent comes before its children, so it holds its region already.
+	int32 NumRegions = 0;
+	for (int32 Index = 0; Index < TotalFields; Index++)
+	{
+		const int32 Parent = Parents[Index];
+		if (Parent != INDEX_NONE)
+		{
+			Parents[Index] = Parent == Index ? NumRegions++ : Parents[Parent];
+		}
+	}
+
+	//Lists of the fields and borders of every region, counted first and filled after
+	RegionOffsets.Init(0, NumRegions + 1);
+	for (int32 Index = 0; Index < TotalFields; Index++)
+	{
+		ForEachRegionAround<TTopology>(Index, [this](int32 Region)
+		{
+			RegionOffsets[Region + 1]++;
+		});
+	}
+	for (int32 Region = 0; Region < NumRegions; Region++)
+	{
+		RegionOffsets[Region + 1] += RegionOffsets[Region];
+	}
+
+	RegionFields.SetNumUninitialized(RegionOffsets[NumRegions]);
+	TArray<int32> FillPositions(RegionOffsets.GetData(), NumRegions);
+	for (int32 Index = 0; Index < TotalFields; Index++)
+	{
+		ForEachRegionAround<TTopology>(Index, [this, &FillPositions, Index](int32 Region)
+		{
+			RegionFields[FillPositions[Region]++] = Index;
+		});
+	}
+}
+
+template<typename TTopology, typename FuncType>
+void FMineSweeperBoard::ForEachRegionAround(int32 Index, FuncType&& Func) const
+{
+	//No mine is next to a zero field, so mines never belong to a region
+	if (Mines[Index])
+	{
+		return;
+	}
+
+	const int32 OwnRegion = ZeroRegions[Index];
+	if (OwnRegion != INDEX_NONE)
+	{
+		Func(OwnRegion);
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<TTopology::NumNeighbours>> BorderedRegions;
+	TTopology::ForEachNeighbour(Dims, Index % Dims.Columns, Index / Dims.Columns, [this, &BorderedRegions](int32, int32, int32 NeighbourIndex)
+	{
+		if (ZeroRegions[NeighbourIndex] != INDEX_NONE)
+		{
+			BorderedRegions.AddUnique(ZeroRegions[NeighbourIndex]);
+		}
+	});
+
+	for (const int32 Region : BorderedRegions)
+	{
+		Func(Region);
+	}
+}
+
+FMineBoardStats FMineSweeperBoard::ComputeStats(int32 StartIndex)
+{
+	FMineBoardStats Stats;
+	if (!KnowsMines() || MappedFields)
+	{
+		return Stats;
+	}
+
+	if (ZeroRegions.Num() != Dims.Num())
+	{
+		BuildZeroRegions();
+	}
+
+	DispatchMineTopology(Topology, [&](auto Policy)
+	{
+		ComputeStatsKernel<decltype(Policy)>(Stats);
+		if (IsValidIndex(StartIndex))
+		{
+			Stats.bGuessFreeChecked = true;
+			Stats.bGuessFree = IsGuessFreeKernel<decltype(Policy)>(StartIndex);
+		}
+	});
+	return Stats;
+}
+
+template<typename TTopology>
+void FMineSweeperBoard::ComputeStatsKernel(FMineBoardStats& OutStats) const
+{
+	const int32 TotalFields = Dims.Num();
+	const int32 RowsPerBand = FMath::Max(MineSweeperBoard::FieldsPerLabelBand / FMath::Max(Dims.Columns, 1), 1);
+	const int32 NumBands = FMath::DivideAndRoundUp(Dims.Rows, RowsPerBand);
+
+	//Union find over the numbered fields no opening reveals, the same way the zero regions are labeled.
+	//Islands are counted as those fields minus the joins that merged two groups, so they never have to be numbered.
+	TArray<int32> Parents;
+	Parents.SetNumUninitialized(TotalFields);
+	int32* ParentData = Parents.GetData();
+
+	auto FindRoot = [ParentData](int32 Index)
+	{
+		while (ParentData[Index] != Index)
+		{
+			ParentData[Index] = ParentData[ParentData[Index]];
+			Index = ParentData[Index];
+		}
+		return Index;
+	};
+
+	auto Union = [ParentData, &FindRoot](int32 IndexA, int32 IndexB)
+	{
+		const int32 RootA = FindRoot(IndexA);
+		const int32 RootB = FindRoot(IndexB);
+		if (RootA == RootB)
+		{
+			return 0;
+		}
+		ParentData[FMath::Max(RootA, RootB)] = FMath::Min(RootA, RootB);
+		return 1;
+	};
+
+	struct FBandStats
+	{
+		int32 NumIsolated = 0;
+		int32 NumJoins = 0;
+		int64 MineNeighbourMines = 0;
+		int64 MineNeighbours = 0;
+		TArray<TPair<int32, int32>> CrossBandPairs;
+	};
+	TArray<FBandStats> Bands;
+	Bands.SetNum(NumBands);
+
+	ParallelFor(NumBands, [&](int32 BandIndex)
+	{
+		FBandStats& Band = Bands[BandIndex];
+		const int32 FirstRow = BandIndex * RowsPerBand;
+		const int32 EndRow = FMath::Min(FirstRow + RowsPerBand, Dims.Rows);
+		const int32 FirstIndex = Dims.ToIndex(0, FirstRow);
+
+		for (int32 RowIndex = FirstRow; RowIndex < EndRow; RowIndex++)
+		{
+			for (int32 ColIndex = 0; ColIndex < Dims.Columns; ColIndex++)
+			{
+				const int32 Index = Dims.ToIndex(ColIndex, RowIndex);
+				ParentData[Index] = INDEX_NONE;
+
+				if (Mines[Index])
+				{
+					TTopology::ForEachNeighbour(Dims, ColIndex, RowIndex, [&](int32, int32, int32 NeighbourIndex)
+					{
+						Band.MineNeighbourMines += Mines[NeighbourIndex];
+						Band.MineNeighbours++;
+					});
+					continue;
+				}
+
+				//Zero fields and their numbered border are revealed with the opening
+				if (ZeroRegions[Index] != INDEX_NONE)
+				{
+					continue;
+				}
+				bool bBordersOpening = false;
+				TTopology::ForEachNeighbour(Dims, ColIndex, RowIndex, [&](int32, int32, int32 NeighbourIndex)
+				{
+					bBordersOpening |= ZeroRegions[NeighbourIndex] != INDEX_NONE;
+				});
+				if (bBordersOpening)
+				{
+					continue;
+				}
+
+				ParentData[Index] = Index;
+				Band.NumIsolated++;
+				TTopology::ForEachNeighbour(Dims, ColIndex, RowIndex, [&](int32, int32, int32 NeighbourIndex)
+				{
+					if (NeighbourIndex >= Index)
+					{
+						return;
+					}
+					if (NeighbourIndex < FirstIndex)
+					{
+						Band.CrossBandPairs.Emplace(Index, NeighbourIndex);
+					}
+					else if (ParentData[NeighbourIndex] != INDEX_NONE)
+					{
+						Band.NumJoins += Union(Index, NeighbourIndex);
+					}
+				});
+			}
+		}
+	});
+
+	int32 NumIsolated = 0;
+	int32 NumJoins = 0;
+	int64 MineNeighbourMines = 0;
+	int64 MineNeighbours = 0;
+	for (const FBandStats& Band : Bands)
+	{
+		NumIsolated += Band.NumIsolated;
+		NumJoins += Band.NumJoins;
+		MineNeighbourMines += Band.MineNeighbourMines;
+		MineNeighbours += Band.MineNeighbours;
+
+		//Stitch the bands together
+		for (const TPair<int32, int32>& Pair : Band.CrossBandPairs)
+		{
+			if (ParentData[Pair.Value] != INDEX_NONE)
+			{
+				NumJoins += Union(Pair.Key, Pair.Value);
+			}
+		}
+	}
+
+	OutStats.NumOpenings = FMath::Max(RegionOffsets.Num() - 1, 0);
+	OutStats.ThreeBV = OutStats.NumOpenings + NumIsolated;
+	OutStats.NumIslands = NumIsolated - NumJoins;
+
+	//Compared to the chance of any other field being a mine
+	const double Density = TotalFields > 1 ? double(MineCount - 1) / (TotalFields - 1) : 0.0;
+	OutStats.MineClustering = MineNeighbours > 0 && Density > 0.0 ? float(double(MineNeighbourMines) / MineNeighbours / Density) : 0.0f;
+}
+
+template<typename TTopology>
+bool FMineSweeperBoard::IsGuessFreeKernel(int32 StartIndex) const
+{
+	if (Mines[StartIndex])
+	{
+		return false;
+	}
+
+	enum EFieldKnowledge : uint8
+	{
+		Unknown,
+		Open,
+		Flagged,
+	};
+
+	const int32 TotalFields = Dims.Num();
+	const int32 NumSafeFields = TotalFields - MineCount;
+	TArray<uint8> Knowledge;
+	Knowledge.Init(Unknown, TotalFields);
+	int32 NumOpen = 0;
+
+	//Open numbered fields to look at again, a field can be in here more than once
+	TArray<int32> Work;
+
+	//A changed field can settle the open numbers around it
+	auto QueueAround = [&](int32 Index)
+	{
+		TTopology::ForEachNeighbour(Dims, Index % Dims.Columns, Index / Dims.Columns, [&](int32, int32, int32 NeighbourIndex)
+		{
+			if (Knowledge[NeighbourIndex] == Open && ZeroRegions[NeighbourIndex] == INDEX_NONE)
+			{
+				Work.Add(NeighbourIndex);
+			}
+		});
+	};
+
+	auto OpenField = [&](int32 Index)
+	{
+		Knowledge[Index] = Open;
+		NumOpen++;
+		Work.Add(Index);
+		QueueAround(Index);
+	};
+
+	//Opening a zero field opens its whole region and border, like a cascade
+	auto Reveal = [&](int32 Index)
+	{
+		if (Knowledge[Index] != Unknown)
+		{
+			return;
+		}
+		const int32 Region = ZeroRegions[Index];
+		if (Region == INDEX_NONE)
+		{
+			OpenField(Index);
+			return;
+		}
+		for (int32 Position = RegionOffsets[Region]; Position < RegionOffsets[Region + 1]; Position++)
+		{
+			if (Knowledge[RegionFields[Position]] == Unknown)
+			{
+				OpenField(RegionFields[Position]);
+			}
+		}
+	};
+
+	Reveal(StartIndex);
+
+	TArray<int32, TInlineAllocator<TTopology::NumNeighbours>> UnknownNeighbours;
+	while (Work.Num() > 0)
+	{
+		const int32 Index = Work.Pop(false);
+		if (ZeroRegions[Index] != INDEX_NONE)
+		{
+			continue;
+		}
+
+		const int32 ColIndex = Index % Dims.Columns;
+		const int32 RowIndex = Index / Dims.Columns;
+		int32 NumFlagged = 0;
+		UnknownNeighbours.Reset();
+		TTopology::ForEachNeighbour(Dims, ColIndex, RowIndex, [&](int32, int32, int32 NeighbourIndex)
+		{
+			NumFlagged += Knowledge[NeighbourIndex] == Flagged;
+			if (Knowledge[NeighbourIndex] == Unknown)
+			{
+				UnknownNeighbours.Add(NeighbourIndex);
+			}
+		});
+		if (UnknownNeighbours.Num() == 0)
+		{
+			continue;
+		}
+
+		//All mines around are found, or every unknown field around has to be one
+		const int32 MinesLeft = CountNeighbourMines<TTopology>(ColIndex, RowIndex) - NumFlagged;
+		if (MinesLeft == 0)
+		{
+			for (const int32 NeighbourIndex : UnknownNeighbours)
+			{
+				Reveal(NeighbourIndex);
+			}
+		}
+		else if (MinesLeft == UnknownNeighbours.Num())
+		{
+			for (const int32 NeighbourIndex : UnknownNeighbours)
+			{
+				Knowledge[NeighbourIndex] = Flagged;
+				QueueAround(NeighbourIndex);
+			}
+		}
+	}
+
+	return NumOpen == NumSafeFields;
+}
+
+void FMineSweeperBoard::ResetZeroRegions()
+{
+	ZeroRegions.Empty();
+	RegionOffsets.Empty();
+	RegionFields.Empty();
+	RegionFlagCounts.Empty();
+}
+
+void FMineSweeperBoard::CountRegionFlags()
+{
+	RegionFlagCounts.Init(0, FMath::Max(RegionOffsets.Num() - 1, 0));
+	for (const int32 FlagIndex : Flags)
+	{
+		UpdateRegionFlags(FlagIndex, 1);
+	}
+}
+
+void FMineSweeperBoard::UpdateRegionFlags(int32 Index, int32 Delta)
+{
+	//Nothing to keep up to date before the regions are built, building counts the flags
+	if (ZeroRegions.Num() != Dims.Num() || !IsValidIndex(Index))
+	{
+		return;
+	}
+
+	DispatchMineTopology(Topology, [&](auto Policy)
+	{
+		ForEachRegionAround<decltype(Policy)>(Index, [this, Delta](int32 Region)
+		{
+			RegionFlagCounts[Region] += Delta;
+		});
+	});
+}
+
+void FMineSweeperBoard::ResetMirror(const FMineBoardDims& InDims, EMineBoardTopology InTopology)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	Dims = InDims;
+	Topology = InTopology;
+	MappedFields.Reset();
+	Mines.Empty();
+	Revealed.Init(false, Dims.Num());
+	Flags.Empty();
+	ResetZeroRegions();
+	RecalculateStateHash();
+}
+
+void FMineSweeperBoard::SetFieldState(int32 Index, bool bInRevealed, bool bInFlagged)
+{
+	if (!Revealed.IsValidIndex(Index))
+	{
+		return;
+	}
+
+	if (Revealed[Index] != bInRevealed)
+	{
+		Revealed[Index] = bInRevealed;
+		StateHash ^= MineSweeperBoard::HashKey(Index, MineSweeperBoard::HashRevealed);
+	}
+	if (Flags.Contains(Index) != bInFlagged)
+	{
+		if (bInFlagged)
+		{
+			Flags.Add(Index);
+		}
+		else
+		{
+			Flags.Remove(Index);
+		}
+		StateHash ^= MineSweeperBoard::HashKey(Index, MineSweeperBoard::HashFlag);
+	}
+}
+
+void FMineSweeperBoard::SetMines(TArray<bool>&& InMines)
+{
+	MappedFields.Reset();
+	Mines = MoveTemp(InMines);
+	ResetZeroRegions();
+	RecalculateStateHash();
+}
+
+void FMineSweeperBoard::SetGameState(int32 InMineCount, bool bInGenerated, bool bInGameOver, bool bInHasWon, int32 InHitMineIndex)
+{
+	StateHash ^= MineSweeperBoard::HashKey(uint32(MineCount), MineSweeperBoard::HashMineCount) ^ MineSweeperBoard::HashKey(uint32(InMineCount), MineSweeperBoard::HashMineCount);
+	MineCount = InMineCount;
+	bGenerated = bInGenerated;
+	bGameOver = bInGameOver;
+	bHasWon = bInHasWon;
+	HitMineIndex = InHitMineIndex;
+}
+
+void FMineSweeperBoard::RestoreProgress(const TArray<bool>& InRevealed, const TSet<int32>& InFlags, int32 InHitMineIndex, bool bInGameOver, bool bInHasWon)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	//The cascade of the state before has nothing to do with the restored one
+	CancelReveal();
+	Revealed = InRevealed;
+	Flags = InFlags;
+	HitMineIndex = InHitMineIndex;
+	bGameOver = bInGameOver;
+	bHasWon = bInHasWon;
+	RecalculateStateHash();
+
+	if (ZeroRegions.Num() == Dims.Num())
+	{
+		CountRegionFlags();
+	}
+}
+
+void FMineSweeperBoard::RestoreBoard(const FMineBoardDims& InDims, EMineBoardTopology InTopology, int32 InMineCount, TArray<bool>&& InMines, TArray<bool>&& InRevealed, TSet<int32>&& InFlags,
+	int32 InHitMineIndex, bool bInGameOver, bool bInHasWon)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	Reset(InDims, InTopology, InMineCount);
+	if (InMines.Num() != Dims.Num())
+	{
+		return;
+	}
+
+	Mines = MoveTemp(InMines);
+	Revealed = MoveTemp(InRevealed);
+	Revealed.SetNumZeroed(Dims.Num());
+	Flags = MoveTemp(InFlags);
+	HitMineIndex = IsValidIndex(InHitMineIndex) ? InHitMineIndex : INDEX_NONE;
+	bGenerated = true;
+	bGameOver = bInGameOver;
+	bHasWon = bInHasWon;
+	RecalculateStateHash();
+}
+
+SIZE_T FMineSweeperBoard::GetAllocatedSize() const
+{
+	return Mines.GetAllocatedSize() + Revealed.GetAllocatedSize() + Flags.GetAllocatedSize()
+		+ PendingReveal.GetAllocatedSize() + PendingVisited.GetAllocatedSize() + PendingRegions.GetAllocatedSize()
+		+ ZeroRegions.GetAllocatedSize() + RegionOffsets.GetAllocatedSize() + RegionFields.GetAllocatedSize() + RegionFlagCounts.GetAllocatedSize()
+		+ (MappedFields ? sizeof(FMineMappedFields) + MappedFields->GetAllocatedSize() : 0);
+}
+
+int32 FMineSweeperBoard::CalcMineCount(float MineChance, int32 NumFields)
+{
+	return FMath::Clamp(FMath::RoundToInt(MineChance * NumFields), 0, NumFields);
+}
+
+int64 FMineSweeperBoard::EstimateGeneratedSize(int64 NumFields)
+{
+	return FMath::Max<int64>(NumFields, 0) * MineSweeperBoard::PeakBytesPerField;
+}
+
+int64 FMineSweeperBoard::EstimateMappedSize(int64 NumFields)
+{
+	return FMath::Max<int64>(NumFields, 0) * MineSweeperBoard::PeakMappedBytesPerField;
+}
+
+FArchive& operator<<(FArchive& Ar, FMineSweeperBoard& Board)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	//A mapped board stays in its file, it is saved as a new board of its size
+	if (Ar.IsSaving() && Board.MappedFields)
+	{
+		FMineSweeperBoard NewBoard;
+		NewBoard.Reset(Board.Dims, Board.Topology, Board.MineCount);
+		return Ar << NewBoard;
+	}
+
+	Ar << Board.Dims.Columns;
+	Ar << Board.Dims.Rows;
+	Ar << Board.Dims.RowsPerLayer;
+	Ar << Board.Topology;
+	Ar << Board.MineCount;
+	Ar << Board.HitMineIndex;
+	Ar << Board.bGenerated;
+	Ar << Board.bGameOver;
+	Ar << Board.bHasWon;
+	Ar << Board.Mines;
+	Ar << Board.Revealed;
+	Ar << Board.Flags;
+
+	//A cascade belongs to the state it was started on, a loaded or undone board starts without one.
+	//The zero regions follow the mines, they are built again by the next cascade. The hash is not saved, it is taken again.
+	if (Ar.IsLoading())
+	{
+		Board.MappedFields.Reset();
+		Board.CancelReveal();
+		Board.ResetZeroRegions();
+		Board.RecalculateStateHash();
+	}
+	return Ar;
+}
@@ -0,0 +1,184 @@
+#include "MineSweeperTestGame.h"
+#include "MineBoardFile.h"
+#include "MineMoveLog.h"
+#include "MineSweeperBoard.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Micro benchmarks of the board without an actor around it: moves, replays, scoring candidates for the difficulty filter
+//and playing a board file from its mapping. The numbers go to the test log.
+//Run them with DetailPanelCoreTests -perf, or in the editor with
+//UnrealEditor-Cmd DetailPanel.uproject -nullrhi -ExecCmds="Automation RunTests Project.DetailPanel.MineSweeper.Board.Benchmark; Quit"
+namespace MineSweeperBoardBenchmark
+{
+	//Each measurement runs at least this long, so the clock resolution doesn't matter
+	static constexpr double MinSeconds = 0.5;
+
+	//Calls Func until MinSeconds passed, Func returns how many operations it did. Returns operations per second.
+	template<typename FuncType>
+	static double MeasureRate(FuncType&& Func)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		int64 NumOperations = 0;
+		double Elapsed = 0.0;
+		do
+		{
+			NumOperations += Func();
+			Elapsed = FPlatformTime::Seconds() - StartTime;
+		}
+		while (Elapsed < MinSeconds);
+		return NumOperations / Elapsed;
+	}
+}
+
+using namespace MineSweeperBoardBenchmark;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMineSweeperBoardBenchmarkTest, "Project.DetailPanel.MineSweeper.Board.Benchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProgramContext | EAutomationTestFlags::PerfFilter)
+
+bool FMineSweeperBoardBenchmarkTest::RunTest(const FString& Parameters)
+{
+	//Random moves, with and without a reveal budget, a new game whenever one ends
+	for (const int32 MaxRevealFields : { 0, 256 })
+	{
+		int32 GameSeed = 1;
+		TUniquePtr<FMineTestGame> Game = MakeUnique<FMineTestGame>(FMineTestGame::MakeDims(1000, 1000), EMineBoardTopology::Square8, 0.15f, GameSeed, MaxRevealFields);
+		const double MovesPerSecond = MeasureRate([&]()
+		{
+			int32 NumMoves = 0;
+			for (int32 Step = 0; Step < 1000; Step++)
+			{
+				if (Game->Board.IsGameOver())
+				{
+					Game = MakeUnique<FMineTestGame>(FMineTestGame::MakeDims(1000, 1000), EMineBoardTopology::Square8, 0.15f, ++GameSeed, MaxRevealFields);
+				}
+				NumMoves += Game->PlayRandomStep() ? 1 : 0;
+			}
+			return NumMoves;
+		});
+		AddInfo(FString::Printf(TEXT("Moves on 1000x1000, budget %d: %.0f moves/s over %d games"), MaxRevealFields, MovesPerSecond, GameSeed));
+		TestTrue(TEXT("Moves are played"), MovesPerSecond > 0.0);
+	}
+
+	//Playing back a long recorded game, and seeking around in it
+	{
+		FMineTestGame Game(FMineTestGame::MakeDims(500, 500), EMineBoardTopology::Square8, 0.12f, 7, 64);
+		for (int32 Step = 0; Step < 100000 && !Game.Board.IsGameOver(); Step++)
+		{
+			Game.PlayRandomStep();
+		}
+
+		const double ReplayMovesPerSecond = MeasureRate([&Game]()
+		{
+			FMineReplay Replay(Game.Log);
+			Replay.StepToEnd();
+			return Replay.GetNumMoves();
+		});
+
+		FMineReplay Replay(Game.Log);
+		Replay.StepToEnd();
+		FRandomStream Random(3);
+		const double SeeksPerSecond = MeasureRate([&]()
+		{
+			for (int32 Seek = 0; Seek < 100; Seek++)
+			{
+				Replay.SeekTo(Random.RandRange(0, Replay.GetNumMoves()));
+			}
+			return 100;
+		});
+
+		AddInfo(FString::Printf(TEXT("Replay of %d moves on 500x500 in %d bytes: %.0f moves/s, %.0f random seeks/s"),
+			Game.Log.NumMoves, Game.Log.Data.Num(), ReplayMovesPerSecond, SeeksPerSecond));
+		TestTrue(TEXT("The replay plays"), ReplayMovesPerSecond > 0.0);
+	}
+
+	//Candidates the difficulty filter scores, on the expert board and on a big one
+	for (const FIntPoint Size : { FIntPoint(30, 16), FIntPoint(200, 200) })
+	{
+		for (const bool bGuessFree : { false, true })
+		{
+			const FMineBoardDims Dims = FMineTestGame::MakeDims(Size.X, Size.Y);
+			const int32 SafeIndex = Dims.ToIndex(Size.X / 2, Size.Y / 2);
+			FMineSweeperBoard Board;
+			Board.Reset(Dims, EMineBoardTopology::Square8, FMineSweeperBoard::CalcMineCount(0.2f, Dims.Num()));
+
+			int32 Seed = 0;
+			int32 NumGuessFree = 0;
+			const double CandidatesPerSecond = MeasureRate([&]()
+			{
+				for (int32 Candidate = 0; Candidate < 10; Candidate++)
+				{
+					Board.Generate(SafeIndex, ++Seed);
+					NumGuessFree += Board.ComputeStats(bGuessFree ? SafeIndex : INDEX_NONE).bGuessFree ? 1 : 0;
+				}
+				return 10;
+			});
+
+			AddInfo(FString::Printf(TEXT("Difficulty candidates on %dx%d%s: %.0f boards/s%s"), Size.X, Size.Y, bGuessFree ? TEXT(" with the guess free check") : TEXT(""),
+				CandidatesPerSecond, bGuessFree ? *FString::Printf(TEXT(", %d of %d guess free"), NumGuessFree, Seed) : TEXT("")));
+			TestTrue(TEXT("Candidates are scored"), CandidatesPerSecond > 0.0);
+		}
+	}
+
+	//A board file played from its mapping next to the same board loaded
+	{
+		const FString Directory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MineSweeperBenchmark"));
+		const FString Filename = FPaths::Combine(Directory, TEXT("Mapped.msb"));
+		IFileManager::Get().MakeDirectory(*Directory, true);
+
+		SIZE_T LoadedBytes = 0;
+		{
+			FMineSweeperBoard Board;
+			Board.Reset(FMineTestGame::MakeDims(4096, 4096), EMineBoardTopology::Square8, FMineSweeperBoard::CalcMineCount(0.15f, 4096 * 4096));
+			Board.Generate(0, 11);
+			LoadedBytes = Board.GetAllocatedSize();
+			TestTrue(TEXT("The board file is written"), FMineBoardFile::Save(Filename, Board, 11, false));
+		}
+
+		//The counts come from the header, so opening doesn't read the tiles
+		TUniquePtr<FMineSweeperBoard> Mapped = MakeUnique<FMineSweeperBoard>();
+		const double OpenStart = FPlatformTime::Seconds();
+		TestTrue(TEXT("The board file is mapped"), Mapped->OpenMapped(Filename));
+		const double OpenMs = (FPlatformTime::Seconds() - OpenStart) * 1000.0;
+
+		//Only clicks on hidden safe fields count, a won board is opened again so the clicks always do work
+		FRandomStream Random(13);
+		TArray<int32> ChangedIndices;
+		int32 NumOpens = 1;
+		const double ClicksPerSecond = MeasureRate([&]()
+		{
+			int32 NumClicks = 0;
+			for (int32 Try = 0; Try < 1000 && NumClicks < 100; Try++)
+			{
+				if (Mapped->IsGameOver())
+				{
+					Mapped->OpenMapped(Filename);
+					NumOpens++;
+				}
+				ChangedIndices.Reset();
+				const int32 Index = Random.RandRange(0, Mapped->GetDims().Num() - 1);
+				if (!Mapped->IsMine(Index) && !Mapped->IsRevealed(Index))
+				{
+					Mapped->Click(Index, ChangedIndices);
+					NumClicks++;
+				}
+			}
+			return NumClicks;
+		});
+
+		AddInfo(FString::Printf(TEXT("Mapped 4096x4096 board: open %.1f ms, %.0f clicks/s over %d games, %llu KB of changes against %llu KB loaded"),
+			OpenMs, ClicksPerSecond, NumOpens, uint64(Mapped->GetAllocatedSize() / 1024), uint64(LoadedBytes / 1024)));
+		TestTrue(TEXT("The mapped board is played"), ClicksPerSecond > 0.0);
+
+		//Unmapped before the file goes
+		Mapped.Reset();
+		IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	}
+	return true;
+}
+
+#endif
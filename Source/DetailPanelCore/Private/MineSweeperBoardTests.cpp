@@ -0,0 +1,413 @@
+#include "MineSweeperTestGame.h"
+#include "MineBoardFile.h"
+#include "MineMoveLog.h"
+#include "MineSweeperBoard.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Tests of the board rules and of what is built on them, none of them needs a world or an actor.
+//Run them with the DetailPanelCoreTests program, or headless in the editor with
+//UnrealEditor-Cmd DetailPanel.uproject -nullrhi -ExecCmds="Automation RunTests Project.DetailPanel.MineSweeper.Board; Quit"
+namespace MineSweeperBoardTests
+{
+	static const EMineBoardTopology Topologies[] = { EMineBoardTopology::Square8, EMineBoardTopology::Hex6, EMineBoardTopology::Torus8, EMineBoardTopology::Cube26 };
+
+	static FMineBoardDims MakeTopologyDims(EMineBoardTopology Topology, int32 Columns, int32 Rows)
+	{
+		return Topology == EMineBoardTopology::Cube26 ? FMineTestGame::MakeDims(Columns, Rows, 3) : FMineTestGame::MakeDims(Columns, Rows);
+	}
+
+	//A square board with mines where the rows have a '*'
+	static void MakeBoard(FMineSweeperBoard& Board, const TArray<FString>& Rows)
+	{
+		const FMineBoardDims Dims = FMineTestGame::MakeDims(Rows[0].Len(), Rows.Num());
+		TArray<bool> Mines;
+		TArray<bool> Revealed;
+		Mines.Init(false, Dims.Num());
+		Revealed.Init(false, Dims.Num());
+
+		int32 NumMines = 0;
+		for (int32 RowIndex = 0; RowIndex < Dims.Rows; RowIndex++)
+		{
+			for (int32 ColIndex = 0; ColIndex < Dims.Columns; ColIndex++)
+			{
+				const bool bMine = Rows[RowIndex][ColIndex] == TEXT('*');
+				Mines[Dims.ToIndex(ColIndex, RowIndex)] = bMine;
+				NumMines += bMine ? 1 : 0;
+			}
+		}
+		Board.RestoreBoard(Dims, EMineBoardTopology::Square8, NumMines, MoveTemp(Mines), MoveTemp(Revealed), TSet<int32>(), INDEX_NONE, false, false);
+	}
+
+	static int32 CountRevealed(const FMineSweeperBoard& Board)
+	{
+		int32 Count = 0;
+		for (const bool bRevealed : Board.GetRevealed())
+		{
+			Count += bRevealed ? 1 : 0;
+		}
+		return Count;
+	}
+
+	//Hash of the same state taken from scratch
+	static uint64 RecalculatedHash(const FMineSweeperBoard& Board)
+	{
+		FMineSweeperBoard Copy;
+		Copy.RestoreBoard(Board.GetDims(), Board.GetTopology(), Board.GetMineCount(), CopyTemp(Board.GetMines()), CopyTemp(Board.GetRevealed()), CopyTemp(Board.GetFlags()),
+			Board.GetHitMineIndex(), Board.IsGameOver(), Board.HasWon());
+		return Copy.GetStateHash();
+	}
+
+	static bool SameProgress(const FMineSweeperBoard& A, const FMineSweeperBoard& B)
+	{
+		return A.GetMines() == B.GetMines() && A.GetRevealed() == B.GetRevealed() && A.GetFlags().Num() == B.GetFlags().Num() && A.GetFlags().Includes(B.GetFlags())
+			&& A.IsGameOver() == B.IsGameOver() && A.HasWon() == B.HasWon() && A.GetMineCount() == B.GetMineCount();
+	}
+}
+
+using namespace MineSweeperBoardTests;
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMineSweeperBoardRulesTest, "Project.DetailPanel.MineSweeper.Board.Rules",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProgramContext | EAutomationTestFlags::ProductFilter)
+
+bool FMineSweeperBoardRulesTest::RunTest(const FString& Parameters)
+{
+	//Mines in two corners, everything else opens from any zero field
+	const TArray<FString> Rows = { TEXT("*..."), TEXT("...."), TEXT("...."), TEXT("...*") };
+	TArray<int32> ChangedIndices;
+
+	//Generate
+	{
+		FMineSweeperBoard Board;
+		Board.Reset(FMineTestGame::MakeDims(10, 10), EMineBoardTopology::Square8, 20);
+		Board.Generate(55, 7);
+		TestEqual(TEXT("Generate places the mines asked for"), Board.GetMines().FilterByPredicate([](bool bMine) { return bMine; }).Num(), 20);
+		TestFalse(TEXT("Generate keeps the safe field free"), Board.IsMine(55));
+		TestEqual(TEXT("Generate keeps the neighbours of the safe field free"), Board.CalculateFieldNumber(55), 0);
+
+		FMineSweeperBoard Again;
+		Again.Reset(FMineTestGame::MakeDims(10, 10), EMineBoardTopology::Square8, 20);
+		Again.Generate(55, 7);
+		TestTrue(TEXT("Generate gives the same mines for the same seed"), Board.GetMines() == Again.GetMines());
+	}
+
+	//Reveal
+	{
+		FMineSweeperBoard Board;
+		MakeBoard(Board, Rows);
+		Board.Click(5, ChangedIndices);
+		TestEqual(TEXT("A number only reveals itself"), ChangedIndices.Num(), 1);
+		TestEqual(TEXT("The number counts the mine around"), Board.CalculateFieldNumber(5), 1);
+
+		ChangedIndices.Reset();
+		Board.Click(3, ChangedIndices);
+		TestEqual(TEXT("A zero field opens every field without a mine"), CountRevealed(Board), 14);
+		TestFalse(TEXT("Revealing everything without the flags is no win"), Board.IsGameOver());
+	}
+
+	//Flag
+	{
+		FMineSweeperBoard Board;
+		MakeBoard(Board, Rows);
+		Board.ToggleFlag(1, ChangedIndices);
+		TestTrue(TEXT("A flag is set"), Board.IsFlagged(1));
+		TestFalse(TEXT("Flagged fields can't be clicked"), Board.CanClick(1));
+		Board.ToggleFlag(1, ChangedIndices);
+		TestFalse(TEXT("A flag is removed again"), Board.IsFlagged(1));
+
+		Board.ToggleFlag(0, ChangedIndices);
+		Board.ToggleFlag(15, ChangedIndices);
+		ChangedIndices.Reset();
+		Board.ToggleFlag(1, ChangedIndices);
+		TestEqual(TEXT("There are never more flags than mines"), Board.GetFlags().Num(), 2);
+		TestEqual(TEXT("A refused flag changes no field"), ChangedIndices.Num(), 0);
+	}
+
+	//Chord
+	{
+		FMineSweeperBoard Board;
+		MakeBoard(Board, Rows);
+		Board.Click(5, ChangedIndices);
+		TestFalse(TEXT("No chord without the flags"), Board.CanChord(5));
+		Board.ToggleFlag(0, ChangedIndices);
+		TestTrue(TEXT("Chord once the flags match the number"), Board.CanChord(5));
+		Board.Chord(5, ChangedIndices);
+		TestTrue(TEXT("A chord reveals the neighbours"), Board.IsRevealed(1) && Board.IsRevealed(4) && Board.IsRevealed(10));
+		TestFalse(TEXT("A right chord goes on"), Board.IsGameOver());
+
+		FMineSweeperBoard WrongBoard;
+		MakeBoard(WrongBoard, Rows);
+		WrongBoard.Click(5, ChangedIndices);
+		WrongBoard.ToggleFlag(1, ChangedIndices);
+		WrongBoard.Chord(5, ChangedIndices);
+		TestTrue(TEXT("A chord next to a wrong flag hits the mine"), WrongBoard.IsGameOver() && !WrongBoard.HasWon());
+		TestEqual(TEXT("The chord hit the unflagged mine"), WrongBoard.GetHitMineIndex(), 0);
+	}
+
+	//Win
+	{
+		FMineSweeperBoard Board;
+		MakeBoard(Board, Rows);
+		Board.Click(3, ChangedIndices);
+		Board.ToggleFlag(0, ChangedIndices);
+		Board.ToggleFlag(15, ChangedIndices);
+		TestTrue(TEXT("Flagging the last mine wins"), Board.IsGameOver() && Board.HasWon());
+
+		FMineSweeperBoard FlagsFirst;
+		MakeBoard(FlagsFirst, Rows);
+		FlagsFirst.ToggleFlag(0, ChangedIndices);
+		FlagsFirst.ToggleFlag(15, ChangedIndices);
+		FlagsFirst.Click(3, ChangedIndices);
+		TestTrue(TEXT("Revealing the last field wins"), FlagsFirst.IsGameOver() && FlagsFirst.HasWon());
+	}
+
+	//Lose
+	{
+		FMineSweeperBoard Board;
+		MakeBoard(Board, Rows);
+		Board.Click(15, ChangedIndices);
+		TestTrue(TEXT("Clicking a mine ends the game"), Board.IsGameOver() && !Board.HasWon());
+		TestEqual(TEXT("The hit mine is kept"), Board.GetHitMineIndex(), 15);
+		TestEqual(TEXT("A lost game shows the whole board"), CountRevealed(Board), 16);
+		TestFalse(TEXT("Nothing can be clicked after the game"), Board.CanClick(5));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMineSweeperBoardCascadeTest, "Project.DetailPanel.MineSweeper.Board.Cascade",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProgramContext | EAutomationTestFlags::ProductFilter)
+
+bool FMineSweeperBoardCascadeTest::RunTest(const FString& Parameters)
+{
+	//The zero region lists have to open exactly what a plain flood fill opens, flags in the way included
+	for (const EMineBoardTopology Topology : Topologies)
+	{
+		for (int32 Seed = 1; Seed <= 20; Seed++)
+		{
+			const FMineBoardDims Dims = MakeTopologyDims(Topology, 24, 16);
+			const int32 SafeIndex = Dims.Num() / 2;
+			FMineSweeperBoard Board;
+			Board.Reset(Dims, Topology, FMineSweeperBoard::CalcMineCount(0.12f, Dims.Num()));
+			Board.Generate(SafeIndex, Seed);
+
+			TArray<int32> ChangedIndices;
+			FRandomStream Random(Seed);
+			for (int32 FlagIndex = 0; FlagIndex < Board.GetMineCount() / 2; FlagIndex++)
+			{
+				const int32 Index = Random.RandRange(0, Dims.Num() - 1);
+				if (Index != SafeIndex && !Board.IsFlagged(Index))
+				{
+					Board.ToggleFlag(Index, ChangedIndices);
+				}
+			}
+
+			TArray<bool> Expected;
+			Expected.Init(false, Dims.Num());
+			TArray<int32> Stack = { SafeIndex };
+			while (Stack.Num() > 0)
+			{
+				const int32 Index = Stack.Pop(false);
+				if (Expected[Index] || Board.IsFlagged(Index))
+				{
+					continue;
+				}
+				Expected[Index] = true;
+				if (Board.CalculateFieldNumber(Index) == 0)
+				{
+					DispatchMineTopology(Topology, [&](auto Policy)
+					{
+						decltype(Policy)::ForEachNeighbour(Dims, Index % Dims.Columns, Index / Dims.Columns, [&Stack](int32, int32, int32 NeighbourIndex)
+						{
+							Stack.Add(NeighbourIndex);
+						});
+					});
+				}
+			}
+
+			ChangedIndices.Reset();
+			Board.Click(SafeIndex, ChangedIndices);
+			if (!TestTrue(FString::Printf(TEXT("Cascade on topology %d, seed %d opens the same fields as a flood fill"), int32(Topology), Seed), Board.GetRevealed() == Expected))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMineSweeperBoardStateHashTest, "Project.DetailPanel.MineSweeper.Board.StateHash",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProgramContext | EAutomationTestFlags::ProductFilter)
+
+bool FMineSweeperBoardStateHashTest::RunTest(const FString& Parameters)
+{
+	//Every move updates the hash for the fields it changed, that has to end where hashing everything again ends
+	for (const EMineBoardTopology Topology : Topologies)
+	{
+		for (int32 Seed = 1; Seed <= 5; Seed++)
+		{
+			FMineTestGame Game(MakeTopologyDims(Topology, 20, 12), Topology, 0.15f, Seed, Seed % 2 == 0 ? 5 : 0);
+			for (int32 Step = 0; Step < 300 && !Game.Board.IsGameOver(); Step++)
+			{
+				Game.PlayRandomStep();
+				if (Game.Board.GetStateHash() != RecalculatedHash(Game.Board))
+				{
+					AddError(FString::Printf(TEXT("Topology %d, seed %d: the hash after step %d differs from the recalculated one"), int32(Topology), Seed, Step));
+					return false;
+				}
+			}
+		}
+	}
+
+	FMineSweeperBoard A;
+	FMineSweeperBoard B;
+	A.Reset(FMineTestGame::MakeDims(10, 10), EMineBoardTopology::Square8, 10);
+	B.Reset(FMineTestGame::MakeDims(10, 10), EMineBoardTopology::Square8, 10);
+	A.Generate(0, 1);
+	B.Generate(0, 2);
+	TestNotEqual(TEXT("Other mines give another hash"), A.GetStateHash(), B.GetStateHash());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMineSweeperBoardReplayTest, "Project.DetailPanel.MineSweeper.Board.Replay",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProgramContext | EAutomationTestFlags::ProductFilter)
+
+bool FMineSweeperBoardReplayTest::RunTest(const FString& Parameters)
+{
+	for (const int32 MaxRevealFields : { 0, 7 })
+	{
+		FMineTestGame Game(FMineTestGame::MakeDims(30, 30), EMineBoardTopology::Square8, 0.1f, 1234 + MaxRevealFields, MaxRevealFields);
+		for (int32 Step = 0; Step < 2000 && !Game.Board.IsGameOver(); Step++)
+		{
+			Game.PlayRandomStep();
+		}
+		Game.HashesBeforeMoves.Add(Game.Board.GetStateHash());
+
+		//Small keyframe intervals so the seeks go through keyframes taken during and after cascades
+		FMineReplay Replay(Game.Log, 4);
+		TestTrue(TEXT("The recorded log is valid"), Replay.IsValid());
+		TestEqual(TEXT("The replay has every move"), Replay.GetNumMoves(), Game.HashesBeforeMoves.Num() - 1);
+
+		Replay.StepToEnd();
+		TestEqual(FString::Printf(TEXT("Budget %d: the replay ends on the recorded board"), MaxRevealFields), Replay.GetBoard().GetStateHash(), Game.Board.GetStateHash());
+		TestTrue(FString::Printf(TEXT("Budget %d: the replay ends in the recorded game state"), MaxRevealFields), SameProgress(Replay.GetBoard(), Game.Board));
+
+		FRandomStream Random(MaxRevealFields);
+		for (int32 Seek = 0; Seek < 50; Seek++)
+		{
+			const int32 MoveIndex = Random.RandRange(0, Replay.GetNumMoves());
+			Replay.SeekTo(MoveIndex);
+			if (Replay.GetBoard().GetStateHash() != Game.HashesBeforeMoves[MoveIndex])
+			{
+				AddError(FString::Printf(TEXT("Budget %d: seeking to move %d of %d gives another board than the recorded one"), MaxRevealFields, MoveIndex, Replay.GetNumMoves()));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMineSweeperBoardFileTest, "Project.DetailPanel.MineSweeper.Board.File",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProgramContext | EAutomationTestFlags::ProductFilter)
+
+bool FMineSweeperBoardFileTest::RunTest(const FString& Parameters)
+{
+	const FString Directory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MineSweeper"));
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	FMineTestGame Game(FMineTestGame::MakeDims(300, 200), EMineBoardTopology::Hex6, 0.12f, 99);
+	for (int32 Step = 0; Step < 500 && !Game.Board.IsGameOver(); Step++)
+	{
+		Game.PlayRandomStep();
+	}
+
+	for (const TCHAR* Name : { TEXT("Board.msb"), TEXT("BoardRaw.msb"), TEXT("Board.txt") })
+	{
+		const FString Filename = FPaths::Combine(Directory, Name);
+		const bool bSaved = FMineBoardFile::IsTextFilename(Filename) ? FMineBoardFile::SaveText(Filename, Game.Board, 99)
+			: FMineBoardFile::Save(Filename, Game.Board, 99, FCString::Strstr(Name, TEXT("Raw")) == nullptr);
+		TestTrue(FString::Printf(TEXT("%s is written"), Name), bSaved);
+
+		FMineSweeperBoard Loaded;
+		int32 LoadedSeed = 0;
+		TestTrue(FString::Printf(TEXT("%s is read"), Name), FMineBoardFile::Load(Filename, Loaded, LoadedSeed));
+		TestEqual(FString::Printf(TEXT("%s keeps the seed"), Name), LoadedSeed, 99);
+		TestEqual(FString::Printf(TEXT("%s keeps the state"), Name), Loaded.GetStateHash(), Game.Board.GetStateHash());
+		TestTrue(FString::Printf(TEXT("%s keeps the game"), Name), SameProgress(Loaded, Game.Board));
+	}
+
+	//A board played from its mapping has to show the file and go on with the same moves as a loaded copy of it
+	for (const TCHAR* Name : { TEXT("Board.msb"), TEXT("BoardRaw.msb") })
+	{
+		const FString Filename = FPaths::Combine(Directory, Name);
+		FMineSweeperBoard Mapped;
+		FMineSweeperBoard Loaded;
+		int32 LoadedSeed = 0;
+		TestTrue(FString::Printf(TEXT("%s is mapped"), Name), Mapped.OpenMapped(Filename) && FMineBoardFile::Load(Filename, Loaded, LoadedSeed));
+
+		FMineBoardFileReader Reader;
+		TestTrue(FString::Printf(TEXT("%s has its counts in the header"), Name), Reader.Open(Filename) && Reader.GetHeader().bHasCounts
+			&& Reader.GetHeader().NumHidden == Loaded.GetDims().Num() - CountRevealed(Loaded) && Reader.GetHeader().NumFlags == Loaded.GetFlags().Num());
+
+		bool bSameFields = Mapped.IsMapped() && Mapped.GetMines().Num() == 0;
+		for (int32 Index = 0; Index < Loaded.GetDims().Num(); Index++)
+		{
+			bSameFields &= Mapped.IsMine(Index) == Loaded.IsMine(Index) && Mapped.IsRevealed(Index) == Loaded.IsRevealed(Index) && Mapped.IsFlagged(Index) == Loaded.IsFlagged(Index);
+		}
+		TestTrue(FString::Printf(TEXT("%s shows the fields of the file"), Name), bSameFields);
+
+		TArray<int32> ChangedIndices;
+		FRandomStream Random(5);
+		for (int32 Move = 0; Move < 200 && !Loaded.IsGameOver(); Move++)
+		{
+			const int32 Index = Random.RandRange(0, Loaded.GetDims().Num() - 1);
+			const float Kind = Random.FRand();
+			if (Kind < 0.2f)
+			{
+				Loaded.ToggleFlag(Index, ChangedIndices);
+				Mapped.ToggleFlag(Index, ChangedIndices);
+			}
+			else if (Kind < 0.3f)
+			{
+				Loaded.Chord(Index, ChangedIndices);
+				Mapped.Chord(Index, ChangedIndices);
+			}
+			else
+			{
+				Loaded.Click(Index, ChangedIndices);
+				Mapped.Click(Index, ChangedIndices);
+			}
+		}
+
+		bSameFields = Mapped.IsGameOver() == Loaded.IsGameOver() && Mapped.HasWon() == Loaded.HasWon() && Mapped.GetNumFlags() == Loaded.GetFlags().Num();
+		for (int32 Index = 0; Index < Loaded.GetDims().Num(); Index++)
+		{
+			bSameFields &= Mapped.IsRevealed(Index) == Loaded.IsRevealed(Index) && Mapped.IsFlagged(Index) == Loaded.IsFlagged(Index)
+				&& Mapped.IsCrossed(Index) == Loaded.IsCrossed(Index);
+		}
+		TestTrue(FString::Printf(TEXT("%s plays like the loaded board"), Name), bSameFields);
+	}
+
+	//Sizes past int32 are turned down before anything is allocated
+	{
+		const FString Filename = FPaths::Combine(Directory, TEXT("Huge.txt"));
+		FFileHelper::SaveStringToFile(TEXT("minesweeper 1\ncolumns 2000000000\nrows 2\nboard\n..\n..\n"), *Filename);
+
+		FMineBoardFile::FHeader Header;
+		TestTrue(TEXT("The keys of a text file are read alone"), FMineBoardFile::ReadTextHeader(Filename, Header));
+		TestEqual(TEXT("The text header has the columns"), Header.Dims.Columns, 2000000000);
+
+		AddExpectedError(TEXT("has a broken header"), EAutomationExpectedErrorFlags::Contains, 1);
+		FMineSweeperBoard Loaded;
+		int32 LoadedSeed = 0;
+		TestFalse(TEXT("A text board over MAX_int32 fields is not loaded"), FMineBoardFile::LoadText(Filename, Loaded, LoadedSeed));
+	}
+
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	return true;
+}
+
+#endif
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MineMoveLog.h"
+#include "MineSweeperBoard.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Plays random moves on a plain board and records them the same way AMineSweeperActor does, for the board tests and benchmarks.
+//With a reveal budget the cascades are continued now and then between the moves, like the actor's ticker does.
+struct FMineTestGame
+{
+	FMineSweeperBoard Board;
+	FMineMoveLog Log;
+	FRandomStream Random;
+	TArray<int32> ChangedIndices;
+
+	//Board hash right before every recorded move, so index i is the state a replay is in after i moves
+	TArray<uint64> HashesBeforeMoves;
+
+	FMineTestGame(const FMineBoardDims& Dims, EMineBoardTopology Topology, float MineChance, int32 Seed, int32 MaxRevealFields = 0)
+		: Random(Seed)
+	{
+		Log.Begin(Dims.Columns, Dims.RowsPerLayer, Dims.Rows / Dims.RowsPerLayer, Topology, MineChance, Seed);
+		Board.Reset(Dims, Topology, FMineSweeperBoard::CalcMineCount(MineChance, Dims.Num()));
+		Board.SetRevealBudget(MaxRevealFields, 0.0);
+	}
+
+	static FMineBoardDims MakeDims(int32 Columns, int32 RowsPerLayer, int32 NumLayers = 1)
+	{
+		FMineBoardDims Dims;
+		Dims.Columns = Columns;
+		Dims.Rows = RowsPerLayer * NumLayers;
+		Dims.RowsPerLayer = RowsPerLayer;
+		return Dims;
+	}
+
+	//A random field that is revealed or not, a few tries and then whatever came up last
+	int32 PickField(bool bRevealed)
+	{
+		int32 Index = Random.RandRange(0, Board.GetDims().Num() - 1);
+		for (int32 Try = 0; Try < 16 && Board.IsRevealed(Index) != bRevealed; Try++)
+		{
+			Index = Random.RandRange(0, Board.GetDims().Num() - 1);
+		}
+		return Index;
+	}
+
+	//Plays one random click, flag or chord, or a part of a pending cascade. Returns true if a move was recorded.
+	bool PlayRandomStep()
+	{
+		ChangedIndices.Reset();
+		if (Board.IsGameOver())
+		{
+			return false;
+		}
+
+		if (Board.HasPendingReveal() && Random.FRand() < 0.5f)
+		{
+			Board.ContinueReveal(ChangedIndices);
+			LogCascadeSteps();
+			return false;
+		}
+
+		const float Pick = Random.FRand();
+		if (Board.IsGenerated() && Pick < 0.2f)
+		{
+			const int32 Index = PickField(false);
+			if (Board.IsRevealed(Index) || !Board.CanToggleFlag(Index))
+			{
+				return false;
+			}
+			AppendMove(EMineMoveType::Flag, Index);
+			Board.ToggleFlag(Index, ChangedIndices);
+			return true;
+		}
+
+		if (Board.IsGenerated() && Pick < 0.3f)
+		{
+			const int32 Index = PickField(true);
+			if (!Board.CanChord(Index))
+			{
+				return false;
+			}
+			AppendMove(EMineMoveType::Chord, Index);
+			Board.Chord(Index, ChangedIndices);
+			LogPendingCascade();
+			return true;
+		}
+
+		const int32 Index = PickField(false);
+		if (!Board.CanClick(Index))
+		{
+			return false;
+		}
+		AppendMove(EMineMoveType::Click, Index);
+		if (!Board.IsGenerated())
+		{
+			Board.Generate(Index, Log.Seed);
+		}
+		Board.Click(Index, ChangedIndices);
+		LogPendingCascade();
+		return true;
+	}
+
+private:
+	void AppendMove(EMineMoveType Type, int32 Index)
+	{
+		HashesBeforeMoves.Add(Board.GetStateHash());
+		Log.Append(Type, Index);
+	}
+
+	void LogPendingCascade()
+	{
+		if (Board.HasPendingReveal())
+		{
+			LogCascadeSteps();
+		}
+	}
+
+	void LogCascadeSteps()
+	{
+		if (Board.GetLastRevealSteps() > 0)
+		{
+			Log.AppendCascade(Board.GetLastRevealSteps());
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,189 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MineBoardTopology.h"
+
+class FMineSweeperBoard;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+//Binary board file (.msb), all values little endian.
+//
+//  Header, 64 bytes
+//    0  uint32 Magic 'MSBF'          4  uint16 Version      6  uint16 HeaderSize (64)
+//    8  int32  Columns              12  int32  Rows (all layers)              16  int32 RowsPerLayer
+//   20  uint8  Topology             21  uint8  State (1 generated, 2 game over, 4 won)
+//   22  uint8  Compression (0 none, 1 zlib)                                   23  uint8 NumPlanes (3)
+//   24  int32  MineCount            28  int32  Seed         32  int32 HitMineIndex (-1 for none)
+//   36  int32  RowsPerTile          40  int32  NumTiles     44  int32 NumFlags
+//   48  int64  TileTableOffset      56  int32  NumHidden    60  int32 NumWrongFlags (flags on fields without a mine)
+//
+//  The counters are there since version 2, so a board can be played from the file without counting its fields first.
+//  Version 1 had zeros in their place.
+//
+//  Tiles, each a band of RowsPerTile whole rows (the last one can be shorter) stored as one bitplane per plane:
+//  mines, revealed, flags. Bit i of a plane is the field FirstRow * Columns + i, least significant bit first.
+//
+//  Tile table at TileTableOffset, NumTiles * NumPlanes entries ordered by tile and then plane:
+//    int64 Offset, int32 StoredSize, int32 RawSize. A tile is zlib compressed if StoredSize differs from RawSize.
+//
+//Uncompressed tiles are read straight from the mapped file, so a reader only faults in the pages of the tiles it touches.
+//
+//Text board file (.txt), for small boards and test fixtures. "key value" lines, then a line "board" followed by one line per row:
+//  '.' hidden   '*' hidden mine   'f' flag   'F' flag on a mine   '0'-'9' revealed number, '+' above 9   'x' revealed mine   'X' the mine that was hit
+class DETAILPANELCORE_API FMineBoardFile
+{
+public:
+	static constexpr uint32 Magic = 0x4642534D;
+	static constexpr uint16 Version = 2;
+	static constexpr int32 HeaderSize = 64;
+	static constexpr int32 NumPlanes = 3;
+
+	//Fields per tile the writer aims for, 64 KB per uncompressed plane
+	static constexpr int32 FieldsPerTile = 64 * 1024 * 8;
+
+	//Most bytes ReadTextHeader looks at for the keys
+	static constexpr int32 MaxTextHeaderSize = 4096;
+
+	enum class EPlane : uint8
+	{
+		Mines = 0,
+		Revealed = 1,
+		Flags = 2,
+	};
+
+	struct FHeader
+	{
+		FMineBoardDims Dims;
+		EMineBoardTopology Topology = EMineBoardTopology::Square8;
+		bool bGenerated = false;
+		bool bGameOver = false;
+		bool bHasWon = false;
+		bool bCompressed = false;
+		int32 MineCount = 0;
+		int32 Seed = 0;
+		int32 HitMineIndex = INDEX_NONE;
+		int32 RowsPerTile = 0;
+		int32 NumTiles = 0;
+		int64 TileTableOffset = 0;
+
+		//Set for files of version 2 and later, older ones have to be counted
+		bool bHasCounts = false;
+		int32 NumHidden = 0;
+		int32 NumFlags = 0;
+		int32 NumWrongFlags = 0;
+	};
+
+	struct FTileEntry
+	{
+		int64 Offset = 0;
+		int32 StoredSize = 0;
+		int32 RawSize = 0;
+	};
+
+	//Writes the binary format, tile by tile
+	static bool Save(const FString& Filename, const FMineSweeperBoard& Board, int32 Seed, bool bCompress = true);
+
+	static bool SaveText(const FString& Filename, const FMineSweeperBoard& Board, int32 Seed);
+
+	//Reads either format, .txt files are read as text
+	static bool Load(const FString& Filename, FMineSweeperBoard& OutBoard, int32& OutSeed);
+
+	static bool LoadText(const FString& Filename, FMineSweeperBoard& OutBoard, int32& OutSeed);
+
+	//Reads only the keys of a text file, so its size can be checked before the rows are. Sizes are not checked against MAX_int32 yet.
+	static bool ReadTextHeader(const FString& Filename, FHeader& OutHeader);
+
+	static bool IsTextFilename(const FString& Filename);
+};
+
+//Reads a binary board file through a memory mapping. Opening only reads the header and the tile table,
+//fields are read on demand and only the tiles they are in are paged in, or inflated if they are compressed.
+class DETAILPANELCORE_API FMineBoardFileReader
+{
+public:
+	FMineBoardFileReader() = default;
+	~FMineBoardFileReader();
+
+	FMineBoardFileReader(const FMineBoardFileReader&) = delete;
+	FMineBoardFileReader& operator=(const FMineBoardFileReader&) = delete;
+
+	bool Open(const FString& Filename);
+	void Close();
+
+	bool IsOpen() const { return Data != nullptr; }
+	const FMineBoardFile::FHeader& GetHeader() const { return Header; }
+
+	//Returns one bit of a field, false for fields outside the board or tiles that can't be read
+	bool GetField(FMineBoardFile::EPlane Plane, int32 Index) const;
+
+	//Reads the whole board, one tile at a time
+	bool ReadBoard(FMineSweeperBoard& OutBoard);
+
+	//Returns the raw bitplane of a tile, from the mapping or from the inflated copy of the plane's last tile.
+	//The copy only lives until the next tile of the same plane is read, so readers are not shared between threads.
+	const uint8* GetTileData(FMineBoardFile::EPlane Plane, int32 TileIndex) const;
+
+private:
+	bool ReadHeader(const FString& Filename);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	//Only used where the platform can't map files
+	TArray<uint8> FileBytes;
+
+	const uint8* Data = nullptr;
+	int64 DataSize = 0;
+
+	FMineBoardFile::FHeader Header;
+	TArray<FMineBoardFile::FTileEntry> TileTable;
+
+	mutable int32 InflatedTiles[FMineBoardFile::NumPlanes] = { INDEX_NONE, INDEX_NONE, INDEX_NONE };
+	mutable TArray<uint8> InflatedData[FMineBoardFile::NumPlanes];
+};
+
+//Fields of a binary board file played straight from its mapping, for boards too big to load into arrays.
+//Mines and the saved progress stay in the file and are read on demand. Only the changes made since opening are kept,
+//one bit per field for reveals and one for flags. Uncompressed files play best, compressed tiles are inflated one at a time.
+//FMineSweeperBoard::OpenMapped plays on these with the same rules as on its own arrays.
+class DETAILPANELCORE_API FMineMappedFields
+{
+public:
+	//Only files of generated boards can be played
+	bool Open(const FString& Filename);
+
+	const FMineBoardFile::FHeader& GetHeader() const { return Reader.GetHeader(); }
+	const FString& GetFilename() const { return Filename; }
+
+	bool IsMine(int32 Index) const { return Reader.GetField(FMineBoardFile::EPlane::Mines, Index); }
+	bool IsRevealed(int32 Index) const { return RevealedChanges[Index] || Reader.GetField(FMineBoardFile::EPlane::Revealed, Index); }
+	bool IsFlagged(int32 Index) const { return bool(FlagChanges[Index]) != Reader.GetField(FMineBoardFile::EPlane::Flags, Index); }
+
+	//Fields are only ever revealed, never hidden again
+	void Reveal(int32 Index);
+	void SetFlag(int32 Index, bool bFlagged);
+
+	//Kept up to date by the changes, so checking for a win doesn't walk the file
+	int32 GetNumHidden() const { return NumHidden; }
+	int32 GetNumFlags() const { return NumFlags; }
+	int32 GetNumWrongFlags() const { return NumWrongFlags; }
+
+	//Memory of the changes, the file is only mapped
+	SIZE_T GetAllocatedSize() const { return RevealedChanges.GetAllocatedSize() + FlagChanges.GetAllocatedSize(); }
+
+private:
+	//Version 1 files have no counters in the header, they are counted in one pass over the planes
+	bool CountFields();
+
+	FMineBoardFileReader Reader;
+	FString Filename;
+
+	//Set where a field differs from the file
+	TBitArray<> RevealedChanges;
+	TBitArray<> FlagChanges;
+
+	int32 NumHidden = 0;
+	int32 NumFlags = 0;
+	int32 NumWrongFlags = 0;
+};
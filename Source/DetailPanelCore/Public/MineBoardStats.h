@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//Difficulty metrics of a generated board, see FMineSweeperBoard::ComputeStats. FMineSweeperBoardStats is the Blueprint copy.
+struct DETAILPANELCORE_API FMineBoardStats
+{
+	//Fewest clicks that clear the board: one per opening plus one per numbered field no opening reveals
+	int32 ThreeBV = 0;
+
+	//Connected areas of fields without mines around, a click on one opens all of it and its border
+	int32 NumOpenings = 0;
+
+	//Connected groups of numbered fields no opening reveals, each has to be worked out on its own
+	int32 NumIslands = 0;
+
+	//Share of mine neighbours that are mines themselves, relative to the mine density. 1 for an even spread, more for clumps.
+	float MineClustering = 0.0f;
+
+	//Set if bGuessFree was worked out, it needs the first click
+	bool bGuessFreeChecked = false;
+
+	//The board can be cleared from the first click by looking at one number at a time, without guessing.
+	//Boards that need more involved reasoning count as not guess free.
+	bool bGuessFree = false;
+};
+
+//Range of difficulties new boards are picked from. Boards are generated with new seeds until one fits or MaxAttempts ran out,
+//then the last one is kept.
+struct DETAILPANELCORE_API FMineDifficultyFilter
+{
+	bool bEnabled = false;
+	int32 MinThreeBV = 0;
+	//0 for no upper limit
+	int32 MaxThreeBV = 0;
+	bool bRequireGuessFree = false;
+	int32 MaxAttempts = 64;
+
+	bool Matches(const FMineBoardStats& Stats) const
+	{
+		return Stats.ThreeBV >= MinThreeBV && (MaxThreeBV <= 0 || Stats.ThreeBV <= MaxThreeBV)
+			&& (!bRequireGuessFree || (Stats.bGuessFreeChecked && Stats.bGuessFree));
+	}
+};
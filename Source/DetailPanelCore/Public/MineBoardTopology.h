@@ -0,0 +1,217 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+//How fields of a board are connected to each other. A plain enum so the core builds without UObjects,
+//EMineSweeperTopology is the one actors and Blueprints see.
+enum class EMineBoardTopology : uint8
+{
+	//The classic board, 8 neighbours
+	Square8,
+	//Hexagonal fields with odd rows shifted half a field to the right, 6 neighbours
+	Hex6,
+	//Square fields where the edges wrap around to the opposite side, 8 neighbours
+	Torus8,
+	//Stacked layers of square fields, 26 neighbours. The layers are laid out below each other in rows.
+	Cube26,
+
+	Num
+};
+
+//Names as written to text board files
+inline const TCHAR* LexToString(EMineBoardTopology Topology)
+{
+	switch (Topology)
+	{
+	case EMineBoardTopology::Hex6:
+		return TEXT("Hex6");
+	case EMineBoardTopology::Torus8:
+		return TEXT("Torus8");
+	case EMineBoardTopology::Cube26:
+		return TEXT("Cube26");
+	case EMineBoardTopology::Square8:
+	default:
+		return TEXT("Square8");
+	}
+}
+
+//Returns false for names no topology has
+inline bool LexTryParseString(EMineBoardTopology& OutTopology, const TCHAR* Name)
+{
+	for (uint8 Value = 0; Value < uint8(EMineBoardTopology::Num); Value++)
+	{
+		if (FCString::Stricmp(Name, LexToString(EMineBoardTopology(Value))) == 0)
+		{
+			OutTopology = EMineBoardTopology(Value);
+			return true;
+		}
+	}
+	return false;
+}
+
+//Board extents as seen by the topology policies.
+//Rows is the total number of rows, for Cube26 that is RowsPerLayer * number of layers.
+struct FMineBoardDims
+{
+	int32 Columns = 0;
+	int32 Rows = 0;
+	int32 RowsPerLayer = 0;
+
+	FORCEINLINE int32 Num() const { return Columns * Rows; }
+	FORCEINLINE int32 ToIndex(int32 Col, int32 Row) const { return Row * Columns + Col; }
+};
+
+//Topology policies. Every policy has a constexpr neighbour table and a ForEachNeighbour that calls
+//Func(NeighbourCol, NeighbourRow, NeighbourIndex) for every neighbour inside the board.
+//The board code is templated on these, so each topology gets its own unrolled kernel.
+
+struct FMineTopologySquare8
+{
+	static constexpr EMineBoardTopology Topology = EMineBoardTopology::Square8;
+	static constexpr int32 NumNeighbours = 8;
+	static constexpr int8 Offsets[NumNeighbours][2] = { {-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1} };
+
+	template<typename FuncType>
+	static FORCEINLINE void ForEachNeighbour(const FMineBoardDims& Dims, int32 Col, int32 Row, FuncType&& Func)
+	{
+		for (int32 i = 0; i < NumNeighbours; i++)
+		{
+			const int32 NeighbourCol = Col + Offsets[i][0];
+			const int32 NeighbourRow = Row + Offsets[i][1];
+			if (uint32(NeighbourCol) < uint32(Dims.Columns) && uint32(NeighbourRow) < uint32(Dims.Rows))
+			{
+				Func(NeighbourCol, NeighbourRow, Dims.ToIndex(NeighbourCol, NeighbourRow));
+			}
+		}
+	}
+};
+
+struct FMineTopologyHex6
+{
+	static constexpr EMineBoardTopology Topology = EMineBoardTopology::Hex6;
+	static constexpr int32 NumNeighbours = 6;
+	//Indexed by row parity, odd rows are shifted to the right
+	static constexpr int8 Offsets[2][NumNeighbours][2] =
+	{
+		{ {-1, 0}, {1, 0}, {-1, -1}, {0, -1}, {-1, 1}, {0, 1} },
+		{ {-1, 0}, {1, 0}, {0, -1}, {1, -1}, {0, 1}, {1, 1} },
+	};
+
+	template<typename FuncType>
+	static FORCEINLINE void ForEachNeighbour(const FMineBoardDims& Dims, int32 Col, int32 Row, FuncType&& Func)
+	{
+		const int8 (&RowOffsets)[NumNeighbours][2] = Offsets[Row & 1];
+		for (int32 i = 0; i < NumNeighbours; i++)
+		{
+			const int32 NeighbourCol = Col + RowOffsets[i][0];
+			const int32 NeighbourRow = Row + RowOffsets[i][1];
+			if (uint32(NeighbourCol) < uint32(Dims.Columns) && uint32(NeighbourRow) < uint32(Dims.Rows))
+			{
+				Func(NeighbourCol, NeighbourRow, Dims.ToIndex(NeighbourCol, NeighbourRow));
+			}
+		}
+	}
+};
+
+struct FMineTopologyTorus8
+{
+	static constexpr EMineBoardTopology Topology = EMineBoardTopology::Torus8;
+	static constexpr int32 NumNeighbours = 8;
+	static constexpr int8 Offsets[NumNeighbours][2] = { {-1, -1}, {0, -1}, {1, -1}, {-1, 0}, {1, 0}, {-1, 1}, {0, 1}, {1, 1} };
+
+	template<typename FuncType>
+	static FORCEINLINE void ForEachNeighbour(const FMineBoardDims& Dims, int32 Col, int32 Row, FuncType&& Func)
+	{
+		//Below 3 fields in a direction the wrap reaches the same neighbour twice or the field itself
+		if (Dims.Columns < 3 || Dims.Rows < 3)
+		{
+			ForEachNeighbourSmall(Dims, Col, Row, Func);
+			return;
+		}
+
+		for (int32 i = 0; i < NumNeighbours; i++)
+		{
+			int32 NeighbourCol = Col + Offsets[i][0];
+			int32 NeighbourRow = Row + Offsets[i][1];
+			NeighbourCol += NeighbourCol < 0 ? Dims.Columns : (NeighbourCol >= Dims.Columns ? -Dims.Columns : 0);
+			NeighbourRow += NeighbourRow < 0 ? Dims.Rows : (NeighbourRow >= Dims.Rows ? -Dims.Rows : 0);
+			Func(NeighbourCol, NeighbourRow, Dims.ToIndex(NeighbourCol, NeighbourRow));
+		}
+	}
+
+	//Same without duplicates and without the field itself
+	template<typename FuncType>
+	static FORCENOINLINE void ForEachNeighbourSmall(const FMineBoardDims& Dims, int32 Col, int32 Row, FuncType& Func)
+	{
+		const int32 Index = Dims.ToIndex(Col, Row);
+		int32 Seen[NumNeighbours];
+		int32 NumSeen = 0;
+		for (int32 i = 0; i < NumNeighbours; i++)
+		{
+			const int32 NeighbourCol = (Col + Offsets[i][0] + Dims.Columns) % Dims.Columns;
+			const int32 NeighbourRow = (Row + Offsets[i][1] + Dims.Rows) % Dims.Rows;
+			const int32 NeighbourIndex = Dims.ToIndex(NeighbourCol, NeighbourRow);
+
+			bool bSeen = NeighbourIndex == Index;
+			for (int32 SeenIndex = 0; SeenIndex < NumSeen && !bSeen; SeenIndex++)
+			{
+				bSeen = Seen[SeenIndex] == NeighbourIndex;
+			}
+			if (!bSeen)
+			{
+				Seen[NumSeen++] = NeighbourIndex;
+				Func(NeighbourCol, NeighbourRow, NeighbourIndex);
+			}
+		}
+	}
+};
+
+struct FMineTopologyCube26
+{
+	static constexpr EMineBoardTopology Topology = EMineBoardTopology::Cube26;
+	static constexpr int32 NumNeighbours = 26;
+	static constexpr int8 Offsets[NumNeighbours][3] =
+	{
+		{-1, -1, -1}, {0, -1, -1}, {1, -1, -1}, {-1, 0, -1}, {0, 0, -1}, {1, 0, -1}, {-1, 1, -1}, {0, 1, -1}, {1, 1, -1},
+		{-1, -1, 0}, {0, -1, 0}, {1, -1, 0}, {-1, 0, 0}, {1, 0, 0}, {-1, 1, 0}, {0, 1, 0}, {1, 1, 0},
+		{-1, -1, 1}, {0, -1, 1}, {1, -1, 1}, {-1, 0, 1}, {0, 0, 1}, {1, 0, 1}, {-1, 1, 1}, {0, 1, 1}, {1, 1, 1},
+	};
+
+	template<typename FuncType>
+	static FORCEINLINE void ForEachNeighbour(const FMineBoardDims& Dims, int32 Col, int32 Row, FuncType&& Func)
+	{
+		const int32 Layer = Row / Dims.RowsPerLayer;
+		const int32 LayerRow = Row - Layer * Dims.RowsPerLayer;
+		const int32 NumLayers = Dims.Rows / Dims.RowsPerLayer;
+		for (int32 i = 0; i < NumNeighbours; i++)
+		{
+			const int32 NeighbourCol = Col + Offsets[i][0];
+			const int32 NeighbourLayerRow = LayerRow + Offsets[i][1];
+			const int32 NeighbourLayer = Layer + Offsets[i][2];
+			if (uint32(NeighbourCol) < uint32(Dims.Columns) && uint32(NeighbourLayerRow) < uint32(Dims.RowsPerLayer) && uint32(NeighbourLayer) < uint32(NumLayers))
+			{
+				const int32 NeighbourRow = NeighbourLayer * Dims.RowsPerLayer + NeighbourLayerRow;
+				Func(NeighbourCol, NeighbourRow, Dims.ToIndex(NeighbourCol, NeighbourRow));
+			}
+		}
+	}
+};
+
+//Calls Func with a default constructed policy for the topology. This is the only place that branches on the topology,
+//everything below it is compiled once per policy.
+template<typename FuncType>
+FORCEINLINE decltype(auto) DispatchMineTopology(EMineBoardTopology Topology, FuncType&& Func)
+{
+	switch (Topology)
+	{
+	case EMineBoardTopology::Hex6:
+		return Func(FMineTopologyHex6());
+	case EMineBoardTopology::Torus8:
+		return Func(FMineTopologyTorus8());
+	case EMineBoardTopology::Cube26:
+		return Func(FMineTopologyCube26());
+	case EMineBoardTopology::Square8:
+	default:
+		return Func(FMineTopologySquare8());
+	}
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MineBoardTopology.h"
+#include "MineSweeperBoard.h"
+
+enum class EMineMoveType : uint8
+{
+	Click = 0,
+	Flag = 1,
+	Chord = 2,
+	//Not a move. Part of a budgeted cascade, the value is the number of pending fields it took off the stack.
+	Cascade = 3,
+};
+
+//Append only record of a single board. Holds what is needed to generate the board again (size, topology, mine chance, seed)
+//followed by the moves, each one a varint of (FieldIndex << 2 | MoveType). Most moves take 1-3 bytes.
+//The first move is always the click that placed the mines.
+//Cascades cut by a reveal budget are recorded as Cascade entries: one right after the click or chord that left fields pending,
+//then one for every ContinueReveal. Moves made in between land where they were made, so replays cut the cascade at the same fields.
+struct DETAILPANELCORE_API FMineMoveLog
+{
+	//Bumped whenever the encoding changes
+	static constexpr int32 Version = 4;
+
+	int32 ColumnNum = 0;
+	int32 RowNum = 0;
+	int32 LayerNum = 1;
+	EMineBoardTopology Topology = EMineBoardTopology::Square8;
+	float MineChance = 0.0f;
+	int32 Seed = 0;
+	int32 NumMoves = 0;
+	TArray<uint8> Data;
+
+	//Starts a new log for a freshly generated board
+	void Begin(int32 InColumnNum, int32 InRowNum, int32 InLayerNum, EMineBoardTopology InTopology, float InMineChance, int32 InSeed);
+
+	void Reset();
+
+	void Append(EMineMoveType Type, int32 FieldIndex);
+
+	//Records a part of a cascade, doesn't count as a move
+	void AppendCascade(int32 NumSteps);
+
+	bool IsEmpty() const { return ColumnNum == 0 || RowNum == 0; }
+
+	//False for logs whose size, topology or mine chance no board can have, logs from files are checked before they are played
+	bool IsValid() const;
+
+	//Size of the recorded board, LayerNum layers of RowNum rows
+	FMineBoardDims GetDims() const;
+
+	//Reads the move starting at ByteOffset and advances the offset. Returns false at the end of the log.
+	//For Cascade entries OutFieldIndex is the number of steps.
+	bool ReadMove(int32& ByteOffset, EMineMoveType& OutType, int32& OutFieldIndex) const;
+
+	//For bug repros and regression corpora
+	bool SaveToFile(const FString& Filename) const;
+	bool LoadFromFile(const FString& Filename);
+
+	friend FArchive& operator<<(FArchive& Ar, FMineMoveLog& Log);
+
+private:
+	void WriteEntry(EMineMoveType Type, int32 Value);
+};
+
+//Plays a move log back on a plain FMineSweeperBoard, without an actor, replication or listeners around it.
+//Keyframes of the board state are taken every KeyframeInterval moves while stepping forward,
+//so seeking only replays the moves between the closest keyframe and the target.
+//A step plays one move together with the cascade parts recorded before the next move. Keyframes are skipped while a cascade is pending.
+class DETAILPANELCORE_API FMineReplay
+{
+public:
+	FMineReplay(const FMineMoveLog& InLog, int32 InKeyframeInterval = 256);
+
+	//False if the log can't be played, see FMineMoveLog::IsValid. The board stays empty then.
+	bool IsValid() const { return bValid; }
+
+	//Applies the next move, returns false at the end of the log or at a move outside the board
+	bool Step();
+
+	//Plays until the end of the log
+	void StepToEnd();
+
+	//Brings the board to the state right after MoveIndex moves
+	void SeekTo(int32 MoveIndex);
+
+	int32 GetMoveIndex() const { return MoveIndex; }
+	int32 GetNumMoves() const { return Log.NumMoves; }
+
+	//The board in the replayed state
+	const FMineSweeperBoard& GetBoard() const { return Board; }
+
+private:
+	struct FKeyframe
+	{
+		int32 MoveIndex = 0;
+		int32 ByteOffset = 0;
+		bool bBoardGenerated = false;
+		TArray<bool> RevealedArray;
+		TSet<int32> FlagedIndices;
+		int32 HitMineIndex = -1;
+		bool bGameOver = false;
+		bool bHasWon = false;
+	};
+
+	void Restart();
+	void AddKeyframe();
+	void ContinueCascades();
+	void RestoreKeyframe(const FKeyframe& Keyframe);
+
+	FMineMoveLog Log;
+	int32 KeyframeInterval;
+	TArray<FKeyframe> Keyframes;
+	FMineSweeperBoard Board;
+	int32 MoveIndex = 0;
+	int32 ByteOffset = 0;
+	bool bValid = false;
+	//The click that placed the mines, to place them again when a keyframe is restored on a board that was reset
+	int32 FirstClickIndex = INDEX_NONE;
+	//Fields the last move changed, nobody listens to them but the board needs somewhere to put them
+	TArray<int32> ChangedIndices;
+};
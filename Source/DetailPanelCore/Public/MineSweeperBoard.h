@@ -0,0 +1,263 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MineBoardTopology.h"
+#include "MineBoardStats.h"
+#include "MineBoardFile.h"
+
+//The rules of a single board: placing the mines, revealing, flags, chords and the win check.
+//Part of DetailPanelCore, which only depends on Core, so it can be played and measured without an actor, a world or the engine.
+//Fields are addressed by index, row by row. Every move appends the fields it changed to OutChangedIndices.
+//With a reveal budget set, a cascade stops once the budget is used up and the rest is left pending for ContinueReveal.
+//Pending fields are plain hidden fields to everything else, so moves in between work as usual.
+//Placing the mines also labels the zero regions, so a cascade opens a whole region from a precomputed list instead of searching it.
+//A board can also be played from a mapped board file, see OpenMapped. The same rules then read and change the fields through
+//FMineMappedFields instead of the arrays, and cascades search without zero regions.
+//AMineSweeperActor wraps one of these and adds the settings, replication, the move log and the in world board.
+class DETAILPANELCORE_API FMineSweeperBoard
+{
+public:
+	//Starts over with no mines placed, the first click places them
+	void Reset(const FMineBoardDims& InDims, EMineBoardTopology InTopology, int32 InMineCount);
+
+	//Plays a binary board file of a generated board from its mapping instead of loading it, for boards too big for the arrays.
+	//Returns false and leaves the board as it was if the file can't be mapped. Anything that replaces the board drops the mapping.
+	bool OpenMapped(const FString& Filename);
+
+	bool IsMapped() const { return MappedFields.IsValid(); }
+
+	//The file a mapped board is played from, empty otherwise
+	FString GetMappedFilename() const { return MappedFields ? MappedFields->GetFilename() : FString(); }
+
+	//Places the mines from a stream seeded with InSeed, keeping SafeIndex and its neighbours free.
+	//Places fewer mines than asked for if there is not enough room left.
+	void Generate(int32 SafeIndex, int32 InSeed);
+
+	bool CanClick(int32 Index) const;
+
+	//Places the mines if this is the first click, then reveals the field or ends the game if it is a mine
+	void Click(int32 Index, TArray<int32>& OutChangedIndices);
+
+	bool CanToggleFlag(int32 Index) const;
+
+	//Adds or removes a flag, there are never more flags than mines
+	void ToggleFlag(int32 Index, TArray<int32>& OutChangedIndices);
+
+	//True for a revealed number with as many flags around it as its number
+	bool CanChord(int32 Index) const;
+
+	//Number of flags around a field
+	int32 CountNeighbourFlags(int32 Index) const;
+
+	//Reveals all unflagged neighbours, a wrong flag among them ends the game
+	void Chord(int32 Index, TArray<int32>& OutChangedIndices);
+
+	//The game is won once every mine is flagged and every other field is revealed.
+	//Flags and reveals check it themselves, so the board is always up to date without anyone calling this.
+	bool CheckAndUpdateHasWon();
+
+	//Limits how many fields and how much time one move or one ContinueReveal spends on a cascade, 0 for no limit
+	void SetRevealBudget(int32 InMaxRevealFields, double InMaxRevealSeconds);
+
+	//Stops a cascade after that many fields were taken off the pending stack, 0 for no limit.
+	//Replays use it to cut a cascade exactly where the recorded game's budget cut it.
+	void SetRevealStepLimit(int32 InMaxRevealSteps);
+
+	//Fields the last move or ContinueReveal took off the pending stack, revealed or not
+	int32 GetLastRevealSteps() const { return LastRevealSteps; }
+
+	bool HasPendingReveal() const { return PendingReveal.Num() > 0; }
+
+	//Reveals the next part of a pending cascade within the budget
+	void ContinueReveal(TArray<int32>& OutChangedIndices);
+
+	//Drops a pending cascade, the fields it did not reach stay hidden
+	void CancelReveal();
+
+	//Number of mines around a field, -1 for a mine. Needs the mines to be known.
+	int32 CalculateFieldNumber(int32 Index) const;
+
+	//Same for a known topology, for loops that dispatch once and not per field
+	template<typename TTopology>
+	FORCEINLINE int32 CountNeighbourMines(int32 ColIndex, int32 RowIndex) const
+	{
+		int32 Count = 0;
+		if (MappedFields)
+		{
+			TTopology::ForEachNeighbour(Dims, ColIndex, RowIndex, [&Count, this](int32, int32, int32 NeighbourIndex)
+			{
+				Count += MappedFields->IsMine(NeighbourIndex) ? 1 : 0;
+			});
+			return Count;
+		}
+
+		const bool* MineData = Mines.GetData();
+		TTopology::ForEachNeighbour(Dims, ColIndex, RowIndex, [&Count, MineData](int32, int32, int32 NeighbourIndex)
+		{
+			Count += MineData[NeighbourIndex];
+		});
+		return Count;
+	}
+
+	const FMineBoardDims& GetDims() const { return Dims; }
+	EMineBoardTopology GetTopology() const { return Topology; }
+	int32 GetMineCount() const { return MineCount; }
+	int32 GetHitMineIndex() const { return HitMineIndex; }
+	bool IsGenerated() const { return bGenerated; }
+	bool IsGameOver() const { return bGameOver; }
+	bool HasWon() const { return bHasWon; }
+
+	bool IsValidIndex(int32 Index) const { return uint32(Index) < uint32(Dims.Num()); }
+
+	//False on clients until the server sends the mines at the end of the game, and before the first click
+	bool KnowsMines() const { return MappedFields || (Mines.Num() > 0 && Mines.Num() == Revealed.Num()); }
+
+	bool IsMine(int32 Index) const
+	{
+		return MappedFields ? IsValidIndex(Index) && MappedFields->IsMine(Index) : Mines.IsValidIndex(Index) && Mines[Index];
+	}
+
+	//A lost mapped board counts as revealed everywhere, EndGame doesn't write every field of the file
+	bool IsRevealed(int32 Index) const
+	{
+		return MappedFields ? IsValidIndex(Index) && ((bGameOver && !bHasWon) || MappedFields->IsRevealed(Index)) : Revealed.IsValidIndex(Index) && Revealed[Index];
+	}
+
+	bool IsFlagged(int32 Index) const { return MappedFields ? IsValidIndex(Index) && MappedFields->IsFlagged(Index) : Flags.Contains(Index); }
+
+	int32 GetNumFlags() const { return MappedFields ? MappedFields->GetNumFlags() : Flags.Num(); }
+
+	//A flag on a field without a mine, or the mine that ended the game
+	bool IsCrossed(int32 Index) const;
+
+	//Zobrist hash of the size, the mine count, the mines, the revealed fields and the flags. Every move updates it for the fields it changed.
+	//Equal states always have equal hashes, so it can key caches of anything derived from the state.
+	uint64 GetStateHash() const { return StateHash; }
+
+	//False on clients during a game, their hash is missing the mines they don't know yet.
+	//Also false for mapped boards, their hash only has the changes made since the file was opened.
+	bool IsStateHashComplete() const { return !MappedFields && (KnowsMines() || !bGenerated); }
+
+	//Empty for mapped boards, use the per field functions there
+	const TArray<bool>& GetMines() const { return Mines; }
+	const TArray<bool>& GetRevealed() const { return Revealed; }
+	const TSet<int32>& GetFlags() const { return Flags; }
+
+	//Difficulty metrics of the mines, worked out over bands of rows in parallel from the zero regions.
+	//With a valid StartIndex it also checks whether the board can be cleared from a click there without guessing, which runs
+	//on one thread and is the expensive part. Builds the zero regions if they are missing. Empty stats until the mines are known, and for mapped boards.
+	//Scoring candidate layouts is Reset, Generate and ComputeStats on one board per seed.
+	FMineBoardStats ComputeStats(int32 StartIndex = INDEX_NONE);
+
+	//Heap bytes the board holds right now, the changes of a mapped board but not its file
+	SIZE_T GetAllocatedSize() const;
+
+	//Rough peak of heap bytes a board of NumFields needs once it is played, with the temporary arrays of Generate,
+	//the zero regions and a cascade over the whole board. Used to check boards against the budget before they are allocated.
+	static int64 EstimateGeneratedSize(int64 NumFields);
+
+	//Same for a board of NumFields played from its mapping, the change bits and a cascade over the whole board
+	static int64 EstimateMappedSize(int64 NumFields);
+
+	//Number of mines a share of MineChance gives on a board of NumFields, the same for the actor and replays
+	static int32 CalcMineCount(float MineChance, int32 NumFields);
+
+	//Client side. The state arrives from the server field by field instead of being played, these take it as it is.
+	void ResetMirror(const FMineBoardDims& InDims, EMineBoardTopology InTopology);
+	void SetFieldState(int32 Index, bool bInRevealed, bool bInFlagged);
+	//An empty array forgets the mines again
+	void SetMines(TArray<bool>&& InMines);
+	void SetGameState(int32 InMineCount, bool bInGenerated, bool bInGameOver, bool bInHasWon, int32 InHitMineIndex);
+
+	//Puts back everything moves change, for replay keyframes. The mines stay as they are. Not for mapped boards.
+	void RestoreProgress(const TArray<bool>& InRevealed, const TSet<int32>& InFlags, int32 InHitMineIndex, bool bInGameOver, bool bInHasWon);
+
+	//Takes a whole board as it was stored in a board file. Empty mines are a board that was not generated yet.
+	void RestoreBoard(const FMineBoardDims& InDims, EMineBoardTopology InTopology, int32 InMineCount, TArray<bool>&& InMines, TArray<bool>&& InRevealed, TSet<int32>&& InFlags,
+		int32 InHitMineIndex, bool bInGameOver, bool bInHasWon);
+
+	friend DETAILPANELCORE_API FArchive& operator<<(FArchive& Ar, FMineSweeperBoard& Board);
+
+private:
+	//How the cascade reads and reveals fields, in the arrays or in the mapped file
+	struct FArrayFieldAccess;
+	struct FMappedFieldAccess;
+
+	//Reveals the whole board after a mine was hit. A mapped board only ends the game and lists no fields, see IsRevealed.
+	void EndGame(int32 HitIndex, TArray<int32>& OutChangedIndices);
+
+	//Sets or clears a flag in either storage and keeps the region counts and the hash up to date
+	void SetFlag(int32 Index, bool bFlagged);
+
+	//Hashes the whole state again, for the changes that replace it all at once
+	void RecalculateStateHash();
+
+	//Adds the fields to the cascade and works on it within the budget
+	void RevealFields(TArrayView<const int32> StartIndices, TArray<int32>& OutChangedIndices);
+
+	//Reveals pending fields and queues the regions of the ones that have no mines around, compiled once per topology and field access.
+	//Without zero regions it queues the neighbours of those fields instead.
+	template<typename TTopology, typename TFieldAccess>
+	void RevealPendingKernel(TFieldAccess Fields, TArray<int32>& OutChangedIndices);
+
+	//Labels the connected areas of fields without mines around and lists the fields and the numbered border of each
+	void BuildZeroRegions();
+
+	template<typename TTopology>
+	void BuildZeroRegionsKernel();
+
+	//Forgets the regions, they are built again by the next cascade
+	void ResetZeroRegions();
+
+	//Calls Func once for every zero region a field belongs to or borders
+	template<typename TTopology, typename FuncType>
+	void ForEachRegionAround(int32 Index, FuncType&& Func) const;
+
+	template<typename TTopology>
+	void ComputeStatsKernel(FMineBoardStats& OutStats) const;
+
+	//Plays the board from StartIndex with single number deductions only, true if that clears it
+	template<typename TTopology>
+	bool IsGuessFreeKernel(int32 StartIndex) const;
+
+	void CountRegionFlags();
+	void UpdateRegionFlags(int32 Index, int32 Delta);
+
+	FMineBoardDims Dims;
+	EMineBoardTopology Topology = EMineBoardTopology::Square8;
+	int32 MineCount = 0;
+	int32 HitMineIndex = INDEX_NONE;
+	bool bGenerated = false;
+	bool bGameOver = false;
+	bool bHasWon = false;
+	uint64 StateHash = 0;
+
+	TArray<bool> Mines;
+	TArray<bool> Revealed;
+	TSet<int32> Flags;
+
+	int32 MaxRevealFields = 0;
+	double MaxRevealSeconds = 0.0;
+	int32 MaxRevealSteps = 0;
+	int32 LastRevealSteps = 0;
+
+	//Fields of the running cascade still to be revealed. A field is marked visited when it is queued so it is never queued twice.
+	TArray<int32> PendingReveal;
+	TBitArray<> PendingVisited;
+
+	//Regions the running cascade already queued
+	TBitArray<> PendingRegions;
+
+	//Zero region of every field, INDEX_NONE for mines and numbered fields. Empty until the regions are built.
+	TArray<int32> ZeroRegions;
+
+	//The fields of region i followed by its numbered border are RegionFields[RegionOffsets[i]] to RegionFields[RegionOffsets[i + 1] - 1]
+	TArray<int32> RegionOffsets;
+	TArray<int32> RegionFields;
+
+	//Flags on or around every region. A cascade searches around the flags of a region instead of opening all of it.
+	TArray<int32> RegionFlagCounts;
+
+	//Set while the board is played from a file, the arrays above stay empty then
+	TUniquePtr<FMineMappedFields> MappedFields;
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+//Boards, their snapshots and the details panel widgets show up under this tag in LLM.
+//Only needs Core, so the board core can use it too.
+LLM_DECLARE_TAG_API(MineSweeper, DETAILPANELCORE_API);
@@ -0,0 +1,25 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+//Console program that runs the board tests and benchmarks of DetailPanelCore without the engine, the editor or a world
+public class DetailPanelCoreTestsTarget : TargetRules
+{
+	public DetailPanelCoreTestsTarget( TargetInfo Target) : base(Target)
+	{
+		Type = TargetType.Program;
+		LinkType = TargetLinkType.Monolithic;
+		DefaultBuildSettings = BuildSettingsVersion.V2;
+		LaunchModuleName = "DetailPanelCoreTests";
+
+		bCompileAgainstEngine = false;
+		bCompileAgainstCoreUObject = false;
+		bCompileAgainstApplicationCore = false;
+		bCompileICU = false;
+		bIsBuildingConsoleApplication = true;
+
+		//The tests are only compiled for targets that ask for them
+		bForceCompileDevelopmentAutomationTests = true;
+	}
+}
@@ -0,0 +1,110 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+#include "RequiredProgramMainCPPInclude.h"
+#include "Misc/AutomationTest.h"
+
+//Runs the DetailPanelCore automation tests and prints what they logged.
+//DetailPanelCoreTests [TestNamePrefix] [-perf]
+//The prefix defaults to all board tests, -perf adds the benchmarks. Returns 1 if a test failed.
+
+DEFINE_LOG_CATEGORY_STATIC(DetailPanelCoreTests, Log, All);
+
+IMPLEMENT_APPLICATION(DetailPanelCoreTests, "DetailPanelCoreTests");
+
+namespace DetailPanelCoreTests
+{
+	static bool RunTests(const FString& Prefix, bool bWithBenchmarks)
+	{
+		FAutomationTestFramework& Framework = FAutomationTestFramework::Get();
+		if (bWithBenchmarks)
+		{
+			Framework.SetRequestedTestFilter(EAutomationTestFlags::ProductFilter | EAutomationTestFlags::PerfFilter);
+		}
+		else
+		{
+			Framework.SetRequestedTestFilter(EAutomationTestFlags::ProductFilter);
+		}
+
+		TArray<FAutomationTestInfo> TestInfos;
+		Framework.GetValidTestNames(TestInfos);
+
+		int32 NumRun = 0;
+		int32 NumFailed = 0;
+		for (const FAutomationTestInfo& TestInfo : TestInfos)
+		{
+			const FString TestName = TestInfo.GetFullTestPath();
+			if (!TestName.StartsWith(Prefix))
+			{
+				continue;
+			}
+
+			const double StartTime = FPlatformTime::Seconds();
+			Framework.StartTestByName(TestInfo.GetTestName(), 0);
+			FAutomationTestExecutionInfo ExecutionInfo;
+			const bool bSuccess = Framework.StopTest(ExecutionInfo);
+			NumRun++;
+
+			for (const FAutomationExecutionEntry& Entry : ExecutionInfo.GetEntries())
+			{
+				if (Entry.Event.Type == EAutomationEventType::Error)
+				{
+					UE_LOG(DetailPanelCoreTests, Error, TEXT("%s: %s"), *TestName, *Entry.Event.Message);
+				}
+				else if (Entry.Event.Type == EAutomationEventType::Warning)
+				{
+					UE_LOG(DetailPanelCoreTests, Warning, TEXT("%s: %s"), *TestName, *Entry.Event.Message);
+				}
+				else
+				{
+					UE_LOG(DetailPanelCoreTests, Display, TEXT("%s: %s"), *TestName, *Entry.Event.Message);
+				}
+			}
+
+			if (!bSuccess)
+			{
+				NumFailed++;
+			}
+			UE_LOG(DetailPanelCoreTests, Display, TEXT("%s %s in %.2f s"), *TestName, bSuccess ? TEXT("passed") : TEXT("failed"),
+				FPlatformTime::Seconds() - StartTime);
+		}
+
+		if (NumRun == 0)
+		{
+			UE_LOG(DetailPanelCoreTests, Error, TEXT("No test starts with %s"), *Prefix);
+			return false;
+		}
+		UE_LOG(DetailPanelCoreTests, Display, TEXT("%d of %d tests passed"), NumRun - NumFailed, NumRun);
+		return NumFailed == 0;
+	}
+}
+
+INT32_MAIN_INT32_ARGC_TCHAR_ARGV()
+{
+	FTaskTagScope Scope(ETaskTag::EGameThread);
+	ON_SCOPE_EXIT
+	{
+		LLM(FLowLevelMemTracker::Get().UpdateStatsPerFrame());
+		RequestEngineExit(TEXT("Exiting"));
+		FEngineLoop::AppPreExit();
+		FModuleManager::Get().UnloadModulesAtShutdown();
+		FEngineLoop::AppExit();
+	};
+
+	const FString CommandLine = FCommandLine::BuildFromArgV(nullptr, ArgC, ArgV, nullptr);
+	if (GEngineLoop.PreInit(*CommandLine) != 0)
+	{
+		return 1;
+	}
+
+	FString Prefix = TEXT("Project.DetailPanel.MineSweeper.Board");
+	TArray<FString> Tokens;
+	TArray<FString> Switches;
+	FCommandLine::Parse(*CommandLine, Tokens, Switches);
+	if (Tokens.Num() > 0)
+	{
+		Prefix = Tokens[0];
+	}
+	const bool bWithBenchmarks = Switches.Contains(TEXT("perf"));
+
+	return DetailPanelCoreTests::RunTests(Prefix, bWithBenchmarks) ? 0 : 1;
+}
@@ -10,6 +10,6 @@ public class DetailPanelEditor : ModuleRules
 	
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" , "DetailPanel", "EditorStyle" , "PropertyEditor" , "UnrealEd"});
+		PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" , "DetailPanel", "DetailPanelCore", "EditorStyle" , "PropertyEditor" , "UnrealEd"});
 	}
 }
@@ -0,0 +1,258 @@
+#include "DetailPanelEditor.h"
+#include "MineSweeperGrid.h"
+#include "DetailPanel/Public/MineSweeperActor.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Framework/Application/SlateApplication.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformTime.h"
+#include "IDetailsView.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "PropertyEditorModule.h"
+#include "Widgets/SWindow.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+//Measures what the minesweeper details panel costs to build, to keep open and to react to clicks, for a list of board sizes.
+//Every board is spawned into a world of its own and shown in its own details view inside a window of its own.
+//Clicks are sent as mouse events to the cells the grid shows, so they take the same path as a user's click, and are timed until
+//the panel painted the result. The results go to the test log and to a CSV file in Saved/MineSweeper.
+//Run it from the Session Frontend or with -ExecCmds="Automation RunTests Project.DetailPanel.MineSweeper.DetailsBenchmark".
+namespace MineSweeperDetailsBenchmark
+{
+	static const int32 Sizes[] = { 10, 25, 50, 100, 200 };
+
+	//Frames to let the panel settle before measuring, the grid materializes its cells over the first frames
+	static constexpr int32 WarmupFrames = 10;
+
+	static constexpr int32 MeasuredFrames = 60;
+	static constexpr int32 MeasuredClicks = 50;
+
+	struct FResult
+	{
+		int32 Size = 0;
+		double BuildMs = 0.0;
+		double PrepassMs = 0.0;
+		double FrameMs = 0.0;
+		int32 NumWidgets = 0;
+		int32 NumCells = 0;
+		int64 MemoryKB = 0;
+		double ClickMedianMs = 0.0;
+		double ClickMaxMs = 0.0;
+		int32 NumClicks = 0;
+		//Clicks on a clickable field that did not change the board, the event did not reach the cell
+		int32 NumMissedClicks = 0;
+	};
+
+	static int32 CountWidgets(const TSharedRef<SWidget>& Widget)
+	{
+		int32 Count = 1;
+		FChildren* Children = Widget->GetChildren();
+		for (int32 ChildIndex = 0; Children && ChildIndex < Children->Num(); ChildIndex++)
+		{
+			Count += CountWidgets(Children->GetChildAt(ChildIndex));
+		}
+		return Count;
+	}
+
+	static TSharedPtr<SMineSweeperGrid> FindGrid(const TSharedRef<SWidget>& Widget)
+	{
+		static const FName GridType(TEXT("SMineSweeperGrid"));
+		if (Widget->GetType() == GridType)
+		{
+			return StaticCastSharedRef<SMineSweeperGrid>(Widget);
+		}
+
+		FChildren* Children = Widget->GetChildren();
+		for (int32 ChildIndex = 0; Children && ChildIndex < Children->Num(); ChildIndex++)
+		{
+			if (TSharedPtr<SMineSweeperGrid> Grid = FindGrid(Children->GetChildAt(ChildIndex)))
+			{
+				return Grid;
+			}
+		}
+		return nullptr;
+	}
+
+	static double TickSlateMs()
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		FSlateApplication::Get().Tick();
+		return (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	}
+
+	//Moves the cursor over the position and presses and releases the left button there
+	static void SendClick(const FVector2D& ScreenPosition)
+	{
+		FSlateApplication& SlateApplication = FSlateApplication::Get();
+		const FModifierKeysState NoModifiers;
+		const TSet<FKey> NoButtons;
+		const TSet<FKey> LeftButton = { EKeys::LeftMouseButton };
+
+		SlateApplication.ProcessMouseMoveEvent(FPointerEvent(FSlateApplication::CursorPointerIndex, ScreenPosition, ScreenPosition, NoButtons, EKeys::Invalid, 0.0f, NoModifiers));
+		SlateApplication.ProcessMouseButtonDownEvent(nullptr, FPointerEvent(FSlateApplication::CursorPointerIndex, ScreenPosition, ScreenPosition, LeftButton, EKeys::LeftMouseButton, 0.0f, NoModifiers));
+		SlateApplication.ProcessMouseButtonUpEvent(FPointerEvent(FSlateApplication::CursorPointerIndex, ScreenPosition, ScreenPosition, NoButtons, EKeys::LeftMouseButton, 0.0f, NoModifiers));
+	}
+
+	static FResult Measure(int32 Size)
+	{
+		FResult Result;
+		Result.Size = Size;
+
+		//A world of its own, so the board is a real actor without touching the level open in the editor
+		UWorld* World = UWorld::CreateWorld(EWorldType::Editor, false, TEXT("MineSweeperDetailsBenchmark"));
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Editor);
+		WorldContext.SetCurrentWorld(World);
+
+		AMineSweeperActor* Board = World->SpawnActor<AMineSweeperActor>();
+		Board->ConfigureBoard(Size, Size, 0.15f, Size);
+
+		FDetailsViewArgs DetailsViewArgs;
+		DetailsViewArgs.bAllowSearch = false;
+		DetailsViewArgs.bHideSelectionTip = true;
+		DetailsViewArgs.NameAreaSettings = FDetailsViewArgs::HideNameArea;
+
+		FPropertyEditorModule& PropertyEditorModule = FModuleManager::GetModuleChecked<FPropertyEditorModule>(TEXT("PropertyEditor"));
+		TSharedRef<IDetailsView> DetailsView = PropertyEditorModule.CreateDetailView(DetailsViewArgs);
+
+		//In front of everything, the clicks go to whatever window is under the cursor
+		TSharedRef<SWindow> Window = SNew(SWindow)
+			.Title(FText::FromString(FString::Printf(TEXT("MineSweeper details benchmark %dx%d"), Size, Size)))
+			.ClientSize(FVector2D(900.0f, 900.0f))
+			.ScreenPosition(FVector2D(50.0f, 50.0f))
+			.IsTopmostWindow(true)
+			.SupportsMaximize(false)
+			.SupportsMinimize(false)
+			[
+				DetailsView
+			];
+		FSlateApplication::Get().AddWindow(Window);
+
+		//The customization runs inside SetObject, its rows are only built by the first prepass and paint
+		const uint64 MemoryBefore = FPlatformMemory::GetStats().UsedPhysical;
+		const double BuildStartTime = FPlatformTime::Seconds();
+		DetailsView->SetObject(Board);
+		FSlateApplication::Get().Tick();
+		Result.BuildMs = (FPlatformTime::Seconds() - BuildStartTime) * 1000.0;
+
+		for (int32 Frame = 0; Frame < WarmupFrames; Frame++)
+		{
+			FSlateApplication::Get().Tick();
+		}
+		Result.MemoryKB = (int64(FPlatformMemory::GetStats().UsedPhysical) - int64(MemoryBefore)) / 1024;
+		Result.NumWidgets = CountWidgets(Window);
+
+		for (int32 Frame = 0; Frame < MeasuredFrames; Frame++)
+		{
+			const double PrepassStartTime = FPlatformTime::Seconds();
+			Window->SlatePrepass(FSlateApplication::Get().GetApplicationScale() * Window->GetDPIScaleFactor());
+			Result.PrepassMs += (FPlatformTime::Seconds() - PrepassStartTime) * 1000.0;
+			Result.FrameMs += TickSlateMs();
+		}
+		Result.PrepassMs /= MeasuredFrames;
+		Result.FrameMs /= MeasuredFrames;
+
+		//Scripted play on the fields the grid shows, timed from the mouse down until the panel painted the result
+		const TSharedPtr<SMineSweeperGrid> Grid = FindGrid(Window);
+		Result.NumCells = Grid.IsValid() ? Grid->GetNumCells() : 0;
+
+		FRandomStream RandomStream(Size);
+		TArray<double> ClickTimes;
+		for (int32 Click = 0; Grid.IsValid() && Click < MeasuredClicks; Click++)
+		{
+			if (Board->IsGameOver())
+			{
+				Board->ResetBoard();
+				FSlateApplication::Get().Tick();
+			}
+
+			FIntPoint Field;
+			FVector2D ScreenPosition;
+			bool bFound = false;
+			for (int32 Tries = 0; Tries < 100 && !bFound; Tries++)
+			{
+				Field = FIntPoint(RandomStream.RandRange(0, Board->GetNumColumns() - 1), RandomStream.RandRange(0, Board->GetNumRows() - 1));
+				bFound = Board->CanClickOnField(Field.X, Field.Y) && !Board->IsRevealed(Field.X, Field.Y) && Grid->GetFieldScreenPosition(Field, ScreenPosition);
+			}
+			if (!bFound)
+			{
+				continue;
+			}
+
+			const int64 HashBefore = Board->GetBoardHash();
+			const double ClickStartTime = FPlatformTime::Seconds();
+			SendClick(ScreenPosition);
+			FSlateApplication::Get().Tick();
+			ClickTimes.Add((FPlatformTime::Seconds() - ClickStartTime) * 1000.0);
+
+			//A hidden field always changes when it is clicked
+			Result.NumMissedClicks += Board->GetBoardHash() == HashBefore ? 1 : 0;
+		}
+
+		if (ClickTimes.Num())
+		{
+			ClickTimes.Sort();
+			Result.ClickMedianMs = ClickTimes[ClickTimes.Num() / 2];
+			Result.ClickMaxMs = ClickTimes.Last();
+			Result.NumClicks = ClickTimes.Num();
+		}
+
+		FSlateApplication::Get().DestroyWindowImmediately(Window);
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMineSweeperDetailsBenchmarkTest, "Project.DetailPanel.MineSweeper.DetailsBenchmark",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FMineSweeperDetailsBenchmarkTest::RunTest(const FString& Parameters)
+{
+	using namespace MineSweeperDetailsBenchmark;
+
+	if (!FSlateApplication::IsInitialized() || !FApp::CanEverRender())
+	{
+		AddWarning(TEXT("The details benchmark needs Slate to render, skipped"));
+		return true;
+	}
+
+	FString Csv = TEXT("Columns,Rows,BuildMs,PrepassMs,FrameMs,Widgets,Cells,MemoryKB,ClickMedianMs,ClickMaxMs,Clicks\n");
+	//Cells of the first board bigger than the viewport
+	int32 ViewportCells = 0;
+	for (const int32 Size : Sizes)
+	{
+		const FResult Result = Measure(Size);
+		AddInfo(FString::Printf(TEXT("%dx%d: build %.2f ms, prepass %.3f ms, frame %.3f ms, %d widgets, %d cells, %lld KB, click %.3f ms (max %.3f ms)"),
+			Size, Size, Result.BuildMs, Result.PrepassMs, Result.FrameMs, Result.NumWidgets, Result.NumCells, Result.MemoryKB, Result.ClickMedianMs, Result.ClickMaxMs));
+
+		Csv += FString::Printf(TEXT("%d,%d,%.3f,%.4f,%.4f,%d,%d,%lld,%.4f,%.4f,%d\n"),
+			Size, Size, Result.BuildMs, Result.PrepassMs, Result.FrameMs, Result.NumWidgets, Result.NumCells, Result.MemoryKB, Result.ClickMedianMs, Result.ClickMaxMs, Result.NumClicks);
+
+		TestTrue(FString::Printf(TEXT("%dx%d shows a grid"), Size, Size), Result.NumCells > 0);
+		TestTrue(FString::Printf(TEXT("%dx%d clicks reach the board"), Size, Size), Result.NumClicks > 0 && Result.NumMissedClicks == 0);
+
+		//The grid is virtualized, boards bigger than the viewport all get the same cells
+		if (Size >= 50)
+		{
+			ViewportCells = ViewportCells > 0 ? ViewportCells : Result.NumCells;
+			TestTrue(FString::Printf(TEXT("%dx%d has no more cells than the viewport needs"), Size, Size), Result.NumCells <= ViewportCells);
+		}
+	}
+
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("MineSweeper") / FString::Printf(TEXT("DetailsBenchmark-%s.csv"), *FDateTime::Now().ToString());
+	if (FFileHelper::SaveStringToFile(Csv, *Filename))
+	{
+		AddInfo(FString::Printf(TEXT("Details benchmark written to %s"), *Filename));
+	}
+	else
+	{
+		AddWarning(FString::Printf(TEXT("Could not write the details benchmark to %s"), *Filename));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,345 @@
+#include "MineSweeperGrid.h"
+#include "DetailPanelCore/Public/MineSweeperMemory.h"
+#include "HAL/PlatformTime.h"
+#include "Layout/Clipping.h"
+#include "Widgets/SCanvas.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Layout/SBox.h"
+#include "Widgets/Layout/SDPIScaler.h"
+#include "Widgets/Layout/SScrollBar.h"
+
+namespace MineSweeperGrid
+{
+	static constexpr float MinZoom = 0.5f;
+	static constexpr float MaxZoom = 3.0f;
+
+	//Zoom factor of one notch of the mouse wheel
+	static constexpr float ZoomStep = 1.1f;
+
+	//Fields scrolled by one notch of the mouse wheel
+	static constexpr float WheelScrollFields = 3.0f;
+}
+
+void SMineSweeperGrid::Construct(const FArguments& InArgs)
+{
+	OnMakeCell = InArgs._OnMakeCell;
+	BoardSize = InArgs._BoardSize;
+	CellSize = FMath::Max(InArgs._CellSize, 1.0f);
+	MaxViewportSize = InArgs._MaxViewportSize;
+	Margin = FMath::Max(InArgs._Margin, 0);
+	MaxBuildMilliseconds = FMath::Max(InArgs._MaxBuildMillisecondsPerFrame, 0.0f);
+	OnFirstPaint = InArgs._OnFirstPaint;
+	OnViewportBuilt = InArgs._OnViewportBuilt;
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SNew(SHorizontalBox)
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			[
+				SNew(SBox)
+				.WidthOverride_Lambda([this]() { return FOptionalSize(GetViewportSize().X); })
+				.HeightOverride_Lambda([this]() { return FOptionalSize(GetViewportSize().Y); })
+				.Clipping(EWidgetClipping::ClipToBounds)
+				[
+					//The cells are laid out at a zoom of 1, the scaler takes care of the rest
+					SNew(SDPIScaler)
+					.DPIScale_Lambda([this]() { return Zoom; })
+					[
+						SAssignNew(Canvas, SCanvas)
+					]
+				]
+			]
+			+ SHorizontalBox::Slot()
+			.AutoWidth()
+			[
+				SAssignNew(VerticalScrollBar, SScrollBar)
+				.Orientation(Orient_Vertical)
+				.OnUserScrolled(this, &SMineSweeperGrid::OnVerticalScrolled)
+			]
+		]
+		+ SVerticalBox::Slot()
+		.AutoHeight()
+		[
+			SNew(SBox)
+			.WidthOverride_Lambda([this]() { return FOptionalSize(GetViewportSize().X); })
+			[
+				SAssignNew(HorizontalScrollBar, SScrollBar)
+				.Orientation(Orient_Horizontal)
+				.OnUserScrolled(this, &SMineSweeperGrid::OnHorizontalScrolled)
+			]
+		]
+	];
+
+	UpdateCells();
+	UpdateScrollBars();
+}
+
+void SMineSweeperGrid::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime)
+{
+	SCompoundWidget::Tick(AllottedGeometry, InCurrentTime, InDeltaTime);
+
+	//The board size can change at any time, so the offset is clamped again every frame
+	SetScrollOffset(ScrollOffset);
+	UpdateCells();
+	UpdateScrollBars();
+}
+
+int32 SMineSweeperGrid::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	const int32 MaxLayerId = SCompoundWidget::OnPaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
+
+	if (!bReportedFirstPaint)
+	{
+		bReportedFirstPaint = true;
+		OnFirstPaint.ExecuteIfBound();
+	}
+	if (!bReportedViewportBuilt && NextPendingCell >= NumPendingVisible)
+	{
+		bReportedViewportBuilt = true;
+		OnViewportBuilt.ExecuteIfBound();
+	}
+	return MaxLayerId;
+}
+
+bool SMineSweeperGrid::GetFieldScreenPosition(const FIntPoint& Field, FVector2D& OutScreenPosition) const
+{
+	//Same layout as the canvas slots, then the zoom of the scaler around the top left of the viewport
+	const FVector2D LocalPosition = ((FVector2D(Field) + FVector2D(0.5f, 0.5f)) * CellSize - ScrollOffset) * Zoom;
+	const FVector2D ViewportSize = GetViewportSize();
+	if (LocalPosition.X < 0.0f || LocalPosition.Y < 0.0f || LocalPosition.X >= ViewportSize.X || LocalPosition.Y >= ViewportSize.Y)
+	{
+		return false;
+	}
+
+	OutScreenPosition = GetPaintSpaceGeometry().LocalToAbsolute(LocalPosition);
+	return true;
+}
+
+FReply SMineSweeperGrid::OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	const float WheelDelta = MouseEvent.GetWheelDelta();
+
+	if (MouseEvent.IsControlDown())
+	{
+		//Keep the field under the cursor where it is
+		const FVector2D LocalPosition = MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition());
+		const FVector2D Anchor = ScrollOffset + LocalPosition / Zoom;
+
+		const float NewZoom = FMath::Clamp(Zoom * FMath::Pow(MineSweeperGrid::ZoomStep, WheelDelta), MineSweeperGrid::MinZoom, MineSweeperGrid::MaxZoom);
+		if (NewZoom == Zoom)
+		{
+			return FReply::Unhandled();
+		}
+
+		Zoom = NewZoom;
+		SetScrollOffset(Anchor - LocalPosition / Zoom);
+		return FReply::Handled();
+	}
+
+	const FVector2D OldScrollOffset = ScrollOffset;
+	const float Distance = -WheelDelta * MineSweeperGrid::WheelScrollFields * CellSize;
+	SetScrollOffset(ScrollOffset + (MouseEvent.IsShiftDown() ? FVector2D(Distance, 0.0f) : FVector2D(0.0f, Distance)));
+
+	//Let the details panel scroll once we hit the end of the board
+	return ScrollOffset != OldScrollOffset ? FReply::Handled() : FReply::Unhandled();
+}
+
+FVector2D SMineSweeperGrid::GetViewportSize() const
+{
+	const FIntPoint Board = BoardSize.Get();
+	const FVector2D BoardExtent = FVector2D(Board.X, Board.Y) * CellSize * Zoom;
+	return FVector2D(FMath::Min(BoardExtent.X, MaxViewportSize.X), FMath::Min(BoardExtent.Y, MaxViewportSize.Y));
+}
+
+FVector2D SMineSweeperGrid::GetVisibleExtent() const
+{
+	return GetViewportSize() / Zoom;
+}
+
+FVector2D SMineSweeperGrid::GetMaxScrollOffset() const
+{
+	const FIntPoint Board = BoardSize.Get();
+	const FVector2D MaxOffset = FVector2D(Board.X, Board.Y) * CellSize - GetVisibleExtent();
+	return FVector2D(FMath::Max(MaxOffset.X, 0.0f), FMath::Max(MaxOffset.Y, 0.0f));
+}
+
+void SMineSweeperGrid::SetScrollOffset(const FVector2D& InScrollOffset)
+{
+	const FVector2D MaxOffset = GetMaxScrollOffset();
+	ScrollOffset.X = FMath::Clamp(InScrollOffset.X, 0.0f, MaxOffset.X);
+	ScrollOffset.Y = FMath::Clamp(InScrollOffset.Y, 0.0f, MaxOffset.Y);
+}
+
+void SMineSweeperGrid::OnVerticalScrolled(float OffsetFraction)
+{
+	SetScrollOffset(FVector2D(ScrollOffset.X, OffsetFraction * BoardSize.Get().Y * CellSize));
+}
+
+void SMineSweeperGrid::OnHorizontalScrolled(float OffsetFraction)
+{
+	SetScrollOffset(FVector2D(OffsetFraction * BoardSize.Get().X * CellSize, ScrollOffset.Y));
+}
+
+void SMineSweeperGrid::UpdateCells()
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	const FIntPoint Board = BoardSize.Get();
+	const FVector2D VisibleExtent = GetVisibleExtent();
+
+	const FIntPoint Min(
+		FMath::Max(FMath::FloorToInt(ScrollOffset.X / CellSize) - Margin, 0),
+		FMath::Max(FMath::FloorToInt(ScrollOffset.Y / CellSize) - Margin, 0));
+	const FIntPoint Max(
+		FMath::Min(FMath::CeilToInt((ScrollOffset.X + VisibleExtent.X) / CellSize) + Margin, Board.X),
+		FMath::Min(FMath::CeilToInt((ScrollOffset.Y + VisibleExtent.Y) / CellSize) + Margin, Board.Y));
+
+	if (Min == CachedMin && Max == CachedMax)
+	{
+		return;
+	}
+	CachedMin = Min;
+	CachedMax = Max;
+
+	const int32 RangeCols = FMath::Max(Max.X - Min.X, 0);
+	const int32 RangeRows = FMath::Max(Max.Y - Min.Y, 0);
+
+	//Fields inside the viewport get their cells before the margin does
+	const FIntPoint VisibleMin(
+		FMath::Max(FMath::FloorToInt(ScrollOffset.X / CellSize), 0),
+		FMath::Max(FMath::FloorToInt(ScrollOffset.Y / CellSize), 0));
+	const FIntPoint VisibleMax(
+		FMath::Min(FMath::CeilToInt((ScrollOffset.X + VisibleExtent.X) / CellSize), Board.X),
+		FMath::Min(FMath::CeilToInt((ScrollOffset.Y + VisibleExtent.Y) / CellSize), Board.Y));
+
+	//Cells already showing a field in range stay where they are, all others are free to move
+	TBitArray<> Covered(false, RangeCols * RangeRows);
+	TArray<int32> FreeCells;
+	for (int32 CellIndex = 0; CellIndex < Cells.Num(); CellIndex++)
+	{
+		const FIntPoint& Coord = *Cells[CellIndex];
+		if (Coord.X >= Min.X && Coord.X < Max.X && Coord.Y >= Min.Y && Coord.Y < Max.Y)
+		{
+			const int32 RangeIndex = (Coord.Y - Min.Y) * RangeCols + (Coord.X - Min.X);
+			if (!Covered[RangeIndex])
+			{
+				Covered[RangeIndex] = true;
+				continue;
+			}
+		}
+		FreeCells.Add(CellIndex);
+	}
+
+	TArray<FIntPoint> UncoveredFields;
+	TArray<FIntPoint> UncoveredMarginFields;
+	for (int32 RowIndex = Min.Y; RowIndex < Max.Y; RowIndex++)
+	{
+		for (int32 ColIndex = Min.X; ColIndex < Max.X; ColIndex++)
+		{
+			if (!Covered[(RowIndex - Min.Y) * RangeCols + (ColIndex - Min.X)])
+			{
+				const bool bVisible = ColIndex >= VisibleMin.X && ColIndex < VisibleMax.X && RowIndex >= VisibleMin.Y && RowIndex < VisibleMax.Y;
+				(bVisible ? UncoveredFields : UncoveredMarginFields).Add(FIntPoint(ColIndex, RowIndex));
+			}
+		}
+	}
+	const int32 NumVisible = UncoveredFields.Num();
+	UncoveredFields.Append(UncoveredMarginFields);
+
+	//Free cells are moved right away, only the fields left over wait for new cells
+	int32 FieldIndex = 0;
+	for (; FieldIndex < UncoveredFields.Num() && FreeCells.Num(); FieldIndex++)
+	{
+		*Cells[FreeCells.Pop(false)] = UncoveredFields[FieldIndex];
+	}
+
+	//Left over after zooming in or shrinking the board, kept around for later
+	for (int32 CellIndex : FreeCells)
+	{
+		*Cells[CellIndex] = FIntPoint(-1, -1);
+	}
+
+	PendingCells.Reset();
+	PendingCells.Append(UncoveredFields.GetData() + FieldIndex, UncoveredFields.Num() - FieldIndex);
+	NumPendingVisible = FMath::Max(NumVisible - FieldIndex, 0);
+	NextPendingCell = 0;
+
+	if (MaxBuildMilliseconds <= 0.0f)
+	{
+		for (const FIntPoint& Coord : PendingCells)
+		{
+			CreateCell(Coord);
+		}
+		PendingCells.Reset();
+		NumPendingVisible = 0;
+	}
+	else if (PendingCells.Num() && !BuildTimerHandle.IsValid())
+	{
+		BuildTimerHandle = RegisterActiveTimer(0.0f, FWidgetActiveTimerDelegate::CreateSP(this, &SMineSweeperGrid::BuildPendingCells));
+	}
+}
+
+void SMineSweeperGrid::CreateCell(const FIntPoint& InCoord)
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	TSharedRef<FIntPoint> Coord = MakeShared<FIntPoint>(InCoord);
+	Cells.Add(Coord);
+
+	Canvas->AddSlot()
+	.Position(TAttribute<FVector2D>::CreateLambda([this, Coord]() { return FVector2D(Coord->X, Coord->Y) * CellSize - ScrollOffset; }))
+	.Size(FVector2D(CellSize, CellSize))
+	[
+		SNew(SBox)
+		.Visibility_Lambda([Coord]() { return Coord->X >= 0 ? EVisibility::SelfHitTestInvisible : EVisibility::Collapsed; })
+		[
+			OnMakeCell.IsBound() ? OnMakeCell.Execute(Coord) : SNullWidget::NullWidget
+		]
+	];
+}
+
+EActiveTimerReturnType SMineSweeperGrid::BuildPendingCells(double InCurrentTime, float InDeltaTime)
+{
+	//At least one cell per frame, so a slow machine still gets there
+	const double Deadline = FPlatformTime::Seconds() + MaxBuildMilliseconds / 1000.0;
+	while (NextPendingCell < PendingCells.Num())
+	{
+		CreateCell(PendingCells[NextPendingCell++]);
+		if (FPlatformTime::Seconds() > Deadline)
+		{
+			break;
+		}
+	}
+
+	if (NextPendingCell < PendingCells.Num())
+	{
+		return EActiveTimerReturnType::Continue;
+	}
+
+	PendingCells.Reset();
+	NumPendingVisible = 0;
+	NextPendingCell = 0;
+	BuildTimerHandle.Reset();
+	return EActiveTimerReturnType::Stop;
+}
+
+void SMineSweeperGrid::UpdateScrollBars()
+{
+	const FIntPoint Board = BoardSize.Get();
+	const FVector2D BoardExtent = FVector2D(Board.X, Board.Y) * CellSize;
+	const FVector2D VisibleExtent = GetVisibleExtent();
+
+	if (BoardExtent.X > 0.0f)
+	{
+		HorizontalScrollBar->SetState(ScrollOffset.X / BoardExtent.X, VisibleExtent.X / BoardExtent.X);
+	}
+	if (BoardExtent.Y > 0.0f)
+	{
+		VerticalScrollBar->SetState(ScrollOffset.Y / BoardExtent.Y, VisibleExtent.Y / BoardExtent.Y);
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SCompoundWidget.h"
+
+class SCanvas;
+class SScrollBar;
+
+//Makes the widget of one grid cell. The cell has to read the field it shows from Coord every time, the grid changes it when recycling the cell.
+DECLARE_DELEGATE_RetVal_OneParam(TSharedRef<SWidget>, FOnMakeMineCell, TSharedRef<const FIntPoint> /*Coord*/);
+
+//A scrollable and zoomable grid that only keeps cell widgets for the fields inside its viewport plus a small margin.
+//Cells scrolled out of view are moved to the fields scrolled into view instead of being rebuilt,
+//so the number of widgets depends on the viewport size and not on the board size.
+//Missing cells are created over several frames within a time budget, the ones inside the viewport first.
+class SMineSweeperGrid : public SCompoundWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMineSweeperGrid)
+		: _BoardSize(FIntPoint::ZeroValue)
+		, _CellSize(30.0f)
+		, _MaxViewportSize(600.0f, 600.0f)
+		, _Margin(2)
+		, _MaxBuildMillisecondsPerFrame(2.0f)
+	{ }
+
+	/** Number of columns and rows */
+	SLATE_ATTRIBUTE(FIntPoint, BoardSize)
+
+	/** Size of a single field in slate units at a zoom of 1 */
+	SLATE_ARGUMENT(float, CellSize)
+
+	/** The viewport shrinks to the board if it is smaller than this */
+	SLATE_ARGUMENT(FVector2D, MaxViewportSize)
+
+	/** Fields around the viewport that also get a cell, so scrolling a bit shows no empty border */
+	SLATE_ARGUMENT(int32, Margin)
+
+	/** Most time in milliseconds spent on creating cells per frame, 0 creates all of them right away */
+	SLATE_ARGUMENT(float, MaxBuildMillisecondsPerFrame)
+
+	SLATE_EVENT(FOnMakeMineCell, OnMakeCell)
+
+	/** Called by the first paint of the grid, whether it has cells yet or not */
+	SLATE_EVENT(FSimpleDelegate, OnFirstPaint)
+
+	/** Called by the first paint that has a cell for every field inside the viewport */
+	SLATE_EVENT(FSimpleDelegate, OnViewportBuilt)
+
+	SLATE_END_ARGS()
+
+	void Construct(const FArguments& InArgs);
+
+	//Number of cell widgets created so far, visible or not
+	int32 GetNumCells() const { return Cells.Num(); }
+
+	//True while cells are still being created over the next frames
+	bool IsBuilding() const { return NextPendingCell < PendingCells.Num(); }
+
+	//Center of a field in desktop space as of the last paint, false if the field is outside the viewport.
+	//For tests that click the cells through Slate like a user would.
+	bool GetFieldScreenPosition(const FIntPoint& Field, FVector2D& OutScreenPosition) const;
+
+public:
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FReply OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+
+private:
+	//Viewport size in slate units, after zoom
+	FVector2D GetViewportSize() const;
+
+	//Part of the board the viewport shows, in slate units before zoom
+	FVector2D GetVisibleExtent() const;
+
+	FVector2D GetMaxScrollOffset() const;
+
+	void SetScrollOffset(const FVector2D& InScrollOffset);
+
+	void OnVerticalScrolled(float OffsetFraction);
+	void OnHorizontalScrolled(float OffsetFraction);
+
+	//Moves the cells to the fields inside the viewport. Fields left without a cell are queued for BuildPendingCells.
+	void UpdateCells();
+
+	void CreateCell(const FIntPoint& Coord);
+
+	//Active timer creating the queued cells within the budget. Dies with the widget, so a build stops when the panel goes away.
+	EActiveTimerReturnType BuildPendingCells(double InCurrentTime, float InDeltaTime);
+
+	void UpdateScrollBars();
+
+	FOnMakeMineCell OnMakeCell;
+	TAttribute<FIntPoint> BoardSize;
+	float CellSize = 30.0f;
+	FVector2D MaxViewportSize;
+	int32 Margin = 2;
+	float MaxBuildMilliseconds = 2.0f;
+	FSimpleDelegate OnFirstPaint;
+	FSimpleDelegate OnViewportBuilt;
+
+	//Scroll position in slate units before zoom
+	FVector2D ScrollOffset = FVector2D::ZeroVector;
+	float Zoom = 1.0f;
+
+	//Field each cell shows, (-1, -1) for cells that are not in use
+	TArray<TSharedRef<FIntPoint>> Cells;
+
+	//First field and one past the last field that had cells assigned, to skip the update while nothing moves
+	FIntPoint CachedMin = FIntPoint::ZeroValue;
+	FIntPoint CachedMax = FIntPoint::ZeroValue;
+
+	//Fields waiting for a cell, the ones inside the viewport first. Rebuilt whenever the viewport moves.
+	TArray<FIntPoint> PendingCells;
+	int32 NumPendingVisible = 0;
+	int32 NextPendingCell = 0;
+	TSharedPtr<FActiveTimerHandle> BuildTimerHandle;
+
+	mutable bool bReportedFirstPaint = false;
+	mutable bool bReportedViewportBuilt = false;
+
+	TSharedPtr<SCanvas> Canvas;
+	TSharedPtr<SScrollBar> VerticalScrollBar;
+	TSharedPtr<SScrollBar> HorizontalScrollBar;
+};
@@ -1,4 +1,5 @@
 #include "MineSweeperOnDetails.h"
+#include "DetailPanelEditor.h"
 #include "DetailLayoutBuilder.h"
 #include "DetailCategoryBuilder.h"
 #include "DetailWidgetRow.h"
@@ -12,11 +13,22 @@
 #include "Widgets/Layout/SConstraintCanvas.h"
 #include "Widgets/SCanvas.h"
 #include "DetailPanel/Public/MineSweeperActor.h"
+#include "DetailPanelCore/Public/MineSweeperMemory.h"
+#include "MineSweeperGrid.h"
+#include "MineSweeperViewModel.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "IDetailsView.h"
 #include "IDetailGroup.h"
 #include "IDetailPropertyRow.h"
 #include "PropertyCustomizationHelpers.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
 
+static TAutoConsoleVariable<float> CVarMineSweeperGridBuildMs(
+	TEXT("MineSweeper.Details.GridBuildMs"),
+	2.0f,
+	TEXT("Most time in milliseconds the details panel spends per frame on creating grid cells, the header shows right away.\n")
+	TEXT("0 builds the whole grid before the first paint. The time to the first paint is logged to DetailPanelEditor at Verbose."));
 
 //The custom transaction object to help with modifying and setting the appropriate flags when editing the object
 class FMineSweeperTransactionScope
@@ -24,6 +36,9 @@ class FMineSweeperTransactionScope
 public:
 	FMineSweeperTransactionScope(FText TransactionName, UObject* InUObject)
 	{
+		//The undo snapshot of the board is taken in here
+		LLM_SCOPE_BYTAG(MineSweeper);
+
 		check(InUObject);
 		Object = InUObject;
 		bDidWeSetFlag = false;
@@ -311,6 +326,10 @@ MineSweeperOnDetails::MineSweeperOnDetails()
 
 MineSweeperOnDetails::~MineSweeperOnDetails()
 {
+	if (ViewModel.IsValid() && bShowHeatmap)
+	{
+		ViewModel->RemoveHeatmapView();
+	}
 }
 
 TSharedRef<IDetailCustomization> MineSweeperOnDetails::MakeInstance()
@@ -326,7 +345,10 @@ void MineSweeperOnDetails::CustomizeDetails(const TSharedPtr<IDetailLayoutBuilde
 
 void MineSweeperOnDetails::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
 {
-	
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	CustomizeStartTime = FPlatformTime::Seconds();
+
 	TArray<TWeakObjectPtr<UObject>> ObjectsBeingCustomized;
 	DetailBuilder.GetObjectsBeingCustomized(ObjectsBeingCustomized);
 
@@ -374,20 +396,32 @@ void MineSweeperOnDetails::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
 
 		if (MineActor.IsValid())
 		{
+			//Refreshing the details customizes again, keep showing the heatmap of the same view model
+			if (ViewModel.IsValid() && bShowHeatmap)
+			{
+				ViewModel->RemoveHeatmapView();
+			}
+			ViewModel = FMineSweeperViewModel::Get(MineActor.Get());
+			if (bShowHeatmap)
+			{
+				ViewModel->AddHeatmapView();
+			}
+
 			//Draw the variables for configuration
 			IDetailCategoryBuilder& Config = DetailBuilder.EditCategory("Config",FText::GetEmpty(),ECategoryPriority::Important).InitiallyCollapsed(true);
 
 			Config.AddProperty(DetailBuilder.GetProperty("RowNum"));
 			Config.AddProperty(DetailBuilder.GetProperty("ColumnNum"));
 			Config.AddProperty(DetailBuilder.GetProperty("MineChance"));
-
-			check(MineActor->IsBoardGenerated());
-
-			TSharedPtr<SVerticalBox> VerticalBox;
-
-			//Save the rows and columns locally for use
-			const int32 RowNum = MineActor->GetNumRows();
-			const int32 ColNum = MineActor->GetNumColumns();
+			Config.AddProperty(DetailBuilder.GetProperty("Topology"));
+			Config.AddProperty(DetailBuilder.GetProperty("LayerNum"));
+			Config.AddProperty(DetailBuilder.GetProperty("DifficultyFilter"));
+			Config.AddProperty(DetailBuilder.GetProperty("Seed"));
+			Config.AddProperty(DetailBuilder.GetProperty("bRecordMoveLog"));
+			Config.AddProperty(DetailBuilder.GetProperty("CascadeFieldsPerFrame"));
+			Config.AddProperty(DetailBuilder.GetProperty("CascadeMillisecondsPerFrame"));
+			Config.AddProperty(DetailBuilder.GetProperty("bShowWorldBoard"));
+			Config.AddProperty(DetailBuilder.GetProperty("WorldFieldSize"));
 
 			//Grid Size for the UI 
 			const float GridSize = 30.0f;
@@ -498,7 +532,7 @@ void MineSweeperOnDetails::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
 										.Image_Lambda(
 											[this]()
 											{
-												if (MineActor.IsValid() && MineActor->CheckAndUpdateHasWon())
+												if (ViewModel->HasWon())
 												{
 													return FSlateMinesStyle::Get().GetBrush("Mine.SmileyWin");
 												}
@@ -509,13 +543,42 @@ void MineSweeperOnDetails::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
 									]
 								]
 								+ SHorizontalBox::Slot()
-								.HAlign(EHorizontalAlignment::HAlign_Left)
+								.HAlign(EHorizontalAlignment::HAlign_Right)
+								.VAlign(EVerticalAlignment::VAlign_Center)
 								[
-									SNew(STextBlock)
+									//Shows the chance of a mine on every hidden field
+									SNew(SCheckBox)
+									.IsChecked_Lambda([this]() { return bShowHeatmap ? ECheckBoxState::Checked : ECheckBoxState::Unchecked; })
+									.OnCheckStateChanged_Lambda
+									(
+										[this](ECheckBoxState NewState)
+										{
+											const bool bNewShowHeatmap = NewState == ECheckBoxState::Checked;
+											if (bNewShowHeatmap != bShowHeatmap)
+											{
+												bShowHeatmap = bNewShowHeatmap;
+												if (bShowHeatmap)
+												{
+													ViewModel->AddHeatmapView();
+												}
+												else
+												{
+													ViewModel->RemoveHeatmapView();
+												}
+											}
+										}
+									)
+									[
+										SNew(STextBlock)
+										.Text(FText::FromString("Heatmap"))
+										.Font(IDetailLayoutBuilder::GetDetailFont())
+									]
 								]
 							]
 						]
-						//The second vertical box slot where our grid would be
+						//The second vertical box slot where our grid would be.
+						//Only the fields around the visible part get widgets, so big boards cost no more than small ones.
+						//A board that is not generated yet shows as all hidden, the first click places the mines.
 						+ SVerticalBox::Slot()
 						.AutoHeight()
 						.HAlign(EHorizontalAlignment::HAlign_Left)
@@ -524,203 +587,182 @@ void MineSweeperOnDetails::CustomizeDetails(IDetailLayoutBuilder& DetailBuilder)
 							SNew(SBorder)
 							.Padding(4)
 							[
-								SAssignNew(VerticalBox,SVerticalBox)
-							]
-						]
-					]
-				];
-
-
-		//Actually form the grid of buttons to click
-			for (int32 x = 0; x < RowNum; x++)
-			{
-				auto HorizontalBox = SNew(SHorizontalBox);
-				VerticalBox->AddSlot()[HorizontalBox];
-
-				for (int32 y = 0; y < ColNum; y++)
-				{
-					HorizontalBox->AddSlot()
-						.AutoWidth()
-						[
-							SNew(SOverlay)
-							.Visibility(EVisibility::SelfHitTestInvisible)
-							+ SOverlay::Slot()
-							[
-								SNew(SImage)
-								.DesiredSizeOverride(GridSize2D)
-								.Visibility(EVisibility::Hidden)
-							]
-							+ SOverlay::Slot()
-							[
-								SNew(SRightClickableButton)
-								.OnClicked(this, &MineSweeperOnDetails::OnClicked, y, x)
-								.OnRightClicked(this, &MineSweeperOnDetails::OnRightClicked, y, x)
-								.IsEnabled(this, &MineSweeperOnDetails::GetIsEnabledButton,y, x)
-							]
-							+ SOverlay::Slot()
-							[
-								SNew(SImageSink)
-								.DesiredSizeOverride(GridSize2D)
-								.Visibility_Lambda
+								SNew(SMineSweeperGrid)
+								.CellSize(GridSize)
+								.BoardSize_Lambda
 								(
-									[this, x, y]()
+									[this]()
 									{
-
 										if (MineActor.IsValid())
 										{
-											if((MineActor->IsRevealed(y,x) && !MineActor->IsFlagged(y,x) ) || MineActor->IsGameOver())
-											{
-												return EVisibility::Visible;
-											}
+											return FIntPoint(MineActor->GetNumColumns(), MineActor->GetNumRows());
 										}
-										return EVisibility::Hidden;
+										return FIntPoint::ZeroValue;
 									}
 								)
-								.ColorAndOpacity(FLinearColor(1.0f,1.0f,1.0f,0.25f))
-							]
-							+ SOverlay::Slot()
-							[
-								SNew(STextBlock)
-								.Justification(ETextJustify::Center)
-								.Font(NumberFont)
-								.Text_Lambda
+								.OnMakeCell(this, &MineSweeperOnDetails::MakeCell, GridSize2D, NumberFont)
+								.MaxBuildMillisecondsPerFrame(CVarMineSweeperGridBuildMs.GetValueOnGameThread())
+								.OnFirstPaint_Lambda
 								(
-									[this, x, y]()
+									[this]()
 									{
-										if (MineActor.IsValid())
-										{
-											if (MineActor->IsRevealed(y,x))
-											{
-												int32 Val = MineActor->CalculateFieldNumber(y, x);
-												if (Val > 0)
-												{
-													return FText::FromString(FString::FromInt(Val));
-												}
-											}
-										}
-										return FText::FromString("");
+										UE_LOG(DetailPanelEditor, Verbose, TEXT("MineSweeper details painted %.2f ms after the selection"), (FPlatformTime::Seconds() - CustomizeStartTime) * 1000.0);
 									}
 								)
-								.ColorAndOpacity_Lambda
+								.OnViewportBuilt_Lambda
 								(
-									[this, x, y]()
+									[this]()
 									{
-										if (MineActor.IsValid())
-										{
-											int32 Val = MineActor->CalculateFieldNumber(y, x);
-											switch (Val)
-												{
-												case 1:return FLinearColor::Blue;
-												case 2:return FLinearColor::Green;
-												case 3:return FLinearColor::Red;
-												case 4:return FLinearColor(FColor::FromHex("010123FF"));
-												case 5:return FLinearColor(FColor::FromHex("170000FF"));
-												case 6:return FLinearColor(FColor::FromHex("001D26FF"));
-												case 7:return FLinearColor(FColor::FromHex("101010FF"));
-												case 8:return FLinearColor(FColor::FromHex("101010FF"));
-												case 9:return FLinearColor(FColor::FromHex("616C61FF"));
-												default:
-													break;
-												}
-										}
-										return FLinearColor::White;
-									}
-								)
-								.Visibility_Lambda
-								(
-									[this, x, y]()
-									{
-										if (MineActor.IsValid())
-										{
-											if (MineActor->IsRevealed(y,x))
-											{
-												int32 Val = MineActor->CalculateFieldNumber(y, x);
-												if (Val > 0)
-												{
-													return EVisibility::HitTestInvisible;
-												}
-											}
-										}
-										return EVisibility::Collapsed;
-									}
-								)
-							]
-							+ SOverlay::Slot()
-							[
-								SNew(SImage)
-								.DesiredSizeOverride(GridSize2D)
-								.Image(FSlateMinesStyle::Get().GetBrush("Mine.Mine"))
-								.Visibility_Lambda
-								(
-									[this, x, y]()
-									{
-										if (MineActor.IsValid())
-										{
-											if (MineActor->IsGameOver() && !MineActor->IsFlagged(y, x) && MineActor->IsMine(y, x))
-											{
-												return  EVisibility::HitTestInvisible;
-											}
-										}
-										return EVisibility::Collapsed;
-									}
-								)
-							]
-							+ SOverlay::Slot()
-							[
-								SNew(SImage)
-								.DesiredSizeOverride(GridSize2D)
-								.Image(FSlateMinesStyle::Get().GetBrush("Mine.Flag"))
-								.Visibility_Lambda
-								(
-									[this, x, y]()
-									{
-										if (MineActor.IsValid())
-										{
-											if (MineActor->IsFlagged(y, x))
-											{
-												return EVisibility::HitTestInvisible;
-											}
-										}
-										return EVisibility::Collapsed;
-									}
-								)
-							]
-							+ SOverlay::Slot()
-							[
-								SNew(SImage)
-								.DesiredSizeOverride(GridSize2D)
-								.Image(FSlateMinesStyle::Get().GetBrush("Mine.Cross"))
-								.Visibility_Lambda
-								(
-									[this, x, y]()
-									{
-										if (MineActor.IsValid())
-										{
-											if (MineActor->IsGameOver() && MineActor->IsCrossed(y, x))
-											{
-												return EVisibility::HitTestInvisible;
-											}
-										}
-										return EVisibility::Collapsed;
+										UE_LOG(DetailPanelEditor, Verbose, TEXT("MineSweeper details grid complete %.2f ms after the selection"), (FPlatformTime::Seconds() - CustomizeStartTime) * 1000.0);
 									}
 								)
 							]
-					];
-				}
-			}
+						]
+					]
+				];
+
 
-			
 		}
 	}
 }
 
-bool MineSweeperOnDetails::GetIsEnabledButton(int32 X, int32 Y) const
+TSharedRef<SWidget> MineSweeperOnDetails::MakeCell(TSharedRef<const FIntPoint> Coord, FVector2D GridSize2D, FSlateFontInfo NumberFont)
 {
-	if (MineActor.IsValid())
+	//Everything is read through Coord, the grid moves the cell to another field by changing it.
+	//The cell state comes from the view model, which works it out once per change for all open views.
+	TSharedRef<FMineSweeperViewModel> Model = ViewModel.ToSharedRef();
+
+	//The view model holds the probabilities while any view shows the heatmap, this one only tints if it shows it too
+	auto GetHeatmapProbability = [this, Model, Coord]()
 	{
-		return !MineActor->IsRevealed(X, Y);
-	}
-	return false;
+		return bShowHeatmap ? Model->GetProbability(Coord->X, Coord->Y) : -1.0f;
+	};
+
+	return SNew(SOverlay)
+	.Visibility(EVisibility::SelfHitTestInvisible)
+	+ SOverlay::Slot()
+	[
+		SNew(SImage)
+		.DesiredSizeOverride(GridSize2D)
+		.Visibility(EVisibility::Hidden)
+	]
+	+ SOverlay::Slot()
+	[
+		SNew(SRightClickableButton)
+		.OnClicked_Lambda([this, Coord]() { return OnClicked(Coord->X, Coord->Y); })
+		.OnRightClicked_Lambda([this, Coord]() { return OnRightClicked(Coord->X, Coord->Y); })
+		.IsEnabled_Lambda([Model, Coord]() { return bool(Model->GetCell(Coord->X, Coord->Y).bEnabled); })
+		.ToolTipText_Lambda
+		(
+			[Model, GetHeatmapProbability]()
+			{
+				const float Probability = GetHeatmapProbability();
+				if (Probability >= 0.0f)
+				{
+					return FText::FromString(FString::Printf(TEXT("Mine chance %.1f%%%s"), Probability * 100.0f, Model->IsProbabilityExact() ? TEXT("") : TEXT(" (estimated)")));
+				}
+				return FText::GetEmpty();
+			}
+		)
+	]
+	+ SOverlay::Slot()
+	[
+		//Heatmap tint, green for safe up to red for a sure mine
+		SNew(SBorder)
+		.BorderImage(FCoreStyle::Get().GetBrush("WhiteBrush"))
+		.Visibility(EVisibility::HitTestInvisible)
+		.BorderBackgroundColor_Lambda
+		(
+			[GetHeatmapProbability]()
+			{
+				const float Probability = GetHeatmapProbability();
+				if (Probability >= 0.0f)
+				{
+					return FSlateColor(FMath::Lerp(FLinearColor(0.0f, 1.0f, 0.0f, 0.4f), FLinearColor(1.0f, 0.0f, 0.0f, 0.4f), Probability));
+				}
+				return FSlateColor(FLinearColor::Transparent);
+			}
+		)
+	]
+	+ SOverlay::Slot()
+	[
+		SNew(SImageSink)
+		.DesiredSizeOverride(GridSize2D)
+		.Visibility_Lambda
+		(
+			[Model, Coord]()
+			{
+				return Model->GetCell(Coord->X, Coord->Y).bShowCover ? EVisibility::Visible : EVisibility::Hidden;
+			}
+		)
+		.ColorAndOpacity(FLinearColor(1.0f,1.0f,1.0f,0.25f))
+	]
+	+ SOverlay::Slot()
+	[
+		SNew(STextBlock)
+		.Justification(ETextJustify::Center)
+		.Font(NumberFont)
+		.Text_Lambda
+		(
+			[Model, Coord]()
+			{
+				return FMineSweeperViewModel::GetNumberText(Model->GetCell(Coord->X, Coord->Y).Number);
+			}
+		)
+		.ColorAndOpacity_Lambda
+		(
+			[Model, Coord]()
+			{
+				return FSlateColor(FMineSweeperViewModel::GetNumberColor(Model->GetCell(Coord->X, Coord->Y).Number));
+			}
+		)
+		.Visibility_Lambda
+		(
+			[Model, Coord]()
+			{
+				return Model->GetCell(Coord->X, Coord->Y).Number > 0 ? EVisibility::HitTestInvisible : EVisibility::Collapsed;
+			}
+		)
+	]
+	+ SOverlay::Slot()
+	[
+		SNew(SImage)
+		.DesiredSizeOverride(GridSize2D)
+		.Image(FSlateMinesStyle::Get().GetBrush("Mine.Mine"))
+		.Visibility_Lambda
+		(
+			[Model, Coord]()
+			{
+				return Model->GetCell(Coord->X, Coord->Y).bShowMine ? EVisibility::HitTestInvisible : EVisibility::Collapsed;
+			}
+		)
+	]
+	+ SOverlay::Slot()
+	[
+		SNew(SImage)
+		.DesiredSizeOverride(GridSize2D)
+		.Image(FSlateMinesStyle::Get().GetBrush("Mine.Flag"))
+		.Visibility_Lambda
+		(
+			[Model, Coord]()
+			{
+				return Model->GetCell(Coord->X, Coord->Y).bShowFlag ? EVisibility::HitTestInvisible : EVisibility::Collapsed;
+			}
+		)
+	]
+	+ SOverlay::Slot()
+	[
+		SNew(SImage)
+		.DesiredSizeOverride(GridSize2D)
+		.Image(FSlateMinesStyle::Get().GetBrush("Mine.Cross"))
+		.Visibility_Lambda
+		(
+			[Model, Coord]()
+			{
+				return Model->GetCell(Coord->X, Coord->Y).bShowCross ? EVisibility::HitTestInvisible : EVisibility::Collapsed;
+			}
+		)
+	];
 }
 
 FReply MineSweeperOnDetails::OnClicked(int32 X, int32 Y)
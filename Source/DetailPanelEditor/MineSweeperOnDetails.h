@@ -7,6 +7,7 @@
 
 class IDetailLayoutBuilder;
 struct FSlateImageBrush;
+class FMineSweeperViewModel;
 
 class MineSweeperOnDetails : public IDetailCustomization
 {
@@ -23,12 +24,21 @@ private:
 	virtual void CustomizeDetails(IDetailLayoutBuilder& DetailBuilder) override;
 	virtual void CustomizeDetails(const TSharedPtr<IDetailLayoutBuilder>& DetailBuilder) override;
 
-	bool GetIsEnabledButton(int32 X, int32 Y) const;
+	//Builds the widgets of one pooled grid cell showing the field at Coord
+	TSharedRef<SWidget> MakeCell(TSharedRef<const FIntPoint> Coord, FVector2D GridSize2D, FSlateFontInfo NumberFont);
 
 	FReply OnClicked(int32 X, int32 Y);
 
 	FReply OnRightClicked(int32 X, int32 Y);
 
+	bool bShowHeatmap = false;
+
+	//When the panel was last customized, to measure how long it takes to show up
+	double CustomizeStartTime = 0.0;
+
+	//Shared with every other details view of the same actor
+	TSharedPtr<FMineSweeperViewModel> ViewModel;
+
 	TWeakObjectPtr<class AMineSweeperActor> MineActor;
 	TWeakPtr<class IDetailLayoutBuilder> CacheDetailBuilder;
 };
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "MineSweeperViewModel.h"
+#include "DetailPanel/Public/MineSweeperActor.h"
+#include "DetailPanel/Public/MineBoardSnapshot.h"
+#include "DetailPanelCore/Public/MineSweeperMemory.h"
+
+namespace MineSweeperViewModel
+{
+	//The view models of all actors some view is showing. Entries of released view models are dropped on the next lookup.
+	static TMap<TWeakObjectPtr<AMineSweeperActor>, TWeakPtr<FMineSweeperViewModel>>& GetRegistry()
+	{
+		static TMap<TWeakObjectPtr<AMineSweeperActor>, TWeakPtr<FMineSweeperViewModel>> Registry;
+		return Registry;
+	}
+}
+
+TSharedRef<FMineSweeperViewModel> FMineSweeperViewModel::Get(AMineSweeperActor* Actor)
+{
+	TMap<TWeakObjectPtr<AMineSweeperActor>, TWeakPtr<FMineSweeperViewModel>>& Registry = MineSweeperViewModel::GetRegistry();
+	for (auto It = Registry.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || !It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	if (TWeakPtr<FMineSweeperViewModel>* Existing = Registry.Find(Actor))
+	{
+		return Existing->Pin().ToSharedRef();
+	}
+
+	TSharedRef<FMineSweeperViewModel> ViewModel = MakeShareable(new FMineSweeperViewModel(Actor));
+	Registry.Add(Actor, ViewModel);
+	return ViewModel;
+}
+
+FMineSweeperViewModel::FMineSweeperViewModel(AMineSweeperActor* InActor)
+	: Actor(InActor)
+{
+	if (Actor.IsValid())
+	{
+		BoardChangedHandle = Actor->OnBoardChanged().AddRaw(this, &FMineSweeperViewModel::OnBoardChanged);
+	}
+	InvalidateAll();
+}
+
+FMineSweeperViewModel::~FMineSweeperViewModel()
+{
+	if (ProbabilityJob.IsValid())
+	{
+		ProbabilityJob->Cancel();
+	}
+	if (Actor.IsValid())
+	{
+		Actor->OnBoardChanged().Remove(BoardChangedHandle);
+	}
+}
+
+void FMineSweeperViewModel::InvalidateAll()
+{
+	LLM_SCOPE_BYTAG(MineSweeper);
+
+	BoardSize = Actor.IsValid() ? FIntPoint(Actor->GetNumColumns(), Actor->GetNumRows()) : FIntPoint::ZeroValue;
+	//Checking for the win can end the game, so it comes first
+	bHasWon = Actor.IsValid() && Actor->CheckAndUpdateHasWon();
+	bGameOver = Actor.IsValid() && Actor->IsGameOver();
+
+	Cells.SetNum(BoardSize.X * BoardSize.Y);
+	ValidCells.Init(false, Cells.Num());
+}
+
+void FMineSweeperViewModel::OnBoardChanged(const TArray<int32>& ChangedIndices)
+{
+	if (!Actor.IsValid())
+	{
+		InvalidateAll();
+		return;
+	}
+
+	//The end of the game changes how every cell looks, not only the ones the last move touched
+	bHasWon = Actor->CheckAndUpdateHasWon();
+	const FIntPoint NewBoardSize(Actor->GetNumColumns(), Actor->GetNumRows());
+	if (ChangedIndices.Num() == 0 || Actor->IsGameOver() != bGameOver || NewBoardSize != BoardSize)
+	{
+		InvalidateAll();
+	}
+	else
+	{
+		for (const int32 Index : ChangedIndices)
+		{
+			if (ValidCells.IsValidIndex(Index))
+			{
+				ValidCells[Index] = false;
+			}
+		}
+	}
+
+	RefreshProbabilities();
+}
+
+const FMineCellDisplay& FMineSweeperViewModel::GetCell(int32 ColIndex, int32 RowIndex) const
+{
+	static const FMineCellDisplay Empty;
+
+	//Unused grid cells point outside of the board
+	if (!Actor.IsValid() || ColIndex < 0 || RowIndex < 0 || ColIndex >= BoardSize.X || RowIndex >= BoardSize.Y)
+	{
+		return Empty;
+	}
+
+	const int32 Index = RowIndex * BoardSize.X + ColIndex;
+	FMineCellDisplay& Cell = Cells[Index];
+	if (ValidCells[Index])
+	{
+		return Cell;
+	}
+
+	const bool bRevealed = Actor->IsRevealed(ColIndex, RowIndex);
+	const bool bFlagged = Actor->IsFlagged(ColIndex, RowIndex);
+
+	Cell = FMineCellDisplay();
+	Cell.bEnabled = !bRevealed;
+	Cell.bShowCover = (bRevealed && !bFlagged) || bGameOver;
+	Cell.bShowFlag = bFlagged;
+	Cell.bShowMine = bGameOver && !bFlagged && Actor->IsMine(ColIndex, RowIndex);
+	Cell.bShowCross = bGameOver && Actor->IsCrossed(ColIndex, RowIndex);
+	if (bRevealed)
+	{
+		Cell.Number = uint8(FMath::Max(Actor->CalculateFieldNumber(ColIndex, RowIndex), 0));
+	}
+
+	ValidCells[Index] = true;
+	return Cell;
+}
+
+const FText& FMineSweeperViewModel::GetNumberText(int32 Number)
+{
+	//Up to 26 neighbours on a cube board
+	static TArray<FText> Texts;
+	if (Texts.Num() == 0)
+	{
+		for (int32 i = 0; i <= 26; i++)
+		{
+			Texts.Add(i > 0 ? FText::AsNumber(i) : FText::GetEmpty());
+		}
+	}
+	return Texts.IsValidIndex(Number) ? Texts[Number] : Texts[0];
+}
+
+FLinearColor FMineSweeperViewModel::GetNumberColor(int32 Number)
+{
+	switch (Number)
+	{
+	case 1:return FLinearColor::Blue;
+	case 2:return FLinearColor::Green;
+	case 3:return FLinearColor::Red;
+	case 4:return FLinearColor(FColor::FromHex("010123FF"));
+	case 5:return FLinearColor(FColor::FromHex("170000FF"));
+	case 6:return FLinearColor(FColor::FromHex("001D26FF"));
+	case 7:return FLinearColor(FColor::FromHex("101010FF"));
+	case 8:return FLinearColor(FColor::FromHex("101010FF"));
+	case 9:return FLinearColor(FColor::FromHex("616C61FF"));
+	default:
+		break;
+	}
+	return FLinearColor::White;
+}
+
+void FMineSweeperViewModel::AddHeatmapView()
+{
+	if (NumHeatmapViews++ == 0)
+	{
+		RefreshProbabilities();
+	}
+}
+
+void FMineSweeperViewModel::RemoveHeatmapView()
+{
+	NumHeatmapViews = FMath::Max(NumHeatmapViews - 1, 0);
+	if (NumHeatmapViews == 0)
+	{
+		RefreshProbabilities();
+	}
+}
+
+float FMineSweeperViewModel::GetProbability(int32 ColIndex, int32 RowIndex) const
+{
+	if (NumHeatmapViews == 0 || bGameOver || ColIndex < 0 || RowIndex < 0 || ColIndex >= BoardSize.X || RowIndex >= BoardSize.Y)
+	{
+		return -1.0f;
+	}
+
+	//The map can be a move behind until the next one arrives
+	if (ProbabilityMap.Dims.Columns != BoardSize.X || ProbabilityMap.Dims.Rows != BoardSize.Y || !GetCell(ColIndex, RowIndex).bEnabled || GetCell(ColIndex, RowIndex).bShowFlag)
+	{
+		return -1.0f;
+	}
+	return ProbabilityMap.GetProbability(ColIndex, RowIndex);
+}
+
+void FMineSweeperViewModel::RefreshProbabilities()
+{
+	if (ProbabilityJob.IsValid())
+	{
+		ProbabilityJob->Cancel();
+		ProbabilityJob.Reset();
+	}
+
+	if (NumHeatmapViews == 0 || !Actor.IsValid())
+	{
+		ProbabilityMap = FMineProbabilityMap();
+		return;
+	}
+
+	ProbabilityJob = FMineProbabilityJob::Launch(Actor->GetSnapshotPublisher()->Acquire(),
+		FOnMineProbabilitiesReady::CreateSP(this, &FMineSweeperViewModel::OnProbabilitiesReady));
+}
+
+void FMineSweeperViewModel::OnProbabilitiesReady(const FMineProbabilityMap& Map)
+{
+	ProbabilityMap = Map;
+	ProbabilityJob.Reset();
+}
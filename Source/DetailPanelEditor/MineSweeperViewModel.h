@@ -0,0 +1,85 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DetailPanel/Public/MineProbabilityEngine.h"
+
+class AMineSweeperActor;
+
+//What one cell of the details grid shows
+struct FMineCellDisplay
+{
+	FMineCellDisplay()
+		: bEnabled(false)
+		, bShowCover(false)
+		, bShowMine(false)
+		, bShowFlag(false)
+		, bShowCross(false)
+	{
+	}
+
+	//Mines around a revealed field, 0 if it shows no number
+	uint8 Number = 0;
+
+	uint8 bEnabled : 1;
+	//The dimmed overlay of revealed fields
+	uint8 bShowCover : 1;
+	uint8 bShowMine : 1;
+	uint8 bShowFlag : 1;
+	uint8 bShowCross : 1;
+};
+
+//State of one board as the details grid shows it, shared by every details view showing the same actor.
+//A cell is worked out on first read after the board changed and then served to all views from the cache,
+//so another open view only adds its painting. The heatmap probabilities are calculated once for all views that show them.
+class FMineSweeperViewModel : public TSharedFromThis<FMineSweeperViewModel>
+{
+public:
+	//Returns the view model of the actor, creating it if no view holds one yet
+	static TSharedRef<FMineSweeperViewModel> Get(AMineSweeperActor* Actor);
+
+	~FMineSweeperViewModel();
+
+	AMineSweeperActor* GetActor() const { return Actor.Get(); }
+
+	//Cells outside the board show nothing
+	const FMineCellDisplay& GetCell(int32 ColIndex, int32 RowIndex) const;
+
+	bool HasWon() const { return bHasWon; }
+
+	static const FText& GetNumberText(int32 Number);
+	static FLinearColor GetNumberColor(int32 Number);
+
+	//Views showing the heatmap, the probabilities are only calculated while there is at least one
+	void AddHeatmapView();
+	void RemoveHeatmapView();
+
+	//Mine probability of a hidden field, negative if there is none to show
+	float GetProbability(int32 ColIndex, int32 RowIndex) const;
+	bool IsProbabilityExact() const { return ProbabilityMap.bExact; }
+
+private:
+	explicit FMineSweeperViewModel(AMineSweeperActor* InActor);
+
+	void OnBoardChanged(const TArray<int32>& ChangedIndices);
+
+	//Forgets every cell and takes the board size again
+	void InvalidateAll();
+
+	void RefreshProbabilities();
+	void OnProbabilitiesReady(const FMineProbabilityMap& Map);
+
+	TWeakObjectPtr<AMineSweeperActor> Actor;
+	FDelegateHandle BoardChangedHandle;
+
+	FIntPoint BoardSize = FIntPoint::ZeroValue;
+	bool bGameOver = false;
+	bool bHasWon = false;
+
+	//Filled on demand, a cleared bit means the cell has to be worked out again
+	mutable TArray<FMineCellDisplay> Cells;
+	mutable TBitArray<> ValidCells;
+
+	int32 NumHeatmapViews = 0;
+	TSharedPtr<FMineProbabilityJob, ESPMode::ThreadSafe> ProbabilityJob;
+	FMineProbabilityMap ProbabilityMap;
+};
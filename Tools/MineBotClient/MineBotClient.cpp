@@ -0,0 +1,187 @@
+//Reference client for the minesweeper shared memory bridge, see Source/DetailPanel/Public/MineSharedMemoryProtocol.h.
+//Plays random moves as fast as the game answers them and prints the moves per second the board applied.
+//MineSweeper.Bridge.Report in the game tells what those moves cost on the game thread.
+//
+//  Build: c++ -O2 -std=c++17 MineBotClient.cpp -o MineBotClient (add -lrt on older glibc)
+//  Run:   start a bridge in the editor with "MineSweeper.Bridge.Start MyActor bot", then ./MineBotClient bot [Seconds] [InFlight]
+
+#include "../../Source/DetailPanel/Public/MineSharedMemoryProtocol.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+	//EMineCellState values the bot cares about
+	constexpr uint8_t CellHidden = 32;
+	constexpr uint8_t CellFlagged = 33;
+
+	MineShm::FHeader* Attach(const std::string& Name)
+	{
+		const std::string FullName = std::string(MineShm::NamePrefix) + Name;
+		const int Handle = shm_open(FullName.c_str(), O_RDWR, 0);
+		if (Handle < 0)
+		{
+			std::fprintf(stderr, "No segment %s, start a bridge first\n", FullName.c_str());
+			return nullptr;
+		}
+
+		struct stat Stat;
+		void* Memory = MAP_FAILED;
+		if (fstat(Handle, &Stat) == 0 && size_t(Stat.st_size) >= sizeof(MineShm::FHeader))
+		{
+			Memory = mmap(nullptr, size_t(Stat.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, Handle, 0);
+		}
+		close(Handle);
+		if (Memory == MAP_FAILED)
+		{
+			std::fprintf(stderr, "Could not map %s\n", FullName.c_str());
+			return nullptr;
+		}
+
+		MineShm::FHeader* Header = static_cast<MineShm::FHeader*>(Memory);
+		const uint32_t Magic = Header->Magic;
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (Magic != MineShm::Magic || Header->Version != MineShm::Version)
+		{
+			std::fprintf(stderr, "%s is not a version %u minesweeper segment\n", FullName.c_str(), MineShm::Version);
+			return nullptr;
+		}
+		return Header;
+	}
+}
+
+int main(int Argc, char** Argv)
+{
+	if (Argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <SegmentName> [Seconds] [InFlight]\n", Argv[0]);
+		return 1;
+	}
+
+	MineShm::FHeader* Header = Attach(Argv[1]);
+	if (!Header)
+	{
+		return 1;
+	}
+
+	const double Seconds = Argc > 2 ? std::atof(Argv[2]) : 5.0;
+	const uint32_t MaxInFlight = Argc > 3 ? uint32_t(std::atoi(Argv[3])) : Header->CommandCapacity / 2;
+
+	MineShm::FRingHeader* CommandRing = MineShm::GetRing(Header, Header->CommandRingOffset);
+	MineShm::FRingHeader* EventRing = MineShm::GetRing(Header, Header->EventRingOffset);
+	const uint8_t* Cells = MineShm::GetCells(Header);
+
+	std::mt19937 Random(12345);
+	uint64_t NumSent = 0;
+	uint64_t NumDone = 0;
+	uint64_t NumApplied = 0;
+	uint64_t NumFieldEvents = 0;
+	uint64_t NumResyncs = 0;
+	uint64_t NumGames = 0;
+	bool bResetInFlight = false;
+
+	using FClock = std::chrono::steady_clock;
+	const FClock::time_point StartTime = FClock::now();
+	const FClock::time_point EndTime = StartTime + std::chrono::duration_cast<FClock::duration>(std::chrono::duration<double>(Seconds));
+	uint64_t LastHeartbeat = Header->Heartbeat.load(std::memory_order_relaxed);
+	FClock::time_point LastProgress = StartTime;
+
+	while (FClock::now() < EndTime)
+	{
+		const uint32_t GameState = Header->GameState.load(std::memory_order_acquire);
+		if (GameState & MineShm::StateDetached)
+		{
+			std::fprintf(stderr, "The game closed the bridge\n");
+			break;
+		}
+
+		//Keep the ring busy, the game applies everything that is waiting in one go
+		const int32_t NumFields = Header->Columns.load(std::memory_order_relaxed) * Header->Rows.load(std::memory_order_relaxed);
+		while (NumSent - NumDone < MaxInFlight && NumFields > 0)
+		{
+			MineShm::FCommand Command = {};
+			if ((GameState & MineShm::StateGameOver) != 0)
+			{
+				if (bResetInFlight)
+				{
+					break;
+				}
+				Command.Type = uint8_t(MineShm::ECommand::Reset);
+				bResetInFlight = true;
+				NumGames++;
+			}
+			else
+			{
+				//Mostly clicks on hidden fields, some flags so the win can happen too. Moves on revealed fields are rejected
+				//without reaching the board, so a few tries go into finding one that isn't.
+				Command.Index = int32_t(Random() % uint32_t(NumFields));
+				for (int32_t Try = 0; Try < 16 && Cells[Command.Index] != CellHidden && Cells[Command.Index] != CellFlagged; Try++)
+				{
+					Command.Index = int32_t(Random() % uint32_t(NumFields));
+				}
+				const uint8_t Cell = Cells[Command.Index];
+				const bool bFlag = Cell == CellFlagged || (Cell == CellHidden && Random() % 8 == 0);
+				Command.Type = uint8_t(bFlag ? MineShm::ECommand::Flag : MineShm::ECommand::Click);
+			}
+
+			if (!MineShm::Push(CommandRing, Header->CommandCapacity, Command))
+			{
+				break;
+			}
+			NumSent++;
+		}
+
+		const uint32_t NumEvents = MineShm::Consume<MineShm::FEvent>(EventRing, Header->EventCapacity, Header->EventCapacity,
+			[&](const MineShm::FEvent& Event)
+			{
+				switch (MineShm::EEvent(Event.Type))
+				{
+				case MineShm::EEvent::FieldChanged:
+					NumFieldEvents++;
+					break;
+				case MineShm::EEvent::MoveDone:
+					NumDone++;
+					NumApplied += Event.State == uint8_t(MineShm::EMoveResult::Applied) ? 1 : 0;
+					break;
+				case MineShm::EEvent::Resync:
+					//A bot with its own copy of the board would read all cells again here
+					NumResyncs++;
+					bResetInFlight = false;
+					break;
+				}
+				return true;
+			});
+
+		if (NumEvents == 0)
+		{
+			const uint64_t Heartbeat = Header->Heartbeat.load(std::memory_order_relaxed);
+			if (Heartbeat != LastHeartbeat)
+			{
+				LastHeartbeat = Heartbeat;
+				LastProgress = FClock::now();
+			}
+			else if (FClock::now() - LastProgress > std::chrono::seconds(2))
+			{
+				std::fprintf(stderr, "The game stopped reading commands\n");
+				break;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	const double Elapsed = std::chrono::duration<double>(FClock::now() - StartTime).count();
+	std::printf("%llu moves in %.2f s, %.0f applied moves/s (%llu applied, %llu rejected), %llu field events, %llu resyncs, %llu games, %llu events dropped\n",
+		(unsigned long long)NumDone, Elapsed, NumApplied / Elapsed, (unsigned long long)NumApplied, (unsigned long long)(NumDone - NumApplied), (unsigned long long)NumFieldEvents,
+		(unsigned long long)NumResyncs, (unsigned long long)NumGames, (unsigned long long)Header->EventsDropped.load(std::memory_order_relaxed));
+	return 0;
+}